@@ -115,6 +115,27 @@ namespace StereoKit
 		}
 	}
 
+	/// <summary>A shader parameter name that's been resolved ahead of time,
+	/// so setting it skips the name lookup. Create one once, keep it around,
+	/// and always pass the same instance by `ref`. It remembers where the
+	/// parameter lives for the last Shader it was used with, and resolves
+	/// itself again if used with a Material on a different Shader.</summary>
+	[StructLayout(LayoutKind.Sequential)]
+	public struct MatParamHandle
+	{
+		private ulong _nameHash;
+		private uint  _shaderGeneration;
+		private int   _offset;
+		private int   _size;
+		private int   _textureIndex;
+
+		/// <summary>Creates a handle for the shader parameter with this
+		/// name.</summary>
+		/// <param name="name">Name of the shader parameter.</param>
+		public MatParamHandle(string name)
+			=> this = NativeAPI.material_param_handle(name);
+	}
+
 	/// <summary>A Material describes the surface of anything drawn on the 
 	/// graphics card! It is typically composed of a Shader, and shader 
 	/// properties like colors, textures, transparency info, etc.
@@ -532,6 +553,43 @@ namespace StereoKit
 			Marshal.FreeHGlobal(memory);
 		}
 
+		/// <summary>Sets a shader parameter using a pre-resolved handle,
+		/// which skips looking the name up. If no parameter is found,
+		/// nothing happens, and the value is not set!</summary>
+		/// <param name="handle">A handle for the shader parameter, always
+		/// pass the same instance so it can cache its lookup.</param>
+		/// <param name="value">New value for the parameter.</param>
+		public void SetFloat(ref MatParamHandle handle, float value)
+			=> NativeAPI.material_set_float_handle(_inst, ref handle, value);
+
+		/// <summary>Sets a shader parameter using a pre-resolved handle,
+		/// which skips looking the name up. If no parameter is found,
+		/// nothing happens, and the value is not set!</summary>
+		/// <param name="handle">A handle for the shader parameter, always
+		/// pass the same instance so it can cache its lookup.</param>
+		/// <param name="colorGamma">The gamma space color for the shader
+		/// to use.</param>
+		public void SetColor(ref MatParamHandle handle, Color colorGamma)
+			=> NativeAPI.material_set_color_handle(_inst, ref handle, colorGamma);
+
+		/// <summary>Sets a shader parameter using a pre-resolved handle,
+		/// which skips looking the name up. If no parameter is found,
+		/// nothing happens, and the value is not set!</summary>
+		/// <param name="handle">A handle for the shader parameter, always
+		/// pass the same instance so it can cache its lookup.</param>
+		/// <param name="value">New value for the parameter.</param>
+		public void SetVector(ref MatParamHandle handle, Vec4 value)
+			=> NativeAPI.material_set_vector4_handle(_inst, ref handle, value);
+
+		/// <summary>Sets a shader parameter using a pre-resolved handle,
+		/// which skips looking the name up. If no parameter is found,
+		/// nothing happens, and the value is not set!</summary>
+		/// <param name="handle">A handle for the shader parameter, always
+		/// pass the same instance so it can cache its lookup.</param>
+		/// <param name="value">New value for the parameter.</param>
+		public void SetMatrix(ref MatParamHandle handle, Matrix value)
+			=> NativeAPI.material_set_matrix_handle(_inst, ref handle, value);
+
 		/// <summary>Gets the value of a shader parameter with the given name.
 		/// If no parameter is found, a default value of '0' will be returned.
 		/// </summary>
@@ -51,6 +51,16 @@ namespace StereoKit
 			set => NativeAPI.mesh_set_keep_data(_inst, value);
 		}
 
+		/// <summary>Should this Mesh hide the things behind it when
+		/// Renderer.EnableOcclusion is on? Occluders are still drawn as
+		/// normal, and are rasterized on the CPU from the Mesh's own data,
+		/// so they must keep their data. Large, simple, solid Meshes like
+		/// walls make the best occluders. Defaults to false.</summary>
+		public bool Occluder {
+			get => NativeAPI.mesh_get_occluder(_inst);
+			set => NativeAPI.mesh_set_occluder(_inst, value);
+		}
+
 		/// <summary>The number of vertices stored in this Mesh! This is
 		/// available to you regardless of whether or not KeepData is set.
 		/// </summary>
@@ -61,6 +71,28 @@ namespace StereoKit
 		/// </summary>
 		public int IndCount => NativeAPI.mesh_get_ind_count(_inst);
 
+		/// <summary>How many simplified LOD levels this Mesh has, not
+		/// counting the original. See `GenerateLods`.</summary>
+		public int LodCount => NativeAPI.mesh_get_lod_count(_inst);
+
+		/// <summary>How many triangle clusters this Mesh has been split
+		/// into, or 0 if it hasn't been. See `BuildClusters`.</summary>
+		public int ClusterCount => NativeAPI.mesh_get_cluster_count(_inst);
+
+		/// <summary>A folder where StereoKit saves the acceleration
+		/// structures it builds for Mesh collision, and loads them from on
+		/// later runs, so large Meshes don't need rebuilding each time.
+		/// These files are keyed by the Mesh's data, so they never go stale.
+		/// Null, the default, disables the cache.</summary>
+		public static string CollisionCache
+		{
+			get {
+				IntPtr folder = NativeAPI.mesh_get_collision_cache();
+				return folder == IntPtr.Zero ? null : NativeHelper.FromUtf8(folder);
+			}
+			set => NativeAPI.mesh_set_collision_cache(NativeHelper.ToUtf8(value));
+		}
+
 		/// <summary>Creates an empty Mesh asset. Use SetVerts and SetInds to
 		/// add data to it!</summary>
 		public Mesh()
@@ -267,6 +299,28 @@ namespace StereoKit
 		public bool GetTriangle(uint triangleIndex, out Vertex a, out Vertex b, out Vertex c)
 			=> NativeAPI.mesh_get_triangle(_inst, triangleIndex, out a, out b, out c);
 
+		/// <summary>Builds simplified versions of this Mesh that StereoKit
+		/// will draw instead when it's small on screen, see
+		/// `Renderer.SetLod`. This needs the Mesh to keep its data, and
+		/// doesn't work on skinned Meshes. Changing the Mesh's data later
+		/// discards its LODs.</summary>
+		/// <param name="levelCount">How many simplified levels to build,
+		/// not counting the original Mesh.</param>
+		/// <param name="levelReduction">Each level aims for this fraction of
+		/// the previous level's triangles, between 0 and 1.</param>
+		public void GenerateLods(int levelCount = 3, float levelReduction = 0.5f)
+			=> NativeAPI.mesh_generate_lods(_inst, levelCount, levelReduction);
+
+		/// <summary>Splits this Mesh into small clusters of triangles, each
+		/// with its own bounds and facing cone. When drawn, clusters that
+		/// are outside the view or facing away from it are skipped. This
+		/// needs the Mesh to keep its data, and doesn't work on skinned
+		/// Meshes. This reorders the Mesh's indices, but keeps any LODs it
+		/// already has. Changing the Mesh's data later discards its
+		/// clusters.</summary>
+		public void BuildClusters()
+			=> NativeAPI.mesh_build_clusters(_inst);
+
 		/// <inheritdoc cref="Mesh.Draw(Material, Matrix)"/>
 		/// <param name="colorLinear">A per-instance linear space color value
 		/// to pass into the shader! Normally this gets used like a material
@@ -83,6 +83,15 @@ namespace StereoKit
 			}
 		}
 
+		/// <summary>The processing done on Meshes when a Model is loaded
+		/// from a file without its own import flags. This affects every
+		/// Model loaded afterwards. Default is ModelImport.None.</summary>
+		public static ModelImport ImportFlags
+		{
+			get => NativeAPI.model_get_import_flags();
+			set => NativeAPI.model_set_import_flags(value);
+		}
+
 		#region Constructors
 		/// <summary>Creates a single mesh subset Model using the indicated
 		/// Mesh and Material! An id will be automatically generated for this
@@ -294,6 +303,71 @@ namespace StereoKit
 			if (animation._model._inst == this._inst)
 				NativeAPI.model_play_anim_idx(_inst, animation._animIndex, mode);
 		}
+		/// <summary>Fades from whatever is playing on the layer to this
+		/// animation over time. Clips already on the layer fade out as this
+		/// one fades in.</summary>
+		/// <param name="animation">The animation to fade to.</param>
+		/// <param name="mode">The mode with which to play the animation.
+		/// </param>
+		/// <param name="fadeSeconds">How long the crossfade takes, in
+		/// seconds. Zero switches immediately, just like PlayAnim.</param>
+		/// <param name="layer">Which animation layer to play on. Layers
+		/// that don't exist yet are created as needed.</param>
+		public void PlayAnim(Anim animation, AnimMode mode, float fadeSeconds, int layer = 0)
+		{
+			if (animation._model._inst == this._inst)
+				NativeAPI.model_play_anim_crossfade(_inst, animation._animIndex, mode, fadeSeconds, layer);
+		}
+		/// <summary>Adds this animation to the layer alongside whatever is
+		/// already playing there, fading it in to the given weight. If the
+		/// animation is already on the layer, this fades it to the new
+		/// weight instead.</summary>
+		/// <param name="animation">The animation to blend in.</param>
+		/// <param name="mode">The mode with which to play the animation.
+		/// </param>
+		/// <param name="weight">How much this animation contributes to
+		/// the layer's pose, relative to the other animations on it.</param>
+		/// <param name="fadeSeconds">How long it takes to reach this
+		/// weight, in seconds.</param>
+		/// <param name="layer">Which animation layer to play on. Layers
+		/// that don't exist yet are created as needed.</param>
+		public void BlendAnim(Anim animation, AnimMode mode, float weight, float fadeSeconds, int layer = 0)
+		{
+			if (animation._model._inst == this._inst)
+				NativeAPI.model_play_anim_blend(_inst, animation._animIndex, mode, weight, fadeSeconds, layer);
+		}
+		/// <summary>Fades out every animation playing on the layer. Once a
+		/// layer has nothing playing, it no longer affects the Model.
+		/// </summary>
+		/// <param name="fadeSeconds">How long the fade out takes, in
+		/// seconds.</param>
+		/// <param name="layer">Which animation layer to stop.</param>
+		public void StopAnim(float fadeSeconds, int layer = 0)
+			=> NativeAPI.model_stop_anim(_inst, fadeSeconds, layer);
+		/// <summary>Sets how an animation layer combines with the layers
+		/// beneath it. Layer 0 is the base, and is always applied first.
+		/// </summary>
+		/// <param name="layer">Which animation layer to modify.</param>
+		/// <param name="blend">Whether the layer overrides the layers
+		/// beneath it, or adds onto them.</param>
+		/// <param name="weight">How strongly this layer applies, from 0
+		/// to 1.</param>
+		public void SetAnimLayer(int layer, AnimBlend blend, float weight)
+			=> NativeAPI.model_anim_layer_set(_inst, layer, blend, weight);
+		/// <summary>Limits how much an animation layer affects a node,
+		/// like playing an upper body animation over a walk cycle. Nodes
+		/// that have never been masked are fully affected.</summary>
+		/// <param name="layer">Which animation layer to modify.</param>
+		/// <param name="node">The node to mask.</param>
+		/// <param name="weight">How strongly this layer applies to the
+		/// node, from 0 to 1.</param>
+		/// <param name="includeChildren">Should this node's children get
+		/// the same weight?</param>
+		public void SetAnimLayerMask(int layer, ModelNode node, float weight, bool includeChildren = true)
+		{
+			if (node._model._inst == this._inst)
+				NativeAPI.model_anim_layer_set_mask(_inst, layer, node._nodeId, weight, includeChildren);
+		}
 		/// <summary>Calling Draw will automatically step the Model's
 		/// animation, but if you don't draw the Model, or need access to the
 		/// animated nodes before drawing, then you can step the animation
@@ -506,6 +580,49 @@ namespace StereoKit
 			return inst == IntPtr.Zero ? null : new Model(inst);
 		}
 
+		/// <summary>Loads a list of mesh and material subsets from a .obj,
+		/// .stl, .ply (ASCII), .gltf, or .glb file, with extra processing
+		/// done on the Meshes while loading.</summary>
+		/// <param name="file">Name of the file to load! This gets prefixed
+		/// with the StereoKit asset folder if no drive letter is specified
+		/// in the path.</param>
+		/// <param name="importFlags">What processing to do on the Meshes,
+		/// this overrides Model.ImportFlags for this load.</param>
+		/// <param name="shader">The shader to use for the model's materials!
+		/// If null, this will automatically determine the best shader
+		/// available to use.</param>
+		/// <returns>A Model created from the file, or null if the file 
+		/// failed to load!</returns>
+		public static Model FromFile(string file, ModelImport importFlags, Shader shader = null)
+		{
+			IntPtr final = shader == null ? IntPtr.Zero : shader._inst;
+			IntPtr inst = NativeAPI.model_create_file_flags(NativeHelper.ToUtf8(file), importFlags, final);
+			return inst == IntPtr.Zero ? null : new Model(inst);
+		}
+
+		/// <summary>Loads a list of mesh and material subsets from a .obj,
+		/// .stl, .ply (ASCII), .gltf, or .glb file stored in memory, with
+		/// extra processing done on the Meshes while loading.</summary>
+		/// <param name="filename">StereoKit still uses the filename of the
+		/// data for format discovery, but not asset Id creation. If you 
+		/// don't have a real filename for the data, just pass in an
+		/// extension with a leading '.' character here, like ".glb".</param>
+		/// <param name="data">The binary data of a model file, this is NOT 
+		/// a raw array of vertex and index data!</param>
+		/// <param name="importFlags">What processing to do on the Meshes,
+		/// this overrides Model.ImportFlags for this load.</param>
+		/// <param name="shader">The shader to use for the model's materials!
+		/// If null, this will automatically determine the best shader 
+		/// available to use.</param>
+		/// <returns>A Model created from the file, or null if the file
+		/// failed to load!</returns>
+		public static Model FromMemory(string filename, in byte[] data, ModelImport importFlags, Shader shader = null)
+		{
+			IntPtr final = shader == null ? IntPtr.Zero : shader._inst;
+			IntPtr inst = NativeAPI.model_create_mem_flags(NativeHelper.ToUtf8(filename), data, (UIntPtr)data.Length, importFlags, final);
+			return inst == IntPtr.Zero ? null : new Model(inst);
+		}
+
 		/// <summary>Creates a single mesh subset Model using the indicated
 		/// Mesh and Material! An id will be automatically generated for this
 		/// asset.</summary>
@@ -0,0 +1,110 @@
+﻿using System;
+using System.Runtime.InteropServices;
+
+namespace StereoKit
+{
+	/// <summary>A RenderView is a persistent secondary camera that draws the
+	/// primary RenderList into a rendertarget texture, like a mirror,
+	/// security camera, or portal. Unlike `Renderer.RenderTo`, you create it
+	/// once, and StereoKit decides each frame whether it needs drawing again.
+	///
+	/// A view is only redrawn when its camera, target size, or the contents
+	/// of the layers it can see have changed, and no more often than its
+	/// Rate. `Renderer.ViewBudget` can cap how many views are drawn in a
+	/// single frame.</summary>
+	public class RenderView : IAsset
+	{
+		internal IntPtr _inst;
+
+		/// <summary>Gets or sets the unique identifier of this asset resource!
+		/// This can be helpful for debugging, managing your assets, or finding
+		/// them later on!</summary>
+		public string Id
+		{
+			get => Marshal.PtrToStringAnsi(NativeAPI.render_view_get_id(_inst));
+			set => NativeAPI.render_view_set_id(_inst, value);
+		}
+
+		/// <summary>The most times per second this view will be redrawn,
+		/// even when its contents are changing every frame. 0 means there is
+		/// no limit, which is the default.</summary>
+		public float Rate
+		{
+			get => NativeAPI.render_view_get_rate(_inst);
+			set => NativeAPI.render_view_set_rate(_inst, value);
+		}
+
+		/// <summary>Disabled views are never drawn, and keep whatever their
+		/// texture last held. Views are enabled by default.</summary>
+		public bool Enabled
+		{
+			get => NativeAPI.render_view_get_enabled(_inst);
+			set => NativeAPI.render_view_set_enabled(_inst, value);
+		}
+
+		/// <summary>Creates a new RenderView that draws into the given
+		/// texture. It starts with an identity camera and projection, so
+		/// call SetCamera before expecting anything useful from it.</summary>
+		/// <param name="toRenderTarget">A texture that's been set up as a
+		/// render target.</param>
+		/// <param name="layerFilter">Which layers this view can see. Changes
+		/// to layers it can't see won't cause it to redraw.</param>
+		/// <param name="clear">Describes if and how the rendertarget should
+		/// be cleared before each draw.</param>
+		/// <param name="viewportPct">Allows you to specify a region of the
+		/// rendertarget to draw to! This is in normalized coordinates, 0-1.
+		/// If the width of this value is zero, then this will render to the
+		/// entire texture.</param>
+		public RenderView(Tex toRenderTarget, RenderLayer layerFilter = RenderLayer.All, RenderClear clear = RenderClear.All, Rect viewportPct = default)
+		{
+			_inst = NativeAPI.render_view_create(toRenderTarget._inst, layerFilter, clear, viewportPct);
+			if (_inst == IntPtr.Zero)
+				Log.Err("Couldn't create RenderView!");
+		}
+		internal RenderView(IntPtr view)
+		{
+			_inst = view;
+			if (_inst == IntPtr.Zero)
+				Log.Err("Received an empty RenderView!");
+		}
+		/// <summary>Release reference to the StereoKit asset.</summary>
+		~RenderView()
+		{
+			if (_inst != IntPtr.Zero)
+				NativeAPI.assets_releaseref_threadsafe(_inst);
+		}
+
+		/// <summary>Sets where this view looks from, and how it projects
+		/// the scene onto its texture.</summary>
+		/// <param name="camera">A TRS matrix representing the location and
+		/// orientation of the camera. This matrix gets inverted later on, so
+		/// no need to do it yourself.</param>
+		/// <param name="projection">The projection matrix describes how the
+		/// geometry is flattened onto the draw surface. Normally, you'd use
+		/// Matrix.Perspective, and occasionally Matrix.Orthographic might be
+		/// helpful as well.</param>
+		public void SetCamera(Matrix camera, Matrix projection)
+			=> NativeAPI.render_view_set_camera(_inst, camera, projection);
+
+		/// <summary>Forces this view to redraw the next time it's allowed
+		/// to. This is for changes StereoKit can't see on its own. Mesh and
+		/// Material changes are tracked, but what a texture holds isn't, so
+		/// this is needed when something in view shows a rendertarget,
+		/// video, or a texture that was edited.</summary>
+		public void SetDirty()
+			=> NativeAPI.render_view_set_dirty(_inst);
+
+		/// <summary>Finds the RenderView with the matching id, and returns a
+		/// reference to it. If no RenderView is found, it returns null.
+		/// </summary>
+		/// <param name="viewId">Id of the RenderView we're looking for.
+		/// </param>
+		/// <returns>A RenderView with a matching id, or null if none is
+		/// found.</returns>
+		public static RenderView Find(string viewId)
+		{
+			IntPtr view = NativeAPI.render_view_find(viewId);
+			return view == IntPtr.Zero ? null : new RenderView(view);
+		}
+	}
+}
@@ -143,6 +143,9 @@ namespace StereoKit
 		[DllImport(dll, CharSet = cSet, CallingConvention = call)] public static extern void   mesh_set_keep_data   (IntPtr mesh, [MarshalAs(UnmanagedType.Bool)] bool keep_data);
 		[return: MarshalAs(UnmanagedType.Bool)]
 		[DllImport(dll, CharSet = cSet, CallingConvention = call)] public static extern bool   mesh_get_keep_data   (IntPtr mesh);
+		[DllImport(dll, CharSet = cSet, CallingConvention = call)] public static extern void   mesh_set_occluder    (IntPtr mesh, [MarshalAs(UnmanagedType.Bool)] bool occluder);
+		[return: MarshalAs(UnmanagedType.Bool)]
+		[DllImport(dll, CharSet = cSet, CallingConvention = call)] public static extern bool   mesh_get_occluder    (IntPtr mesh);
 		[DllImport(dll, CharSet = cSet, CallingConvention = call)] public static extern void   mesh_set_data        (IntPtr mesh, [In] Vertex[] vertices, int vertex_count, [In] uint[] indices, int index_count, [MarshalAs(UnmanagedType.Bool)] bool calculate_bounds);
 		[DllImport(dll, CharSet = cSet, CallingConvention = call)] public static extern void   mesh_set_verts       (IntPtr mesh, [In] Vertex[] vertices, int vertex_count, [MarshalAs(UnmanagedType.Bool)] bool calculate_bounds);
 		[DllImport(dll, CharSet = cSet, CallingConvention = call)] public static extern void   mesh_get_verts       (IntPtr mesh, out IntPtr out_vertices, out int out_vertex_count, Memory reference_mode);
@@ -151,6 +154,10 @@ namespace StereoKit
 		[DllImport(dll, CharSet = cSet, CallingConvention = call)] public static extern void   mesh_get_inds        (IntPtr mesh, out IntPtr out_indices,  out int out_index_count, Memory reference_mode); // [Out, MarshalAs(unmanagedType:UnmanagedType.LPArray, SizeParamIndex=2)]
 		[DllImport(dll, CharSet = cSet, CallingConvention = call)] public static extern int    mesh_get_ind_count   (IntPtr mesh);
 		[DllImport(dll, CharSet = cSet, CallingConvention = call)] public static extern void   mesh_set_draw_inds   (IntPtr mesh, int index_count);
+		[DllImport(dll, CharSet = cSet, CallingConvention = call)] public static extern void   mesh_generate_lods   (IntPtr mesh, int level_count, float level_reduction);
+		[DllImport(dll, CharSet = cSet, CallingConvention = call)] public static extern int    mesh_get_lod_count   (IntPtr mesh);
+		[DllImport(dll, CharSet = cSet, CallingConvention = call)] public static extern void   mesh_build_clusters  (IntPtr mesh);
+		[DllImport(dll, CharSet = cSet, CallingConvention = call)] public static extern int    mesh_get_cluster_count(IntPtr mesh);
 		[DllImport(dll, CharSet = cSet, CallingConvention = call)] public static extern void   mesh_set_bounds      (IntPtr mesh, in Bounds bounds);
 		[DllImport(dll, CharSet = cSet, CallingConvention = call)] public static extern Bounds mesh_get_bounds      (IntPtr mesh);
 		[return: MarshalAs(UnmanagedType.Bool)]
@@ -159,6 +166,8 @@ namespace StereoKit
 		[DllImport(dll, CharSet = cSet, CallingConvention = call)] public static extern bool   mesh_ray_intersect   (IntPtr mesh, Ray model_space_ray, out Ray out_pt, out uint out_start_inds, Cull cull_mode);
 		[return: MarshalAs(UnmanagedType.Bool)]
 		[DllImport(dll, CharSet = cSet, CallingConvention = call)] public static extern bool   mesh_get_triangle    (IntPtr mesh, uint triangle_index, out Vertex a, out Vertex b, out Vertex c);
+		[DllImport(dll, CharSet = cSet, CallingConvention = call)] public static extern void   mesh_set_collision_cache([In] byte[] folder_utf8);
+		[DllImport(dll, CharSet = cSet, CallingConvention = call)] public static extern IntPtr mesh_get_collision_cache();
 
 		[DllImport(dll, CharSet = cSet, CallingConvention = call)] public static extern IntPtr mesh_gen_plane       (Vec2 dimensions, Vec3 plane_normal, Vec3 plane_top_direction, int subdivisions, [MarshalAs(UnmanagedType.Bool)] bool double_sided);
 		[DllImport(dll, CharSet = cSet, CallingConvention = call)] public static extern IntPtr mesh_gen_circle      (float diameter,  Vec3 plane_normal, Vec3 plane_top_direction, int spokes, [MarshalAs(UnmanagedType.Bool)] bool double_sided);
@@ -298,6 +307,15 @@ namespace StereoKit
 		//[DllImport(dll, CharSet = cSet, CallingConvention = call)] public static extern void   material_set_param_id    (IntPtr material, ulong    id,   MaterialParam type, const void *value);
 		//[DllImport(dll, CharSet = cSet, CallingConvention = call)] public static extern int    material_get_param       (IntPtr material, string name, MaterialParam type, void *out_value);
 		//[DllImport(dll, CharSet = cSet, CallingConvention = call)] public static extern int    material_get_param_id    (IntPtr material, ulong    id, MaterialParam type, void *out_value);
+		[DllImport(dll, CharSet = cSet, CallingConvention = call)] public static extern MatParamHandle material_param_handle     (string name);
+		[return: MarshalAs(UnmanagedType.Bool)]
+		[DllImport(dll, CharSet = cSet, CallingConvention = call)] public static extern bool   material_set_param_handle  (IntPtr material, ref MatParamHandle handle, MaterialParam type, IntPtr value);
+		[return: MarshalAs(UnmanagedType.Bool)]
+		[DllImport(dll, CharSet = cSet, CallingConvention = call)] public static extern bool   material_get_param_handle  (IntPtr material, ref MatParamHandle handle, MaterialParam type, IntPtr out_value);
+		[DllImport(dll, CharSet = cSet, CallingConvention = call)] public static extern void   material_set_float_handle  (IntPtr material, ref MatParamHandle handle, float  value);
+		[DllImport(dll, CharSet = cSet, CallingConvention = call)] public static extern void   material_set_vector4_handle(IntPtr material, ref MatParamHandle handle, Vec4   value);
+		[DllImport(dll, CharSet = cSet, CallingConvention = call)] public static extern void   material_set_color_handle  (IntPtr material, ref MatParamHandle handle, Color  color_gamma);
+		[DllImport(dll, CharSet = cSet, CallingConvention = call)] public static extern void   material_set_matrix_handle (IntPtr material, ref MatParamHandle handle, Matrix value);
 		[DllImport(dll, CharSet = cSet, CallingConvention = call)] public static extern void   material_get_param_info  (IntPtr material, int index, out IntPtr out_name, out MaterialParam out_type);
 		[DllImport(dll, CharSet = cSet, CallingConvention = call)] public static extern int    material_get_param_count (IntPtr material);
 		[DllImport(dll, CharSet = cSet, CallingConvention = call)] public static extern void   material_set_shader      (IntPtr material, IntPtr shader);
@@ -338,6 +356,15 @@ namespace StereoKit
 		[DllImport(dll, CharSet = cSet, CallingConvention = call)] public static extern void   solid_set_velocity_ang(IntPtr solid, in Vec3 radians_per_second);
 		[DllImport(dll, CharSet = cSet, CallingConvention = call)] public static extern void   solid_get_pose        (IntPtr solid, out Pose out_pose);
 
+		[return: MarshalAs(UnmanagedType.Bool)]
+		[DllImport(dll, CharSet = cSet, CallingConvention = call)] public static extern bool   physics_raycast       (Ray ray, float max_distance, out PhysicsHit out_hit);
+		[DllImport(dll, CharSet = cSet, CallingConvention = call)] public static extern int    physics_raycast_batch ([In] Ray[] in_arr_rays, int ray_count, float max_distance, [Out] PhysicsHit[] out_arr_hits);
+		[DllImport(dll, CharSet = cSet, CallingConvention = call)] public static extern int    physics_overlap       (in PhysicsShape shape, [Out] IntPtr[] out_arr_solids, int solid_capacity);
+		[DllImport(dll, CharSet = cSet, CallingConvention = call)] public static extern void   physics_overlap_batch ([In] PhysicsShape[] in_arr_shapes, int shape_count, [Out] IntPtr[] out_arr_solids, int solids_per_shape, [Out] int[] out_arr_solid_counts);
+		[return: MarshalAs(UnmanagedType.Bool)]
+		[DllImport(dll, CharSet = cSet, CallingConvention = call)] public static extern bool   physics_sweep         (in PhysicsShape shape, Vec3 motion, out PhysicsHit out_hit);
+		[DllImport(dll, CharSet = cSet, CallingConvention = call)] public static extern int    physics_sweep_batch   ([In] PhysicsShape[] in_arr_shapes, [In] Vec3[] in_arr_motions, int shape_count, [Out] PhysicsHit[] out_arr_hits);
+
 		///////////////////////////////////////////
 
 		[DllImport(dll, CharSet = cSet, CallingConvention = call)] public static extern IntPtr model_find              (string id);
@@ -346,6 +373,10 @@ namespace StereoKit
 		[DllImport(dll, CharSet = cSet, CallingConvention = call)] public static extern IntPtr model_create_mesh       (IntPtr mesh, IntPtr material);
 		[DllImport(dll, CharSet = cSet, CallingConvention = call)] public static extern IntPtr model_create_mem        ([In] byte[] filename_utf8, [In] byte[] data, UIntPtr data_size, IntPtr shader);
 		[DllImport(dll, CharSet = cSet, CallingConvention = call)] public static extern IntPtr model_create_file       ([In] byte[] filename_utf8, IntPtr shader);
+		[DllImport(dll, CharSet = cSet, CallingConvention = call)] public static extern IntPtr model_create_mem_flags  ([In] byte[] filename_utf8, [In] byte[] data, UIntPtr data_size, ModelImport import_flags, IntPtr shader);
+		[DllImport(dll, CharSet = cSet, CallingConvention = call)] public static extern IntPtr model_create_file_flags ([In] byte[] filename_utf8, ModelImport import_flags, IntPtr shader);
+		[DllImport(dll, CharSet = cSet, CallingConvention = call)] public static extern void        model_set_import_flags(ModelImport import_flags);
+		[DllImport(dll, CharSet = cSet, CallingConvention = call)] public static extern ModelImport model_get_import_flags();
 		[DllImport(dll, CharSet = cSet, CallingConvention = call)] public static extern void   model_set_id            (IntPtr model, string id);
 		[DllImport(dll, CharSet = cSet, CallingConvention = call)] public static extern IntPtr model_get_id            (IntPtr model);
 		[DllImport(dll, CharSet = cSet, CallingConvention = call)] public static extern void   model_addref            (IntPtr model);
@@ -372,6 +403,11 @@ namespace StereoKit
 		[return: MarshalAs(UnmanagedType.Bool)]
 		[DllImport(dll, CharSet = cSet, CallingConvention = call)] public static extern bool     model_play_anim             (IntPtr model, string animation_name, AnimMode mode);
 		[DllImport(dll, CharSet = cSet, CallingConvention = call)] public static extern void     model_play_anim_idx         (IntPtr model, int index,             AnimMode mode);
+		[DllImport(dll, CharSet = cSet, CallingConvention = call)] public static extern void     model_play_anim_crossfade   (IntPtr model, int index, AnimMode mode, float fade_seconds, int layer);
+		[DllImport(dll, CharSet = cSet, CallingConvention = call)] public static extern void     model_play_anim_blend       (IntPtr model, int index, AnimMode mode, float weight, float fade_seconds, int layer);
+		[DllImport(dll, CharSet = cSet, CallingConvention = call)] public static extern void     model_stop_anim             (IntPtr model, float fade_seconds, int layer);
+		[DllImport(dll, CharSet = cSet, CallingConvention = call)] public static extern void     model_anim_layer_set        (IntPtr model, int layer, AnimBlend blend, float weight);
+		[DllImport(dll, CharSet = cSet, CallingConvention = call)] public static extern void     model_anim_layer_set_mask   (IntPtr model, int layer, int node, float weight, [MarshalAs(UnmanagedType.Bool)] bool include_children);
 		[DllImport(dll, CharSet = cSet, CallingConvention = call)] public static extern void     model_set_anim_time         (IntPtr model, float time);
 		[DllImport(dll, CharSet = cSet, CallingConvention = call)] public static extern void     model_set_anim_completion   (IntPtr model, float percent);
 		[DllImport(dll, CharSet = cSet, CallingConvention = call)] public static extern int      model_anim_find             (IntPtr model, string animation_name);
@@ -459,6 +495,11 @@ namespace StereoKit
 		[DllImport(dll, CharSet = cSet, CallingConvention = call)] public static extern void               render_set_skylight   (in SphericalHarmonics lighting_info);
 		[DllImport(dll, CharSet = cSet, CallingConvention = call)] public static extern RenderLayer        render_get_filter     ();
 		[DllImport(dll, CharSet = cSet, CallingConvention = call)] public static extern void               render_set_filter     (RenderLayer layer_filter);
+		[DllImport(dll, CharSet = cSet, CallingConvention = call)] public static extern void               render_set_occlusion  ([MarshalAs(UnmanagedType.Bool)] bool enabled);
+		[return: MarshalAs(UnmanagedType.Bool)]
+		[DllImport(dll, CharSet = cSet, CallingConvention = call)] public static extern bool               render_get_occlusion  ();
+		[DllImport(dll, CharSet = cSet, CallingConvention = call)] public static extern void               render_set_view_budget(int max_views_per_frame);
+		[DllImport(dll, CharSet = cSet, CallingConvention = call)] public static extern int                render_get_view_budget();
 		[DllImport(dll, CharSet = cSet, CallingConvention = call)] public static extern void               render_set_scaling    (float display_tex_scale);
 		[DllImport(dll, CharSet = cSet, CallingConvention = call)] public static extern float              render_get_scaling    ();
 		[DllImport(dll, CharSet = cSet, CallingConvention = call)] public static extern void               render_set_viewport_scaling(float viewport_rect_scale);
@@ -469,6 +510,7 @@ namespace StereoKit
 		[DllImport(dll, CharSet = cSet, CallingConvention = call)] public static extern RenderLayer        render_get_capture_filter     ();
 		[return: MarshalAs(UnmanagedType.Bool)]
 		[DllImport(dll, CharSet = cSet, CallingConvention = call)] public static extern bool               render_has_capture_filter     ();
+		[DllImport(dll, CharSet = cSet, CallingConvention = call)] public static extern void               render_set_lod        (float max_pixel_error, float hysteresis);
 		[DllImport(dll, CharSet = cSet, CallingConvention = call)] public static extern SphericalHarmonics render_get_skylight   ();
 		[DllImport(dll, CharSet = cSet, CallingConvention = call)] public static extern void               render_set_clear_color(Color color);
 		[DllImport(dll, CharSet = cSet, CallingConvention = call)] public static extern Color              render_get_clear_color();
@@ -507,6 +549,22 @@ namespace StereoKit
 
 		///////////////////////////////////////////
 
+		[DllImport(dll, CharSet = cSet, CallingConvention = call)] public static extern IntPtr             render_view_find         (string id);
+		[DllImport(dll, CharSet = cSet, CallingConvention = call)] public static extern IntPtr             render_view_create       (IntPtr to_rendertarget, RenderLayer layer_filter, RenderClear clear, Rect viewport);
+		[DllImport(dll, CharSet = cSet, CallingConvention = call)] public static extern void               render_view_set_id       (IntPtr view, string id);
+		[DllImport(dll, CharSet = cSet, CallingConvention = call)] public static extern IntPtr             render_view_get_id       (IntPtr view);
+		[DllImport(dll, CharSet = cSet, CallingConvention = call)] public static extern void               render_view_addref       (IntPtr view);
+		[DllImport(dll, CharSet = cSet, CallingConvention = call)] public static extern void               render_view_release      (IntPtr view);
+		[DllImport(dll, CharSet = cSet, CallingConvention = call)] public static extern void               render_view_set_camera   (IntPtr view, in Matrix camera, in Matrix projection);
+		[DllImport(dll, CharSet = cSet, CallingConvention = call)] public static extern void               render_view_set_rate     (IntPtr view, float updates_per_second);
+		[DllImport(dll, CharSet = cSet, CallingConvention = call)] public static extern float              render_view_get_rate     (IntPtr view);
+		[DllImport(dll, CharSet = cSet, CallingConvention = call)] public static extern void               render_view_set_enabled  (IntPtr view, [MarshalAs(UnmanagedType.Bool)] bool enabled);
+		[return: MarshalAs(UnmanagedType.Bool)]
+		[DllImport(dll, CharSet = cSet, CallingConvention = call)] public static extern bool               render_view_get_enabled  (IntPtr view);
+		[DllImport(dll, CharSet = cSet, CallingConvention = call)] public static extern void               render_view_set_dirty    (IntPtr view);
+
+		///////////////////////////////////////////
+
 		[DllImport(dll, CharSet = cSet, CallingConvention = call)] public static extern void hierarchy_push(in Matrix transform, HierarchyParent parentBehavior);
 		[DllImport(dll, CharSet = cSet, CallingConvention = call)] public static extern void hierarchy_pop();
 		[DllImport(dll, CharSet = cSet, CallingConvention = call)] public static extern void hierarchy_set_enabled([MarshalAs(UnmanagedType.Bool)] bool enabled);
@@ -722,11 +780,37 @@ namespace StereoKit
 
 		[DllImport(dll, CharSet = cSet, CallingConvention = call)] public static extern void log_write      (LogLevel level, string text);
 		[DllImport(dll, CharSet = cSet, CallingConvention = call)] public static extern void log_set_filter (LogLevel level);
+		[DllImport(dll, CharSet = cSet, CallingConvention = call)] public static extern void log_set_rate_limit(int messages_per_second);
+		[DllImport(dll, CharSet = cSet, CallingConvention = call)] public static extern void log_set_dedup     ([MarshalAs(UnmanagedType.Bool)] bool collapse_repeats);
+		[DllImport(dll, CharSet = cSet, CallingConvention = call)] public static extern void log_flush         ();
 		[DllImport(dll, CharSet = cSet, CallingConvention = call)] public static extern void log_subscribe_data  (LogCallbackData on_log, IntPtr context);
 		[DllImport(dll, CharSet = cSet, CallingConvention = call)] public static extern void log_unsubscribe_data(LogCallbackData on_log, IntPtr context);
 		
 		///////////////////////////////////////////
 
+		[DllImport(dll, CharSet = cSet, CallingConvention = call)] public static extern void  profiler_set_enabled  ([MarshalAs(UnmanagedType.Bool)] bool enabled);
+		[return: MarshalAs(UnmanagedType.Bool)]
+		[DllImport(dll, CharSet = cSet, CallingConvention = call)] public static extern bool  profiler_get_enabled  ();
+		[DllImport(dll, CharSet = cSet, CallingConvention = call)] public static extern void  profiler_zone_begin   (IntPtr name_static);
+		[DllImport(dll, CharSet = cSet, CallingConvention = call)] public static extern void  profiler_zone_end     ();
+		[DllImport(dll, CharSet = cSet, CallingConvention = call)] public static extern int   profiler_frame_count  ();
+		[return: MarshalAs(UnmanagedType.Bool)]
+		[DllImport(dll, CharSet = cSet, CallingConvention = call)] public static extern bool  profiler_get_frame    (int frames_ago, out ProfilerFrame out_frame);
+		[DllImport(dll, CharSet = cSet, CallingConvention = call)] public static extern float profiler_get_system_ms(string system_name, int frames_ago);
+		[DllImport(dll, CharSet = cSet, CallingConvention = call)] public static extern float profiler_get_zone_ms  (string zone_name, int frames_ago);
+		[return: MarshalAs(UnmanagedType.Bool)]
+		[DllImport(dll, CharSet = cSet, CallingConvention = call)] public static extern bool  profiler_export_trace ([In] byte[] filename_utf8);
+
+		///////////////////////////////////////////
+
+		[DllImport(dll, CharSet = cSet, CallingConvention = call)] public static extern long memory_get_current       (MemoryTag tag);
+		[DllImport(dll, CharSet = cSet, CallingConvention = call)] public static extern long memory_get_peak          (MemoryTag tag);
+		[DllImport(dll, CharSet = cSet, CallingConvention = call)] public static extern void memory_set_budget        (MemoryTag tag, long budget_bytes);
+		[DllImport(dll, CharSet = cSet, CallingConvention = call)] public static extern long memory_get_budget        (MemoryTag tag);
+		[DllImport(dll, CharSet = cSet, CallingConvention = call)] public static extern void memory_on_budget_exceeded(MemoryBudgetCallbackData on_exceeded, IntPtr context);
+		
+		///////////////////////////////////////////
+
 		[DllImport(dll, CharSet = cSet, CallingConvention = call)] public static extern void      assets_releaseref_threadsafe(IntPtr asset);
 		[DllImport(dll, CharSet = cSet, CallingConvention = call)] public static extern int       assets_current_task         ();
 		[DllImport(dll, CharSet = cSet, CallingConvention = call)] public static extern int       assets_total_tasks          ();
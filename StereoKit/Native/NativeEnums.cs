@@ -288,6 +288,26 @@ namespace StereoKit
 		Copy,
 	}
 
+	/// <summary>Categories that StereoKit's memory accounting sorts its CPU
+	/// side allocations into, see `MemoryBudget`. GPU memory isn't counted
+	/// here.</summary>
+	public enum MemoryTag {
+		/// <summary>Vertex, index, and collision data for Meshes.</summary>
+		Mesh = 0,
+		/// <summary>CPU side Tex color and file data.</summary>
+		Texture,
+		/// <summary>Sound buffers and streams.</summary>
+		Audio,
+		/// <summary>Animation curves and keyframes.</summary>
+		Animation,
+		/// <summary>Font glyph data and atlases.</summary>
+		Font,
+		/// <summary>UI layout and element state.</summary>
+		UI,
+		/// <summary>Allocations made by the physics engine.</summary>
+		Physics,
+	}
+
 	/// <summary>When the device StereoKit is running on goes into standby mode, how should
 	/// StereoKit react? Typically the app should pause, stop playing sound, and
 	/// consume as little power as possible, but some scenarios such as multiplayer
@@ -774,6 +794,20 @@ namespace StereoKit
 		Unaffected,
 	}
 
+	/// <summary>The kinds of shapes that can be used for physics overlap
+	/// and sweep queries.</summary>
+	public enum PhysicsShapeType {
+		/// <summary>A sphere, `dimensions.x` is its diameter.</summary>
+		Sphere = 0,
+		/// <summary>A box, `dimensions` is its full size on each axis.
+		/// </summary>
+		Box,
+		/// <summary>A capsule along the Y axis, `dimensions.x` is its
+		/// diameter, and `dimensions.y` is the height of its cylinder
+		/// section.</summary>
+		Capsule,
+	}
+
 	/// <summary>Describes how an animation is played back, and what to do when
 	/// the animation hits the end.</summary>
 	public enum AnimMode {
@@ -789,6 +823,38 @@ namespace StereoKit
 		Manual,
 	}
 
+	/// <summary>Describes how an animation layer combines with the layers beneath
+	/// it.</summary>
+	public enum AnimBlend {
+		/// <summary>The layer replaces the pose of the layers beneath it, by the
+		/// layer's weight.</summary>
+		Override,
+		/// <summary>The layer's difference from the Model's rest pose is added on top
+		/// of the layers beneath it, scaled by the layer's weight.</summary>
+		Additive,
+	}
+
+	/// <summary>Extra processing that can be done on Mesh data while a Model is
+	/// being loaded from file. This work happens once at load time, and can
+	/// make the resulting Meshes cheaper to draw.</summary>
+	[Flags]
+	public enum ModelImport {
+		/// <summary>Use the Mesh data exactly as the file provided it.</summary>
+		None     = 0,
+		/// <summary>Merge duplicate vertices, and reorder indices and vertices so
+		/// the GPU's vertex cache is used well, overdraw is reduced, and vertex
+		/// data is fetched in order. Skinned Meshes are left as they are.</summary>
+		Optimize = 1 << 0,
+		/// <summary>Generate a level of detail chain for each Mesh, see
+		/// `Mesh.GenerateLods`. Skinned Meshes are left as they are.</summary>
+		Lods     = 1 << 1,
+		/// <summary>Split large Meshes into small clusters of triangles, so the
+		/// parts facing away from or outside of the view can be skipped when
+		/// drawing, see `Mesh.BuildClusters`. Small and skinned Meshes are left
+		/// as they are.</summary>
+		Clusters = 1 << 2,
+	}
+
 	/// <summary>The way the Sprite is stored on the backend! Does it get
 	/// batched and atlased for draw efficiency, or is it a single image?</summary>
 	public enum SpriteType {
@@ -1331,6 +1397,8 @@ namespace StereoKit
 		Anchor,
 		/// <summary>A RenderList</summary>
 		RenderList,
+		/// <summary>A RenderView</summary>
+		RenderView,
 	}
 
 }
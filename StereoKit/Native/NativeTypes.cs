@@ -475,6 +475,19 @@ namespace StereoKit
 	[UnmanagedFunctionPointer(CallingConvention.Cdecl)]
 	internal delegate void LogCallbackData(IntPtr context, LogLevel level, string text);
 
+	/// <summary>A callback for when a MemoryTag's usage first crosses its
+	/// budget. This can be called from whichever thread made the
+	/// allocation.</summary>
+	/// <param name="tag">The category that went over budget.</param>
+	/// <param name="currentBytes">How many bytes that category is now
+	/// using.</param>
+	/// <param name="budgetBytes">The budget that was exceeded, in bytes.
+	/// </param>
+	public delegate void MemoryBudgetCallback(MemoryTag tag, long currentBytes, long budgetBytes);
+
+	[UnmanagedFunctionPointer(CallingConvention.Cdecl)]
+	internal delegate void MemoryBudgetCallbackData(IntPtr context, MemoryTag tag, long current_bytes, long budget_bytes);
+
 	[UnmanagedFunctionPointer(CallingConvention.Cdecl)]
 	internal delegate void XRPreSessionCreateCallback(IntPtr context);
 
@@ -864,6 +877,91 @@ namespace StereoKit
 		[MarshalAs(UnmanagedType.Bool)] public bool flipFace;
 	}
 
+	/// <summary>Describes a shape in world space for querying the physics
+	/// world with, see `Physics.Overlap` and `Physics.Sweep`.</summary>
+	[StructLayout(LayoutKind.Sequential)]
+	public struct PhysicsShape
+	{
+		/// <summary>What kind of shape is this? This decides how
+		/// `dimensions` is interpreted.</summary>
+		public PhysicsShapeType type;
+		/// <summary>Location and orientation of the shape's center, in
+		/// world space.</summary>
+		public Pose pose;
+		/// <summary>Size of the shape in meters, see `PhysicsShapeType` for
+		/// what each axis means for each shape.</summary>
+		public Vec3 dimensions;
+
+		/// <summary>Creates a sphere shape for physics queries.</summary>
+		/// <param name="center">World space center of the sphere.</param>
+		/// <param name="diameter">Total size of the sphere, in meters.
+		/// </param>
+		/// <returns>A sphere shape.</returns>
+		public static PhysicsShape Sphere(Vec3 center, float diameter)
+			=> new PhysicsShape { type = PhysicsShapeType.Sphere, pose = new Pose(center, Quat.Identity), dimensions = new Vec3(diameter, diameter, diameter) };
+		/// <summary>Creates a box shape for physics queries.</summary>
+		/// <param name="pose">World space center and orientation of the box.
+		/// </param>
+		/// <param name="dimensions">Full size of the box on each axis, in
+		/// meters.</param>
+		/// <returns>A box shape.</returns>
+		public static PhysicsShape Box(Pose pose, Vec3 dimensions)
+			=> new PhysicsShape { type = PhysicsShapeType.Box, pose = pose, dimensions = dimensions };
+		/// <summary>Creates a capsule shape for physics queries. The capsule
+		/// runs along the pose's local Y axis.</summary>
+		/// <param name="pose">World space center and orientation of the
+		/// capsule.</param>
+		/// <param name="diameter">Diameter of the capsule, in meters.</param>
+		/// <param name="height">Height of the capsule's cylinder section,
+		/// not including the rounded caps, in meters.</param>
+		/// <returns>A capsule shape.</returns>
+		public static PhysicsShape Capsule(Pose pose, float diameter, float height)
+			=> new PhysicsShape { type = PhysicsShapeType.Capsule, pose = pose, dimensions = new Vec3(diameter, height, diameter) };
+	}
+
+	/// <summary>Where a physics raycast or sweep first touched a Solid.
+	/// </summary>
+	[StructLayout(LayoutKind.Sequential)]
+	public struct PhysicsHit
+	{
+		private IntPtr _solid;
+		/// <summary>The world space point of contact on the Solid's surface.
+		/// </summary>
+		public Vec3  point;
+		/// <summary>The world space surface normal of the Solid at the point
+		/// of contact.</summary>
+		public Vec3  normal;
+		/// <summary>How far along the ray or sweep the hit happened, in
+		/// meters.</summary>
+		public float distance;
+
+		/// <summary>Did the query actually hit anything? If this is false,
+		/// the rest of the hit's data is empty.</summary>
+		public bool Hit => _solid != IntPtr.Zero;
+
+		/// <summary>The Solid that was hit, or null if the query hit
+		/// nothing.</summary>
+		[Obsolete("Physics will be removed in v0.4, consider a 3rd party physics library like Bepu.")]
+		public Solid Solid { get {
+			if (_solid == IntPtr.Zero) return null;
+			NativeAPI.asset_addref(_solid);
+			return new Solid(_solid);
+		} }
+	}
+
+	/// <summary>Timing information about a single completed frame, as
+	/// recorded by the `Profiler`.</summary>
+	[StructLayout(LayoutKind.Sequential)]
+	public struct ProfilerFrame
+	{
+		/// <summary>The profiler's own index for this frame, counting up
+		/// from the first frame it recorded.</summary>
+		public ulong frame;
+		/// <summary>How long the whole frame took, in milliseconds.
+		/// </summary>
+		public float durationMs;
+	}
+
 	/// <summary>Id of a simulated hand pose, for use with
 	/// `Input.HandSimPoseRemove`</summary>
 	public struct HandSimId
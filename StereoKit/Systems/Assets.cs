@@ -60,6 +60,7 @@ namespace StereoKit
 				case Type _ when t == typeof(Tex       ): return AssetType.Tex;
 				case Type _ when t == typeof(Anchor    ): return AssetType.Anchor;
 				case Type _ when t == typeof(RenderList): return AssetType.RenderList;
+				case Type _ when t == typeof(RenderView): return AssetType.RenderView;
 				case Type _ when t == typeof(IAsset    ): return AssetType.None;
 				default: throw new ArgumentException("Not a valid asset type!");
 			}
@@ -80,6 +81,7 @@ namespace StereoKit
 				case AssetType.Tex:       return new Tex       (inst);
 				case AssetType.Anchor:    return new Anchor    (inst);
 				case AssetType.RenderList:return new RenderList(inst);
+				case AssetType.RenderView:return new RenderView(inst);
 				default: Log.Err("Found an invalid asset type!"); return null;
 			}
 		}
@@ -65,6 +65,32 @@ namespace StereoKit
 		private static void SetFilter(LogLevel level)
 			=> NativeAPI.log_set_filter(level);
 
+		/// <summary>The maximum number of messages per second that will be
+		/// written to the log, extra messages are dropped and counted in a
+		/// summary line instead. Errors are never dropped. 0 means there is
+		/// no limit, which is the default. This property can safely be set
+		/// before SK initialization.</summary>
+		public static int RateLimit { set{ NativeLib.Load(); SetRateLimit(value); } }
+		private static void SetRateLimit(int messagesPerSecond)
+			=> NativeAPI.log_set_rate_limit(messagesPerSecond);
+
+		/// <summary>When enabled, runs of the same message are collapsed
+		/// into a single count, which is reported once a different message
+		/// is logged, or after about a second. This applies to subscribers
+		/// too. Default is false. This property can safely be set before SK
+		/// initialization.</summary>
+		public static bool Dedup { set{ NativeLib.Load(); SetDedup(value); } }
+		private static void SetDedup(bool collapseRepeats)
+			=> NativeAPI.log_set_dedup(collapseRepeats);
+
+		/// <summary>While StereoKit is initialized, messages are written on
+		/// a log thread, and subscribers receive them on the main thread at
+		/// the start of each step. Called from the main thread, this
+		/// delivers everything logged so far to subscribers before it
+		/// returns.</summary>
+		public static void Flush()
+			=> NativeAPI.log_flush();
+
 		/// <summary>Writes a formatted line to the log with the specified
 		/// severity level!</summary>
 		/// <param name="level">Severity level of this log message.</param>
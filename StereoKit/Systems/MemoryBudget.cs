@@ -0,0 +1,56 @@
+﻿using System;
+
+namespace StereoKit
+{
+	/// <summary>StereoKit keeps count of the CPU side memory its assets and
+	/// systems use, sorted into MemoryTag categories. This lets you check
+	/// that usage, and set a budget for each category that will notify you
+	/// when it's exceeded. GPU memory isn't counted here.</summary>
+	public static class MemoryBudget
+	{
+		// Kept here so the GC doesn't collect it while native code holds it.
+		static MemoryBudgetCallbackData onExceeded;
+
+		/// <summary>How many bytes are currently allocated under this
+		/// category?</summary>
+		/// <param name="tag">The memory category.</param>
+		/// <returns>Current usage in bytes.</returns>
+		public static long Current(MemoryTag tag)
+			=> NativeAPI.memory_get_current(tag);
+
+		/// <summary>The most bytes that have been allocated under this
+		/// category at any one time.</summary>
+		/// <param name="tag">The memory category.</param>
+		/// <returns>Peak usage in bytes.</returns>
+		public static long Peak(MemoryTag tag)
+			=> NativeAPI.memory_get_peak(tag);
+
+		/// <summary>Sets a budget for a category. Going over it doesn't
+		/// prevent allocations, it only calls the OnExceeded callback.
+		/// </summary>
+		/// <param name="tag">The memory category.</param>
+		/// <param name="budgetBytes">The budget in bytes, 0 or less means
+		/// there is no budget.</param>
+		public static void Set(MemoryTag tag, long budgetBytes)
+			=> NativeAPI.memory_set_budget(tag, budgetBytes);
+
+		/// <summary>Gets the current budget for a category.</summary>
+		/// <param name="tag">The memory category.</param>
+		/// <returns>The budget in bytes, or 0 if there is none.</returns>
+		public static long Get(MemoryTag tag)
+			=> NativeAPI.memory_get_budget(tag);
+
+		/// <summary>Sets the callback that's called when a category first
+		/// goes over its budget. Only one callback is kept at a time, and
+		/// passing null removes it.</summary>
+		/// <param name="callback">The callback, note that this may be called
+		/// from any thread that allocates memory.</param>
+		public static void OnExceeded(MemoryBudgetCallback callback)
+		{
+			onExceeded = null;
+			if (callback != null)
+				onExceeded = (IntPtr context, MemoryTag tag, long current, long budget) => callback(tag, current, budget);
+			NativeAPI.memory_on_budget_exceeded(onExceeded, IntPtr.Zero);
+		}
+	}
+}
@@ -0,0 +1,112 @@
+﻿using System;
+
+namespace StereoKit
+{
+	/// <summary>Queries against the Solids in StereoKit's physics world!
+	/// These let you cast rays and sweep or overlap shapes against every
+	/// Solid at once, and the batch variants let you do many queries in a
+	/// single call to the native side.</summary>
+	[Obsolete("Physics will be removed in v0.4, consider a 3rd party physics library like Bepu.")]
+	public static class Physics
+	{
+		/// <summary>Casts a world space ray against all Solids, and finds
+		/// the closest one it hits.</summary>
+		/// <param name="ray">A world space ray, the direction does not need
+		/// to be normalized.</param>
+		/// <param name="maxDistance">How far along the ray to look, in
+		/// meters.</param>
+		/// <param name="hit">Information about the closest hit, if there
+		/// was one.</param>
+		/// <returns>True if the ray hit a Solid, false otherwise.</returns>
+		public static bool Raycast(Ray ray, float maxDistance, out PhysicsHit hit)
+			=> NativeAPI.physics_raycast(ray, maxDistance, out hit);
+
+		/// <summary>Casts many world space rays against all Solids at once.
+		/// </summary>
+		/// <param name="rays">A list of world space rays.</param>
+		/// <param name="maxDistance">How far along each ray to look, in
+		/// meters.</param>
+		/// <param name="hits">Receives one hit for each ray, this must be at
+		/// least as long as `rays`. Check `PhysicsHit.Hit` to see if each
+		/// ray hit anything.</param>
+		/// <returns>The number of rays that hit a Solid.</returns>
+		public static int RaycastBatch(Ray[] rays, float maxDistance, PhysicsHit[] hits)
+		{
+			if (hits.Length < rays.Length) throw new ArgumentException("hits must be at least as long as rays!");
+			return NativeAPI.physics_raycast_batch(rays, rays.Length, maxDistance, hits);
+		}
+
+		/// <summary>Finds all the Solids that overlap the given shape.
+		/// </summary>
+		/// <param name="shape">A world space shape to test against.</param>
+		/// <param name="maxSolids">The maximum number of Solids to return.
+		/// </param>
+		/// <returns>The Solids overlapping the shape, up to `maxSolids`.
+		/// </returns>
+		public static Solid[] Overlap(PhysicsShape shape, int maxSolids = 16)
+		{
+			IntPtr[] solids = new IntPtr[maxSolids];
+			int      count  = NativeAPI.physics_overlap(shape, solids, maxSolids);
+			return ToSolids(solids, 0, count);
+		}
+
+		/// <summary>Finds the Solids overlapping each of the given shapes,
+		/// all in one call.</summary>
+		/// <param name="shapes">A list of world space shapes to test.
+		/// </param>
+		/// <param name="maxSolidsPerShape">The maximum number of Solids to
+		/// return for each shape.</param>
+		/// <returns>One array of overlapping Solids for each shape.
+		/// </returns>
+		public static Solid[][] OverlapBatch(PhysicsShape[] shapes, int maxSolidsPerShape = 16)
+		{
+			IntPtr[] solids = new IntPtr[shapes.Length * maxSolidsPerShape];
+			int   [] counts = new int   [shapes.Length];
+			NativeAPI.physics_overlap_batch(shapes, shapes.Length, solids, maxSolidsPerShape, counts);
+
+			Solid[][] result = new Solid[shapes.Length][];
+			for (int i = 0; i < shapes.Length; i++)
+				result[i] = ToSolids(solids, i * maxSolidsPerShape, counts[i]);
+			return result;
+		}
+
+		/// <summary>Moves a shape through the world along `motion`, and
+		/// finds the first Solid it would touch.</summary>
+		/// <param name="shape">A world space shape at its starting location.
+		/// </param>
+		/// <param name="motion">The direction and distance to move the
+		/// shape, in meters.</param>
+		/// <param name="hit">Information about the first hit, if there was
+		/// one.</param>
+		/// <returns>True if the shape hit a Solid, false otherwise.</returns>
+		public static bool Sweep(PhysicsShape shape, Vec3 motion, out PhysicsHit hit)
+			=> NativeAPI.physics_sweep(shape, motion, out hit);
+
+		/// <summary>Sweeps many shapes through the world at once.</summary>
+		/// <param name="shapes">A list of world space shapes at their
+		/// starting locations.</param>
+		/// <param name="motions">The motion for each shape, this must be the
+		/// same length as `shapes`.</param>
+		/// <param name="hits">Receives one hit for each shape, this must be
+		/// at least as long as `shapes`. Check `PhysicsHit.Hit` to see if
+		/// each shape hit anything.</param>
+		/// <returns>The number of shapes that hit a Solid.</returns>
+		public static int SweepBatch(PhysicsShape[] shapes, Vec3[] motions, PhysicsHit[] hits)
+		{
+			if (motions.Length != shapes.Length) throw new ArgumentException("motions must be the same length as shapes!");
+			if (hits   .Length <  shapes.Length) throw new ArgumentException("hits must be at least as long as shapes!");
+			return NativeAPI.physics_sweep_batch(shapes, motions, shapes.Length, hits);
+		}
+
+		private static Solid[] ToSolids(IntPtr[] solids, int start, int count)
+		{
+			Solid[] result = new Solid[count];
+			for (int i = 0; i < count; i++)
+			{
+				NativeAPI.asset_addref(solids[start + i]);
+				result[i] = new Solid(solids[start + i]);
+			}
+			return result;
+		}
+	}
+}
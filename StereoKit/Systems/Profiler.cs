@@ -0,0 +1,93 @@
+﻿using System;
+using System.Collections.Generic;
+using System.Runtime.InteropServices;
+
+namespace StereoKit
+{
+	/// <summary>StereoKit's built-in CPU profiler! This records how long
+	/// each frame and each of StereoKit's systems take, as well as any
+	/// zones you mark in your own code. It's disabled by default, and zones
+	/// cost very little until you enable it.</summary>
+	public static class Profiler
+	{
+		// The native profiler keeps zone names by pointer, so each name is
+		// copied to native memory once, and kept for the life of the app.
+		static Dictionary<string, IntPtr> zoneNames = new Dictionary<string, IntPtr>();
+
+		/// <summary>Is the profiler currently recording? Default is false.
+		/// </summary>
+		public static bool Enabled
+		{
+			get => NativeAPI.profiler_get_enabled();
+			set => NativeAPI.profiler_set_enabled(value);
+		}
+
+		/// <summary>How many completed frames of history are available to
+		/// query? The frame currently being recorded is not included.
+		/// </summary>
+		public static int FrameCount => NativeAPI.profiler_frame_count();
+
+		/// <summary>Starts a named timing zone on the current thread. Every
+		/// ZoneBegin must be paired with a ZoneEnd on the same thread, and
+		/// zones can be nested.</summary>
+		/// <param name="name">The name of the zone, this is what shows up
+		/// in queries and trace exports.</param>
+		public static void ZoneBegin(string name)
+		{
+			IntPtr namePtr;
+			lock (zoneNames)
+			{
+				if (!zoneNames.TryGetValue(name, out namePtr))
+				{
+					byte[] nameUtf8 = NativeHelper.ToUtf8(name);
+					namePtr = Marshal.AllocHGlobal(nameUtf8.Length);
+					Marshal.Copy(nameUtf8, 0, namePtr, nameUtf8.Length);
+					zoneNames[name] = namePtr;
+				}
+			}
+			NativeAPI.profiler_zone_begin(namePtr);
+		}
+
+		/// <summary>Ends the most recent zone started on this thread with
+		/// ZoneBegin.</summary>
+		public static void ZoneEnd()
+			=> NativeAPI.profiler_zone_end();
+
+		/// <summary>Gets the timing of a completed frame.</summary>
+		/// <param name="framesAgo">0 is the most recently completed frame,
+		/// up to FrameCount-1.</param>
+		/// <param name="frame">Timing info for the frame.</param>
+		/// <returns>False if that frame isn't in the profiler's history.
+		/// </returns>
+		public static bool GetFrame(int framesAgo, out ProfilerFrame frame)
+			=> NativeAPI.profiler_get_frame(framesAgo, out frame);
+
+		/// <summary>How long one of StereoKit's systems took during a
+		/// completed frame.</summary>
+		/// <param name="systemName">Name of the system, like "Renderer".
+		/// </param>
+		/// <param name="framesAgo">0 is the most recently completed frame.
+		/// </param>
+		/// <returns>Duration in milliseconds, or 0 if not found.</returns>
+		public static float GetSystemMs(string systemName, int framesAgo = 0)
+			=> NativeAPI.profiler_get_system_ms(systemName, framesAgo);
+
+		/// <summary>How long all zones with this name took in total during a
+		/// completed frame.</summary>
+		/// <param name="zoneName">Name of the zone, as passed to ZoneBegin.
+		/// </param>
+		/// <param name="framesAgo">0 is the most recently completed frame.
+		/// </param>
+		/// <returns>Duration in milliseconds, or 0 if not found.</returns>
+		public static float GetZoneMs(string zoneName, int framesAgo = 0)
+			=> NativeAPI.profiler_get_zone_ms(zoneName, framesAgo);
+
+		/// <summary>Writes the recorded history to a Chrome trace event JSON
+		/// file, which can be opened in chrome://tracing or Perfetto.
+		/// </summary>
+		/// <param name="filename">Where to save the trace.</param>
+		/// <returns>True if the file was written successfully.</returns>
+		public static bool ExportTrace(string filename)
+			=> NativeAPI.profiler_export_trace(NativeHelper.ToUtf8(filename));
+	}
+}
@@ -58,6 +58,27 @@ namespace StereoKit
 			set => NativeAPI.render_enable_skytex(value);
 		}
 
+		/// <summary>Enables or disables occlusion culling. When enabled,
+		/// Meshes marked as `Mesh.Occluder` are rasterized into a small depth
+		/// buffer on the CPU each frame, and anything completely hidden
+		/// behind them is skipped. Orthographic views don't get occlusion
+		/// culling. Disabled by default.</summary>
+		public static bool EnableOcclusion
+		{
+			get => NativeAPI.render_get_occlusion();
+			set => NativeAPI.render_set_occlusion(value);
+		}
+
+		/// <summary>The most RenderViews that will be drawn in a single
+		/// frame. Views that are due past this are drawn on later frames,
+		/// taking turns so every view gets drawn eventually. 0 means there
+		/// is no limit, which is the default.</summary>
+		public static int ViewBudget
+		{
+			get => NativeAPI.render_get_view_budget();
+			set => NativeAPI.render_set_view_budget(value);
+		}
+
 		/// <summary>By default, StereoKit renders all first-person layers.
 		/// This is a bit flag that allows you to change which layers StereoKit
 		/// renders for the primary viewpoint. To change what layers a visual
@@ -276,6 +297,20 @@ namespace StereoKit
 		public static void SetOrthoSize(float viewportHeightMeters)
 			=> NativeAPI.render_set_ortho_size(viewportHeightMeters);
 
+		/// <summary>Sets how aggressively StereoKit swaps Meshes for their
+		/// simplified LOD levels, see `Mesh.GenerateLods`. A level is used
+		/// when its simplification error would cover fewer pixels on screen
+		/// than this. 0 always draws the full Mesh.</summary>
+		/// <param name="maxPixelError">The largest on-screen error allowed,
+		/// in pixels. Default is 1.</param>
+		/// <param name="hysteresis">How much further under the threshold a
+		/// Mesh has to get before it switches to a coarser level than it
+		/// last used, as a fraction of maxPixelError. This keeps objects
+		/// sitting right at a threshold from flickering between levels.
+		/// Default is 0.25.</param>
+		public static void SetLod(float maxPixelError = 1, float hysteresis = 0.25f)
+			=> NativeAPI.render_set_lod(maxPixelError, hysteresis);
+
 		/// <summary>Renders a Material onto a rendertarget texture! StereoKit uses a 4 vert quad stretched
 		/// over the surface of the texture, and renders the material onto it to the texture.</summary>
 		/// <param name="toRendertarget">A texture that's been set up as a render target!</param>
@@ -2,11 +2,16 @@
 #include "model.h"
 #include "mesh.h"
 #include "../sk_math.h"
+#include "../sk_memory.h"
 #include "../libraries/stref.h"
+#include "../utils/jobs.h"
+
+#include <string.h>
 
 namespace sk {
 
-array_t<model_t> animation_list = {};
+array_t<model_t> animation_list   = {};
+array_t<model_t> anim_update_list = {};
 
 ///////////////////////////////////////////
 
@@ -60,121 +65,408 @@ vec4 gltf_cubic_f4(vec4 value, vec4 in_tangent_next, vec4 out_tangent, vec4 next
 
 ///////////////////////////////////////////
 
-vec3 anim_curve_sample_f3(const anim_curve_t *curve, int32_t *prev_index, float t) {
-	int32_t frame      = anim_frame(curve, *prev_index, t);
-	float   frame_time = curve->keyframe_times[frame];
-	float   frame_dur  = curve->keyframe_times[frame+1] - frame_time;
-	float   pct        = math_saturate((t - frame_time) / frame_dur);
-	vec3   *pts        = (vec3*)curve->keyframe_values;
-	*prev_index = frame;
+void anim_find_frames(const anim_t *anim, int32_t *last_keyframe, float t, anim_sample_t *samples) {
+	for (int32_t i = 0; i < anim->curves.count; i++) {
+		const anim_curve_t *curve = &anim->curves[i];
+		anim_sample_t      *s     = &samples[i];
+		if (curve->keyframe_count <= 1) {
+			*s = {};
+			continue;
+		}
 
-	if (curve->keyframe_count <= 1) {
-		return pts[0];
+		int32_t frame = anim_frame(curve, last_keyframe[i], t);
+		if (frame < 0) frame = 0;
+		float frame_time = curve->keyframe_times[frame];
+		last_keyframe[i] = frame;
+		s->frame    = frame;
+		s->next     = frame + 1;
+		s->duration = curve->keyframe_times[frame+1] - frame_time;
+		s->pct      = s->duration > 0 ? math_saturate((t - frame_time) / s->duration) : 0;
 	}
+}
 
-	switch (curve->interpolation) {
-	case anim_interpolation_linear: return vec3_lerp(pts[frame], pts[frame + 1], pct); break;
-	case anim_interpolation_step:   return pts[frame]; break;
+///////////////////////////////////////////
+
+void anim_sample_run_f3(const anim_t *anim, const anim_run_t *run, const anim_sample_t *samples, anim_transform_t *pose, vec3 anim_transform_t::*field) {
+	const anim_curve_t  *curves = &anim->curves[run->curve_start];
+	const anim_sample_t *s      = &samples     [run->curve_start];
+
+	switch (run->interpolation) {
+	case anim_interpolation_linear: {
+		for (int32_t i = 0; i < run->curve_count; i++) {
+			const vec3       *pts = (const vec3*)curves[i].keyframe_values;
+			anim_transform_t *tr  = &pose[curves[i].node_id];
+			tr->*field = vec3_lerp(pts[s[i].frame], pts[s[i].next], s[i].pct);
+			tr->dirty  = true;
+		}
+	} break;
+	case anim_interpolation_step: {
+		for (int32_t i = 0; i < run->curve_count; i++) {
+			const vec3       *pts = (const vec3*)curves[i].keyframe_values;
+			anim_transform_t *tr  = &pose[curves[i].node_id];
+			tr->*field = pts[s[i].frame];
+			tr->dirty  = true;
+		}
+	} break;
 	case anim_interpolation_cubic: {
-		int32_t id      = frame * 3;
-		int32_t id_next = (frame+1) * 3;
-		return gltf_cubic_f3(pts[id + 1], pts[id_next], pts[id + 2], pts[id_next + 1], pct, frame_dur);
-	}break;
-	default: return pts[frame]; break;
+		for (int32_t i = 0; i < run->curve_count; i++) {
+			const vec3       *pts     = (const vec3*)curves[i].keyframe_values;
+			anim_transform_t *tr      = &pose[curves[i].node_id];
+			int32_t           id      = s[i].frame * 3;
+			int32_t           id_next = s[i].next  * 3;
+			tr->*field = gltf_cubic_f3(pts[id + 1], pts[id_next], pts[id + 2], pts[id_next + 1], s[i].pct, s[i].duration);
+			tr->dirty  = true;
+		}
+	} break;
 	}
 }
 
 ///////////////////////////////////////////
 
-quat anim_curve_sample_f4(const anim_curve_t *curve, int32_t *prev_index, float t) {
-	int32_t frame      = anim_frame(curve, *prev_index, t);
-	float   frame_time = curve->keyframe_times[frame];
-	float   frame_dur  = curve->keyframe_times[frame+1] - frame_time;
-	float   pct        = math_saturate((t - frame_time) / frame_dur);
-	quat   *pts        = (quat*)curve->keyframe_values;
-	*prev_index = frame;
+void anim_sample_run_f4(const anim_t *anim, const anim_run_t *run, const anim_sample_t *samples, anim_transform_t *pose) {
+	const anim_curve_t  *curves = &anim->curves[run->curve_start];
+	const anim_sample_t *s      = &samples     [run->curve_start];
+
+	switch (run->interpolation) {
+	case anim_interpolation_linear: {
+		for (int32_t i = 0; i < run->curve_count; i++) {
+			const quat       *pts = (const quat*)curves[i].keyframe_values;
+			anim_transform_t *tr  = &pose[curves[i].node_id];
+			tr->rotation = quat_slerp(pts[s[i].frame], pts[s[i].next], s[i].pct);
+			tr->dirty    = true;
+		}
+	} break;
+	case anim_interpolation_step: {
+		for (int32_t i = 0; i < run->curve_count; i++) {
+			const quat       *pts = (const quat*)curves[i].keyframe_values;
+			anim_transform_t *tr  = &pose[curves[i].node_id];
+			tr->rotation = pts[s[i].frame];
+			tr->dirty    = true;
+		}
+	} break;
+	case anim_interpolation_cubic: {
+		for (int32_t i = 0; i < run->curve_count; i++) {
+			const vec4       *vecs    = (const vec4*)curves[i].keyframe_values;
+			anim_transform_t *tr      = &pose[curves[i].node_id];
+			int32_t           id      = s[i].frame * 3;
+			int32_t           id_next = s[i].next  * 3;
+			vec4              result  = gltf_cubic_f4(vecs[id + 1], vecs[id_next], vecs[id + 2], vecs[id_next + 1], s[i].pct, s[i].duration);
+			tr->rotation = quat_normalize({ result.x, result.y, result.z, result.w });
+			tr->dirty    = true;
+		}
+	} break;
+	}
+}
+
+///////////////////////////////////////////
+
+// Samples every curve of the animation into pose. Keyframe searches happen
+// first for all curves, then each run of same-typed curves is evaluated in
+// a single loop.
+void anim_sample(const anim_t *anim, float t, int32_t *last_keyframe, anim_sample_t *samples, anim_transform_t *pose) {
+	anim_find_frames(anim, last_keyframe, t, samples);
+
+	for (int32_t r = 0; r < anim->runs.count; r++) {
+		const anim_run_t *run = &anim->runs[r];
+		switch (run->applies_to) {
+		case anim_element_translation: anim_sample_run_f3(anim, run, samples, pose, &anim_transform_t::translation); break;
+		case anim_element_scale:       anim_sample_run_f3(anim, run, samples, pose, &anim_transform_t::scale);       break;
+		case anim_element_rotation:    anim_sample_run_f4(anim, run, samples, pose);                                 break;
+		default: break;
+		}
+	}
+}
+
+///////////////////////////////////////////
 
-	if (curve->keyframe_count <= 1) {
-		return pts[0];
+void anim_accumulate(const anim_t *anim, const anim_transform_t *pose, anim_blend_t *blend, float weight) {
+	for (int32_t r = 0; r < anim->runs.count; r++) {
+		const anim_run_t   *run    = &anim->runs[r];
+		const anim_curve_t *curves = &anim->curves[run->curve_start];
+
+		switch (run->applies_to) {
+		case anim_element_translation: {
+			for (int32_t i = 0; i < run->curve_count; i++) {
+				model_node_id node = curves[i].node_id;
+				blend[node].translation        += pose[node].translation * weight;
+				blend[node].weight_translation += weight;
+			}
+		} break;
+		case anim_element_scale: {
+			for (int32_t i = 0; i < run->curve_count; i++) {
+				model_node_id node = curves[i].node_id;
+				blend[node].scale        += pose[node].scale * weight;
+				blend[node].weight_scale += weight;
+			}
+		} break;
+		case anim_element_rotation: {
+			for (int32_t i = 0; i < run->curve_count; i++) {
+				model_node_id node = curves[i].node_id;
+				quat          q    = pose[node].rotation;
+				vec4          v    = { q.x, q.y, q.z, q.w };
+				// Opposite quaternions are the same rotation, but would cancel
+				// each other out in a sum, so keep them in one hemisphere.
+				const vec4 &acc = blend[node].rotation;
+				if (acc.x*v.x + acc.y*v.y + acc.z*v.z + acc.w*v.w < 0)
+					v = v * -1.0f;
+				blend[node].rotation        = acc + v * weight;
+				blend[node].weight_rotation += weight;
+			}
+		} break;
+		default: break;
+		}
 	}
+}
 
-	switch (curve->interpolation) {
-	case anim_interpolation_linear: return quat_slerp(pts[frame], pts[frame + 1], pct); break;
-	case anim_interpolation_step:   return pts[frame]; break;
-	case anim_interpolation_cubic:  {
-		vec4   *vecs    = (vec4*)curve->keyframe_values;
-		int32_t id      = frame * 3;
-		int32_t id_next = (frame+1) * 3;
-		vec4    result  = gltf_cubic_f4(vecs[id + 1], vecs[id_next], vecs[id + 2], vecs[id_next + 1], pct, frame_dur);
-		return { result.x, result.y, result.z, result.w };
-	} break;
-	default: return pts[frame]; break;
+///////////////////////////////////////////
+
+void anim_apply_layer(anim_inst_t *inst, const anim_layer_t *layer) {
+	for (int32_t i = 0; i < inst->node_count; i++) {
+		const anim_blend_t *b = &inst->blend_layer[i];
+		if (b->weight_translation <= 0 && b->weight_rotation <= 0 && b->weight_scale <= 0) continue;
+
+		float layer_weight = layer->node_mask ? layer->weight * layer->node_mask[i] : layer->weight;
+		if (layer_weight <= 0) continue;
+
+		anim_transform_t       *tr       = &inst->node_transforms[i];
+		const anim_transform_t *rest     = &inst->rest_transforms[i];
+		bool                    additive = layer->blend == anim_blend_additive;
+		tr->dirty = true;
+
+		if (b->weight_translation > 0) {
+			vec3  value = b->translation / b->weight_translation;
+			float pct   = fminf(b->weight_translation, 1) * layer_weight;
+			if (additive) tr->translation += (value - rest->translation) * pct;
+			else          tr->translation  = vec3_lerp(tr->translation, value, math_saturate(pct));
+		}
+		if (b->weight_scale > 0) {
+			vec3  value = b->scale / b->weight_scale;
+			float pct   = fminf(b->weight_scale, 1) * layer_weight;
+			if (additive) {
+				vec3 delta = {
+					rest->scale.x != 0 ? value.x / rest->scale.x : 1,
+					rest->scale.y != 0 ? value.y / rest->scale.y : 1,
+					rest->scale.z != 0 ? value.z / rest->scale.z : 1 };
+				tr->scale = tr->scale * vec3_lerp(vec3_one, delta, pct);
+			} else {
+				tr->scale = vec3_lerp(tr->scale, value, math_saturate(pct));
+			}
+		}
+		if (b->weight_rotation > 0) {
+			quat  value = quat_normalize({ b->rotation.x, b->rotation.y, b->rotation.z, b->rotation.w });
+			float pct   = fminf(b->weight_rotation, 1) * layer_weight;
+			if (additive) tr->rotation = quat_slerp(quat_identity, value * quat_inverse(rest->rotation), pct) * tr->rotation;
+			else          tr->rotation = quat_slerp(tr->rotation, value, math_saturate(pct));
+		}
 	}
 }
 
 ///////////////////////////////////////////
 
-static void anim_update_transforms(model_t model, model_node_id node_id, bool dirty_world) {
-	while (node_id != -1) {
-		model_node_t     *node  = &model->nodes[node_id];
-		anim_transform_t *tr    = &model->anim_inst.node_transforms[node_id];
-		bool              dirty = dirty_world;
+float anim_clip_weight(const anim_clip_t *clip, float now) {
+	if (clip->fade_duration <= 0) return clip->weight_to;
+	float pct = math_saturate((now - clip->fade_start) / clip->fade_duration);
+	return clip->weight_from + (clip->weight_to - clip->weight_from) * pct;
+}
+
+///////////////////////////////////////////
 
-		// Only update this node_id if the animation touched the transform
-		if (tr->dirty) {
+bool anim_clip_fading(const anim_clip_t *clip, float now) {
+	return clip->fade_duration > 0 && now - clip->fade_start < clip->fade_duration;
+}
+
+///////////////////////////////////////////
+
+void anim_clip_fade(anim_clip_t *clip, float weight, float fade_seconds, float now) {
+	clip->weight_from   = anim_clip_weight(clip, now);
+	clip->weight_to     = weight;
+	clip->fade_start    = now;
+	clip->fade_duration = fade_seconds;
+}
+
+///////////////////////////////////////////
+
+float anim_clip_time(const anim_data_t *data, const anim_clip_t *clip) {
+	float max_time = data->anims[clip->anim_id].duration;
+	switch (clip->mode) {
+	case anim_mode_manual: return fminf(                clip->start_time, max_time);
+	case anim_mode_once:   return fminf(time_totalf() - clip->start_time, max_time);
+	case anim_mode_loop:   return max_time > 0 ? fmodf(time_totalf() - clip->start_time, max_time) : 0;
+	default:               return 0;
+	}
+}
+
+///////////////////////////////////////////
+
+static void anim_update_transforms(model_t model) {
+	anim_inst_t *inst = &model->anim_inst;
+
+	// Nodes are only ever added after their parent, so a single pass in
+	// array order always sees a parent's transform before its children.
+	for (int32_t i = 0; i < model->nodes.count; i++) {
+		model_node_t     *node  = &model->nodes[i];
+		anim_transform_t *tr    = i < inst->node_count ? &inst->node_transforms[i] : nullptr;
+		bool              moved = node->parent >= 0 && node->parent < inst->node_count && inst->node_transforms[node->parent].moved;
+
+		// Only update this node if the animation touched the transform
+		if (tr != nullptr) tr->posed = tr->dirty;
+		if (tr != nullptr && tr->dirty) {
 			node->transform_local = matrix_trs(tr->translation, tr->rotation, tr->scale);
 			tr->dirty             = false;
-			dirty                 = true;
+			moved                 = true;
 		}
 
-		// If this node_id or a parent node_id was touched, we need to update the world
-		// transform.
-		if (dirty == true) {
+		// If this node or a parent node was touched, we need to update the
+		// world transform.
+		if (moved) {
 			if (node->parent >= 0) node->transform_model = node->transform_local * model->nodes[node->parent].transform_model;
 			else                   node->transform_model = node->transform_local;
 
 			if (node->visual >= 0)
 				model->visuals[node->visual].transform_model = node->transform_model;
 		}
-		anim_update_transforms(model, node->child, dirty);
-		node_id = node->sibling;
+		if (tr != nullptr) tr->moved = moved;
 	}
 }
 
 ///////////////////////////////////////////
 
-void anim_update_model(model_t model) {
-	if (model->anim_inst.anim_id < 0) return;
+void anim_blend_layers(model_t model, float now) {
+	anim_inst_t *inst = &model->anim_inst;
+
+	// Layers stack on top of the rest pose
+	for (int32_t i = 0; i < inst->node_count; i++) {
+		inst->node_transforms[i].translation = inst->rest_transforms[i].translation;
+		inst->node_transforms[i].rotation    = inst->rest_transforms[i].rotation;
+		inst->node_transforms[i].scale       = inst->rest_transforms[i].scale;
+	}
 
-	// Don't update more than once per frame
-	float curr_time = model->anim_inst.mode == anim_mode_manual 
-		? model->anim_inst.start_time
-		: time_totalf();
-	if (model->anim_inst.last_update == curr_time) return;
-	model->anim_inst.last_update = curr_time;
-	model->transforms_changed    = true;
-	model->bounds_dirty          = true;
+	for (int32_t l = 0; l < inst->layers.count; l++) {
+		anim_layer_t *layer = &inst->layers[l];
+		if (layer->weight <= 0 || layer->clips.count == 0) continue;
 
-	anim_t *anim = &model->anim_data.anims[model->anim_inst.anim_id];
-	float   time = model_anim_active_time(model);
+		memset(inst->blend_layer, 0, sizeof(anim_blend_t) * inst->node_count);
+		for (int32_t c = 0; c < layer->clips.count; c++) {
+			anim_clip_t *clip   = &layer->clips[c];
+			float        weight = anim_clip_weight(clip, now);
+			if (weight <= 0) continue;
 
-	for (int32_t i = 0; i < anim->curves.count; i++) {
-		model_node_id node = anim->curves[i].node_id;
-
-		model->anim_inst.node_transforms[node].dirty = true;
-		switch (anim->curves[i].applies_to) {
-		case anim_element_translation: model->anim_inst.node_transforms[node].translation = anim_curve_sample_f3(&anim->curves[i], &model->anim_inst.curve_last_keyframe[i], time); break;
-		case anim_element_scale:       model->anim_inst.node_transforms[node].scale       = anim_curve_sample_f3(&anim->curves[i], &model->anim_inst.curve_last_keyframe[i], time); break;
-		case anim_element_rotation:    model->anim_inst.node_transforms[node].rotation    = anim_curve_sample_f4(&anim->curves[i], &model->anim_inst.curve_last_keyframe[i], time); break;
-		//case anim_element_weights:     log_errf("anim_update_model doesn't implement anim_element_weights yet!");
+			const anim_t *anim = &model->proto->anim_data.anims[clip->anim_id];
+			anim_sample    (anim, anim_clip_time(&model->proto->anim_data, clip), clip->curve_last_keyframe, inst->samples, inst->blend_clip);
+			anim_accumulate(anim, inst->blend_clip, inst->blend_layer, weight);
 		}
+		anim_apply_layer(inst, layer);
+	}
+}
+
+///////////////////////////////////////////
+
+static void anim_reapply_pose(model_t model) {
+	anim_inst_t *inst = &model->anim_inst;
+	for (int32_t i = 0; i < inst->node_count; i++) {
+		if (inst->node_transforms[i].posed)
+			inst->node_transforms[i].dirty = true;
 	}
-	anim_update_transforms(model, model_node_get_root(model), false);
+	inst->pose_edited         = false;
+	model->transforms_changed = true;
+	model->bounds_dirty       = true;
+	anim_update_transforms(model);
+}
+
+///////////////////////////////////////////
+
+// Touches nothing outside of this model, so models can be updated in
+// parallel with each other.
+void _anim_update_model(model_t model) {
+	anim_inst_t *inst = &model->anim_inst;
+	if (inst->layers.count == 0) return;
+
+	// Don't update more than once per frame, or at all if nothing is moving
+	float now = time_totalf();
+	if (inst->dirty == false && (inst->animating == false || inst->last_update == now)) {
+		// The app may have moved nodes after this frame's pose was applied,
+		// like between AnimationBegin and drawing. The animation has always
+		// won over those edits, so put the same pose back on top.
+		if (inst->pose_edited && inst->last_update == now)
+			anim_reapply_pose(model);
+		return;
+	}
+	inst->last_update         = now;
+	inst->pose_edited         = false;
+	inst->dirty               = false;
+	inst->animating           = false;
+	model->transforms_changed = true;
+	model->bounds_dirty       = true;
+
+	// Drop clips that have faded out, and figure out if we'll need to update
+	// again next frame.
+	for (int32_t l = 0; l < inst->layers.count; l++) {
+		anim_layer_t *layer = &inst->layers[l];
+		for (int32_t c = layer->clips.count - 1; c >= 0; c--) {
+			anim_clip_t *clip   = &layer->clips[c];
+			bool         fading = anim_clip_fading(clip, now);
+			if (!fading && clip->weight_to <= 0) {
+				sk_free(clip->curve_last_keyframe);
+				layer->clips.remove(c);
+				continue;
+			}
+			if (fading ||
+				clip->mode == anim_mode_loop ||
+				(clip->mode == anim_mode_once && now - clip->start_time < model->proto->anim_data.anims[clip->anim_id].duration))
+				inst->animating = true;
+		}
+	}
+
+	// A single clip at full weight is by far the most common case, and it
+	// can be sampled straight into the final pose.
+	const anim_layer_t *base = &inst->layers[0];
+	if (inst->layers.count == 1 &&
+		base->clips.count  == 1 &&
+		base->blend        == anim_blend_override &&
+		base->weight       >= 1 &&
+		base->node_mask    == nullptr &&
+		anim_clip_weight(&base->clips[0], now) >= 1) {
+		anim_clip_t *clip = &base->clips[0];
+		anim_sample(&model->proto->anim_data.anims[clip->anim_id], anim_clip_time(&model->proto->anim_data, clip), clip->curve_last_keyframe, inst->samples, inst->node_transforms);
+	} else {
+		anim_blend_layers(model, now);
+	}
+
+	// Nodes that were animated before, but aren't anymore, go back to rest.
+	for (int32_t i = 0; i < inst->node_count; i++) {
+		anim_transform_t *tr      = &inst->node_transforms[i];
+		bool              touched = tr->dirty;
+		if (!touched && tr->animated) {
+			tr->translation = inst->rest_transforms[i].translation;
+			tr->rotation    = inst->rest_transforms[i].rotation;
+			tr->scale       = inst->rest_transforms[i].scale;
+			tr->dirty       = true;
+		}
+		tr->animated = touched;
+	}
+	anim_update_transforms(model);
+}
+
+///////////////////////////////////////////
+
+void anim_update_model(model_t model) {
+	anim_inst_t *inst = &model->anim_inst;
+	if (inst->layers.count == 0) return;
+
+	// Remember this model, so next frame it can be updated alongside the
+	// others before the app gets to it.
+	if (inst->queued_update == false) {
+		inst->queued_update = true;
+		anim_update_list.add(model);
+	}
+	_anim_update_model(model);
 }
 
 ///////////////////////////////////////////
 
 void anim_update_skin(model_t model) {
+	if (model->anim_inst.queued_skin) return;
+	model->anim_inst.queued_skin = true;
 	animation_list.add(model);
 }
 
@@ -182,16 +474,29 @@ void anim_update_skin(model_t model) {
 
 void _anim_inst_check_ready(model_t model) {
 	anim_inst_t *inst = &model->anim_inst;
-	anim_data_t *data = &model->anim_data;
+	anim_data_t *data = &model->proto->anim_data;
 
 	if (inst->node_transforms == nullptr) {
-		inst->node_transforms = sk_malloc_t(anim_transform_t, model->nodes.count);
-		for (int32_t i = 0; i < model->nodes.count; i++) {
+		inst->node_count      = model->nodes.count;
+		inst->node_transforms = sk_malloc_zero_t(anim_transform_t, inst->node_count);
+		inst->rest_transforms = sk_malloc_zero_t(anim_transform_t, inst->node_count);
+		inst->blend_clip      = sk_malloc_zero_t(anim_transform_t, inst->node_count);
+		inst->blend_layer     = sk_malloc_t     (anim_blend_t,     inst->node_count);
+		for (int32_t i = 0; i < inst->node_count; i++) {
 			matrix_decompose(model->nodes[i].transform_local,
-				inst->node_transforms[i].translation,
-				inst->node_transforms[i].scale,
-				inst->node_transforms[i].rotation);
+				inst->rest_transforms[i].translation,
+				inst->rest_transforms[i].scale,
+				inst->rest_transforms[i].rotation);
 		}
+		memcpy(inst->node_transforms, inst->rest_transforms, sizeof(anim_transform_t) * inst->node_count);
+		memcpy(inst->blend_clip,      inst->rest_transforms, sizeof(anim_transform_t) * inst->node_count);
+
+		int32_t max_curves = 0;
+		for (int32_t i = 0; i < data->anims.count; i++) {
+			if (max_curves < data->anims[i].curves.count)
+				max_curves = data->anims[i].curves.count;
+		}
+		inst->samples = sk_malloc_t(anim_sample_t, max_curves);
 	}
 	if (inst->skinned_meshes == nullptr) {
 		inst->skinned_mesh_count = data->skeletons.count;
@@ -207,72 +512,315 @@ void _anim_inst_check_ready(model_t model) {
 
 ///////////////////////////////////////////
 
-void _anim_update_skin(model_t &model) {
-	_anim_inst_check_ready(model);
-
+// Builds the bone palettes and deforms the skinned meshes on the CPU. Each
+// model owns its own modified meshes, so models can be done in parallel.
+void _anim_skin_deform(model_t model) {
 	for (int32_t i = 0; i < model->anim_inst.skinned_mesh_count; i++) {
-		model_node_id skin_node = model->anim_data.skeletons[i].skin_node;
-		if (model_node_get_visible(model, skin_node) == false) continue;
-			
+		anim_inst_subset_t *skin      = &model->anim_inst.skinned_meshes[i];
+		model_node_id       skin_node = model->proto->anim_data.skeletons[i].skin_node;
+		skin->deformed = model_node_get_visible(model, skin_node);
+		if (skin->deformed == false) continue;
+
 		matrix root = matrix_invert(model_node_get_transform_model(model, skin_node));
-		for (int32_t b = 0; b < model->anim_data.skeletons[i].bone_count; b++) {
-			model->anim_inst.skinned_meshes[i].bone_transforms[b] = model_node_get_transform_model(model, model->anim_data.skeletons[i].bone_to_node_map[b]) * root;
+		for (int32_t b = 0; b < model->proto->anim_data.skeletons[i].bone_count; b++) {
+			skin->bone_transforms[b] = model_node_get_transform_model(model, model->proto->anim_data.skeletons[i].bone_to_node_map[b]) * root;
 		}
-		mesh_update_skin(
-			model->anim_inst.skinned_meshes[i].modified_mesh,
-			model->anim_inst.skinned_meshes[i].bone_transforms,
-			model->anim_data.skeletons     [i].bone_count);
+		mesh_skin_deform(skin->modified_mesh, skin->bone_transforms, model->proto->anim_data.skeletons[i].bone_count);
 	}
 }
 
 ///////////////////////////////////////////
 
-void anim_inst_play(model_t model, int32_t anim_id, anim_mode_ mode) {
-	if (anim_id < 0 || anim_id >= model->anim_data.anims.count) {
+void _anim_skin_upload(model_t model) {
+	for (int32_t i = 0; i < model->anim_inst.skinned_mesh_count; i++) {
+		if (model->anim_inst.skinned_meshes[i].deformed)
+			mesh_skin_upload(model->anim_inst.skinned_meshes[i].modified_mesh);
+	}
+}
+
+///////////////////////////////////////////
+
+bool anim_check_id(model_t model, int32_t anim_id) {
+	if (anim_id < 0 || anim_id >= model->proto->anim_data.anims.count) {
 		log_err("Attempted to play an invalid animation id.");
-		return;
+		return false;
+	}
+	return true;
+}
+
+///////////////////////////////////////////
+
+anim_layer_t *anim_inst_get_layer(model_t model, int32_t layer) {
+	if (layer < 0) {
+		log_err("Attempted to use a negative animation layer.");
+		return nullptr;
+	}
+	anim_inst_t *inst = &model->anim_inst;
+	while (inst->layers.count <= layer) {
+		anim_layer_t new_layer = {};
+		new_layer.blend  = anim_blend_override;
+		new_layer.weight = 1;
+		inst->layers.add(new_layer);
+	}
+	return &inst->layers[layer];
+}
+
+///////////////////////////////////////////
+
+void anim_layer_clear(anim_layer_t *layer) {
+	for (int32_t i = 0; i < layer->clips.count; i++)
+		sk_free(layer->clips[i].curve_last_keyframe);
+	layer->clips.clear();
+}
+
+///////////////////////////////////////////
+
+void anim_inst_play(model_t model, int32_t anim_id, anim_mode_ mode) {
+	anim_inst_crossfade(model, 0, anim_id, mode, 0);
+}
+
+///////////////////////////////////////////
+
+void anim_inst_crossfade(model_t model, int32_t layer_idx, int32_t anim_id, anim_mode_ mode, float fade_seconds) {
+	if (!anim_check_id(model, anim_id)) return;
+	anim_layer_t *layer = anim_inst_get_layer(model, layer_idx);
+	if (layer == nullptr) return;
+
+	// Without a fade, this is a hard switch that restarts the animation
+	if (fade_seconds <= 0) {
+		anim_layer_clear(layer);
+	} else {
+		float now = time_totalf();
+		for (int32_t i = 0; i < layer->clips.count; i++) {
+			if (layer->clips[i].anim_id != anim_id)
+				anim_clip_fade(&layer->clips[i], 0, fade_seconds, now);
+		}
+	}
+	anim_inst_blend(model, layer_idx, anim_id, mode, 1, fade_seconds);
+}
+
+///////////////////////////////////////////
+
+void anim_inst_blend(model_t model, int32_t layer_idx, int32_t anim_id, anim_mode_ mode, float weight, float fade_seconds) {
+	if (!anim_check_id(model, anim_id)) return;
+	anim_layer_t *layer = anim_inst_get_layer(model, layer_idx);
+	if (layer == nullptr) return;
+	_anim_inst_check_ready(model);
+
+	float       now  = time_totalf();
+	anim_clip_t clip = {};
+	int32_t     idx  = -1;
+	for (int32_t i = 0; i < layer->clips.count; i++) {
+		if (layer->clips[i].anim_id == anim_id) { idx = i; break; }
+	}
+
+	if (idx >= 0) {
+		// Already playing, so keep its time, but switch modes without a jump
+		clip = layer->clips[idx];
+		layer->clips.remove(idx);
+		if (clip.mode != mode) {
+			float time = anim_clip_time(&model->proto->anim_data, &clip);
+			clip.mode       = mode;
+			clip.start_time = mode == anim_mode_manual ? time : now - time;
+		}
+	} else {
+		clip.anim_id             = anim_id;
+		clip.mode                = mode;
+		clip.start_time          = now;
+		clip.curve_last_keyframe = sk_malloc_zero_t(int32_t, model->proto->anim_data.anims[anim_id].curves.count);
+	}
+	anim_clip_fade(&clip, weight, fade_seconds, now);
+
+	// The most recently played clip goes last
+	layer->clips.add(clip);
+	model->anim_inst.dirty = true;
+}
+
+///////////////////////////////////////////
+
+void anim_inst_stop(model_t model, int32_t layer_idx, float fade_seconds) {
+	if (layer_idx < 0 || layer_idx >= model->anim_inst.layers.count) return;
+
+	anim_layer_t *layer = &model->anim_inst.layers[layer_idx];
+	float         now   = time_totalf();
+	for (int32_t i = 0; i < layer->clips.count; i++)
+		anim_clip_fade(&layer->clips[i], 0, fade_seconds, now);
+	model->anim_inst.dirty = true;
+}
+
+///////////////////////////////////////////
+
+void anim_inst_layer_set(model_t model, int32_t layer_idx, anim_blend_ blend, float weight) {
+	anim_layer_t *layer = anim_inst_get_layer(model, layer_idx);
+	if (layer == nullptr) return;
+
+	layer->blend  = blend;
+	layer->weight = weight;
+	model->anim_inst.dirty = true;
+}
+
+///////////////////////////////////////////
+
+void anim_mask_children(model_t model, float *mask, model_node_id node, float weight) {
+	model_node_id curr = model->nodes[node].child;
+	while (curr != -1) {
+		mask[curr] = weight;
+		anim_mask_children(model, mask, curr, weight);
+		curr = model->nodes[curr].sibling;
 	}
+}
+
+///////////////////////////////////////////
+
+void anim_inst_layer_mask(model_t model, int32_t layer_idx, model_node_id node, float weight, bool32_t include_children) {
+	anim_layer_t *layer = anim_inst_get_layer(model, layer_idx);
+	if (layer == nullptr) return;
 	_anim_inst_check_ready(model);
+	if (node < 0 || node >= model->anim_inst.node_count) {
+		log_err("Attempted to mask an invalid node on an animation layer.");
+		return;
+	}
 
-	int32_t count = model->anim_data.anims[anim_id].curves.count;
-	if (model->anim_inst.curve_last_keyframe == nullptr || model->anim_inst.curve_last_capacity < count) {
-		sk_free(model->anim_inst.curve_last_keyframe);
-		model->anim_inst.curve_last_capacity = count;
-		model->anim_inst.curve_last_keyframe = sk_malloc_t(int32_t, count);
+	if (layer->node_mask == nullptr) {
+		layer->node_mask = sk_malloc_t(float, model->anim_inst.node_count);
+		for (int32_t i = 0; i < model->anim_inst.node_count; i++)
+			layer->node_mask[i] = 1;
 	}
-	memset(model->anim_inst.curve_last_keyframe, 0, sizeof(int32_t) * count);
+	layer->node_mask[node] = weight;
+	if (include_children)
+		anim_mask_children(model, layer->node_mask, node, weight);
+	model->anim_inst.dirty = true;
+}
+
+///////////////////////////////////////////
 
-	model->anim_inst.start_time  = time_totalf();
-	model->anim_inst.last_update = -1;
-	model->anim_inst.anim_id     = anim_id;
-	model->anim_inst.mode        = mode;
+anim_clip_t *anim_inst_primary(anim_inst_t *inst) {
+	if (inst->layers.count == 0 || inst->layers[0].clips.count == 0)
+		return nullptr;
+	return &inst->layers[0].clips.last();
 }
 
 ///////////////////////////////////////////
 
 void anim_inst_destroy(anim_inst_t *inst) {
+	// Don't leave dangling models in the per-frame lists
+	if (inst->queued_update) {
+		for (int32_t i = anim_update_list.count - 1; i >= 0; i--)
+			if (&anim_update_list[i]->anim_inst == inst) anim_update_list.remove(i);
+	}
+	if (inst->queued_skin) {
+		for (int32_t i = animation_list.count - 1; i >= 0; i--)
+			if (&animation_list[i]->anim_inst == inst) animation_list.remove(i);
+	}
+
 	for (int32_t i = 0; i < inst->skinned_mesh_count; i++) {
 		sk_free(inst->skinned_meshes[i].bone_transforms);
 		mesh_release(inst->skinned_meshes[i].original_mesh);
 		mesh_release(inst->skinned_meshes[i].modified_mesh);
 	}
+	for (int32_t i = 0; i < inst->layers.count; i++) {
+		anim_layer_clear(&inst->layers[i]);
+		inst->layers[i].clips.free();
+		sk_free(inst->layers[i].node_mask);
+	}
+	inst->layers.free();
 	sk_free(inst->skinned_meshes);
-	sk_free(inst->curve_last_keyframe);
 	sk_free(inst->node_transforms);
+	sk_free(inst->rest_transforms);
+	sk_free(inst->blend_clip);
+	sk_free(inst->blend_layer);
+	sk_free(inst->samples);
 
 	*inst = {};
-	inst->anim_id = -1;
+}
+
+///////////////////////////////////////////
+
+int32_t anim_curve_value_count(const anim_curve_t *curve) {
+	int32_t components = 0;
+	switch (curve->applies_to) {
+	case anim_element_rotation:    components = 4; break;
+	case anim_element_scale:       components = 3; break;
+	case anim_element_translation: components = 3; break;
+	default: return 0;
+	}
+	// Cubic curves store an in-tangent, value, and out-tangent per keyframe
+	return curve->interpolation == anim_interpolation_cubic
+		? components * curve->keyframe_count * 3
+		: components * curve->keyframe_count;
+}
+
+///////////////////////////////////////////
+
+void anim_finalize(anim_t *anim) {
+	if (anim->keyframe_data != nullptr) return;
+
+	// Morph target weights aren't supported yet, and their value count can't
+	// be known from the curve alone, so they're dropped here.
+	size_t total = 0;
+	for (int32_t i = 0; i < anim->curves.count; i++) {
+		const anim_curve_t *curve = &anim->curves[i];
+		if (curve->applies_to == anim_element_weights || curve->keyframe_count <= 0) continue;
+		total += curve->keyframe_count + anim_curve_value_count(curve);
+	}
+
+	// Bucket the curves by element, then by interpolation, so each bucket
+	// becomes a run, and its keyframe data sits together in memory.
+	float                *block  = sk_malloc_tag_t(memory_tag_animation, float, total > 0 ? total : 1);
+	size_t                at     = 0;
+	array_t<anim_curve_t> sorted = {};
+	sorted.resize(anim->curves.count > 0 ? anim->curves.count : 1);
+	anim->runs.clear();
+	for (int32_t e = anim_element_translation; e <= anim_element_scale; e++) {
+		for (int32_t interp = anim_interpolation_linear; interp <= anim_interpolation_cubic; interp++) {
+			anim_run_t run = {};
+			run.applies_to    = (anim_element_)e;
+			run.interpolation = (anim_interpolation_)interp;
+			run.curve_start   = sorted.count;
+
+			for (int32_t i = 0; i < anim->curves.count; i++) {
+				anim_curve_t curve = anim->curves[i];
+				if (curve.applies_to != e || curve.interpolation != interp || curve.keyframe_count <= 0) continue;
+
+				int32_t value_count = anim_curve_value_count(&curve);
+				memcpy(block + at, curve.keyframe_times, sizeof(float) * curve.keyframe_count);
+				curve.keyframe_times = block + at;
+				at += curve.keyframe_count;
+				memcpy(block + at, curve.keyframe_values, sizeof(float) * value_count);
+				curve.keyframe_values = block + at;
+				at += value_count;
+
+				sorted.add(curve);
+				run.curve_count += 1;
+			}
+			if (run.curve_count > 0)
+				anim->runs.add(run);
+		}
+	}
+
+	for (int32_t i = 0; i < anim->curves.count; i++) {
+		sk_free(anim->curves[i].keyframe_times);
+		sk_free(anim->curves[i].keyframe_values);
+	}
+	anim->curves.free();
+	anim->curves        = sorted;
+	anim->keyframe_data = block;
 }
 
 ///////////////////////////////////////////
 
 void anim_data_destroy(anim_data_t *data) {
 	for (int32_t i = 0; i < data->anims.count; i++) {
-		for (int32_t c = 0; c < data->anims[i].curves.count; c++) {
-			sk_free(data->anims[i].curves[c].keyframe_values);
-			sk_free(data->anims[i].curves[c].keyframe_times);
+		if (data->anims[i].keyframe_data != nullptr) {
+			sk_free_tag(data->anims[i].keyframe_data);
+		} else {
+			for (int32_t c = 0; c < data->anims[i].curves.count; c++) {
+				sk_free(data->anims[i].curves[c].keyframe_values);
+				sk_free(data->anims[i].curves[c].keyframe_times);
+			}
 		}
 		data->anims[i].curves.free();
+		data->anims[i].runs  .free();
 		sk_free(data->anims[i].name);
 	}
 	for (int32_t i = 0; i < data->skeletons.count; i++) {
@@ -306,18 +854,15 @@ anim_data_t anim_data_copy(anim_data_t *data) {
 				curve.keyframe_times = sk_malloc_t(float, curve.keyframe_count);
 				memcpy(curve.keyframe_times, curve_src.keyframe_times, sizeof(float) * curve.keyframe_count);
 
-				size_t value_size = 0;
-				switch (curve.applies_to) {
-				case anim_element_rotation:    value_size = sizeof(quat) * curve.keyframe_count; break;
-				case anim_element_scale:       value_size = sizeof(vec3) * curve.keyframe_count; break;
-				case anim_element_translation: value_size = sizeof(vec3) * curve.keyframe_count; break;
-				default: log_errf("anim_data_copy doesn't implement anim_element_weights yet!");
-				}
+				size_t value_size = sizeof(float) * anim_curve_value_count(&curve);
+				if (curve.applies_to == anim_element_weights)
+					log_errf("anim_data_copy doesn't implement anim_element_weights yet!");
 				curve.keyframe_values = sk_malloc(value_size);
 				memcpy(curve.keyframe_values, curve_src.keyframe_values, value_size);
 
 				anim.curves.add(curve);
 			}
+			anim_finalize(&anim);
 			result.anims.add(anim);
 		}
 	}
@@ -341,15 +886,43 @@ anim_data_t anim_data_copy(anim_data_t *data) {
 
 ///////////////////////////////////////////
 
+void anim_step_begin() {
+	// Models drawn last frame are likely to be drawn again, so bring them up
+	// to date now across all cores. When the app draws them, they'll already
+	// be updated for this frame, and skip the work.
+	jobs_parallel_for(anim_update_list.count, [](int32_t i, void *) {
+		_anim_update_model(anim_update_list[i]);
+	}, nullptr);
+
+	for (int32_t i = 0; i < anim_update_list.count; i++)
+		anim_update_list[i]->anim_inst.queued_update = false;
+	anim_update_list.clear();
+}
+
+///////////////////////////////////////////
+
 void anim_step() {
-	animation_list.each(_anim_update_skin);
+	// Creating the skinned meshes touches the GPU, so make sure that's done
+	// before heading out to other threads.
+	for (int32_t i = 0; i < animation_list.count; i++)
+		_anim_inst_check_ready(animation_list[i]);
+
+	jobs_parallel_for(animation_list.count, [](int32_t i, void *) {
+		_anim_skin_deform(animation_list[i]);
+	}, nullptr);
+
+	for (int32_t i = 0; i < animation_list.count; i++) {
+		_anim_skin_upload(animation_list[i]);
+		animation_list[i]->anim_inst.queued_skin = false;
+	}
 	animation_list.clear();
 }
 
 ///////////////////////////////////////////
 
 void anim_shutdown() {
-	animation_list.free();
+	animation_list  .free();
+	anim_update_list.free();
 }
 
 } // namespace sk
@@ -34,10 +34,24 @@ struct anim_skeleton_t {
 	int32_t      *bone_to_node_map;
 };
 
+// A run of curves that share the same element and interpolation. Curves are
+// sorted into runs when an anim_t is finalized, so sampling can process a
+// whole run in one tight loop instead of switching on every curve.
+struct anim_run_t {
+	anim_element_       applies_to;
+	anim_interpolation_ interpolation;
+	int32_t             curve_start;
+	int32_t             curve_count;
+};
+
 struct anim_t {
 	char                 *name;
 	float                 duration;
 	array_t<anim_curve_t> curves;
+	array_t<anim_run_t>   runs;
+	// Once finalized, all keyframe times and values for this animation live
+	// in this one block, and the curve pointers point into it.
+	float                *keyframe_data;
 };
 
 struct anim_data_t {
@@ -50,34 +64,92 @@ struct anim_transform_t {
 	vec3 scale;
 	quat rotation;
 	bool dirty;
+	bool animated;
+	bool moved;
+	bool posed;
+};
+
+// Accumulates the weighted clips of a single layer, each channel tracks its
+// own weight since clips don't always touch every channel of a node.
+struct anim_blend_t {
+	vec3  translation;
+	vec3  scale;
+	vec4  rotation;
+	float weight_translation;
+	float weight_scale;
+	float weight_rotation;
+};
+
+// Per-curve results of the keyframe search, sampling happens in a separate
+// pass over these once every curve knows where it is.
+struct anim_sample_t {
+	int32_t frame;
+	int32_t next;
+	float   pct;
+	float   duration;
 };
 
 struct anim_inst_subset_t {
-	mesh_t  original_mesh;
-	mesh_t  modified_mesh;
-	matrix *bone_transforms;
+	mesh_t   original_mesh;
+	mesh_t   modified_mesh;
+	matrix  *bone_transforms;
+	bool32_t deformed;
+};
+
+struct anim_clip_t {
+	int32_t    anim_id;
+	anim_mode_ mode;
+	float      start_time;
+	float      weight_from;
+	float      weight_to;
+	float      fade_start;
+	float      fade_duration;
+	int32_t   *curve_last_keyframe;
+};
+
+struct anim_layer_t {
+	// The most recently played clip is always last in this list
+	array_t<anim_clip_t> clips;
+	anim_blend_          blend;
+	float                weight;
+	// Per-node weights for this layer, nullptr means every node is at 1
+	float               *node_mask;
 };
 
 struct anim_inst_t {
-	int32_t             anim_id;
-	int32_t             skinned_mesh_count;
-	int32_t             node_count;
-	float               start_time;
-	float               last_update;
-	anim_mode_          mode;
-	int32_t            *curve_last_keyframe;
-	int32_t             curve_last_capacity;
-	anim_inst_subset_t *skinned_meshes;
-	anim_transform_t   *node_transforms;
+	array_t<anim_layer_t> layers;
+	int32_t               skinned_mesh_count;
+	int32_t               node_count;
+	float                 last_update;
+	bool32_t              dirty;
+	bool32_t              animating;
+	bool32_t              queued_update;
+	bool32_t              queued_skin;
+	bool32_t              pose_edited;
+	anim_inst_subset_t   *skinned_meshes;
+	anim_transform_t     *node_transforms;
+	anim_transform_t     *rest_transforms;
+	anim_transform_t     *blend_clip;
+	anim_blend_t         *blend_layer;
+	anim_sample_t        *samples;
 };
 
-void anim_update_model(model_t model);
-void anim_update_skin (model_t model);
-void anim_inst_play   (model_t model, int32_t anim_id, anim_mode_ mode);
-void anim_inst_destroy(anim_inst_t *inst);
-void anim_data_destroy(anim_data_t *data);
-anim_data_t anim_data_copy(anim_data_t *data);
+void         anim_update_model   (model_t model);
+void         anim_update_skin    (model_t model);
+void         anim_inst_play      (model_t model, int32_t anim_id, anim_mode_ mode);
+void         anim_inst_crossfade (model_t model, int32_t layer, int32_t anim_id, anim_mode_ mode, float fade_seconds);
+void         anim_inst_blend     (model_t model, int32_t layer, int32_t anim_id, anim_mode_ mode, float weight, float fade_seconds);
+void         anim_inst_stop      (model_t model, int32_t layer, float fade_seconds);
+void         anim_inst_layer_set (model_t model, int32_t layer, anim_blend_ blend, float weight);
+void         anim_inst_layer_mask(model_t model, int32_t layer, model_node_id node, float weight, bool32_t include_children);
+anim_clip_t *anim_inst_primary   (anim_inst_t *inst);
+float        anim_clip_time      (const anim_data_t *data, const anim_clip_t *clip);
+void         anim_inst_destroy   (anim_inst_t *inst);
+void         anim_finalize       (anim_t *anim);
+void         anim_data_destroy   (anim_data_t *data);
+anim_data_t  anim_data_copy      (anim_data_t *data);
 
+void anim_step_begin();
 void anim_step();
 void anim_shutdown();
 
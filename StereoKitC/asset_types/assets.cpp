@@ -19,6 +19,8 @@
 #include "anchor.h"
 #include "../platforms/platform.h"
 #include "../systems/physics.h"
+#include "../systems/profiler.h"
+#include "../spherical_harmonics.h"
 #include "../libraries/stref.h"
 #include "../libraries/ferr_hash.h"
 #include "../libraries/array.h"
@@ -55,7 +57,6 @@ struct asset_thread_t {
 array_t<asset_header_t *>      assets = {};
 array_t<asset_header_t *>      assets_multithread_destroy = {};
 ft_mutex_t                     assets_multithread_destroy_lock = {};
-ft_mutex_t                     assets_job_lock = {};
 array_t<asset_job_t *>         assets_gpu_jobs = {};
 ft_mutex_t                     assets_load_event_lock = {};
 array_t<asset_load_callback_t> assets_load_callbacks = {};
@@ -63,6 +64,16 @@ array_t<asset_header_t *>      assets_load_events = {};
 
 ///////////////////////////////////////////
 
+// GPU jobs can be queued and run while systems are still initializing, from
+// whichever threads are running their init, so this can't wait for
+// assets_init. It lives for the whole process.
+static ft_mutex_t assets_job_mtx() {
+	static ft_mutex_t mtx = ft_mutex_create();
+	return mtx;
+}
+
+///////////////////////////////////////////
+
 array_t<asset_thread_t>asset_threads         = {};
 bool32_t               asset_thread_enabled  = false;
 array_t<asset_task_t*> asset_thread_tasks    = {};
@@ -122,6 +133,7 @@ void *assets_allocate(asset_type_ type) {
 	case asset_type_solid:       size = sizeof(_solid_t);       break;
 	case asset_type_anchor:      size = sizeof(_anchor_t);      break;
 	case asset_type_render_list: size = sizeof(_render_list_t); break;
+	case asset_type_render_view: size = sizeof(_render_view_t); break;
 	default: log_err("Unimplemented asset type!"); abort();
 	}
 
@@ -232,6 +244,7 @@ void assets_destroy(asset_header_t *asset) {
 	case asset_type_solid:       solid_destroy      ((solid_t      )asset); break;
 	case asset_type_anchor:      anchor_destroy     ((anchor_t     )asset); break;
 	case asset_type_render_list: render_list_destroy((render_list_t)asset); break;
+	case asset_type_render_view: render_view_destroy((render_view_t)asset); break;
 	default: log_err("Unimplemented asset type!"); abort();
 	}
 
@@ -348,12 +361,12 @@ char *assets_file(const char *file_name) {
 
 bool assets_init() {
 	assets_multithread_destroy_lock = ft_mutex_create();
-	assets_job_lock                 = ft_mutex_create();
 	asset_thread_task_mtx           = ft_mutex_create();
 	assets_load_event_lock          = ft_mutex_create();
 	asset_tasks_available           = ft_condition_create();
 
 	texture_compression_init();
+	sh_init();
 
 #if !defined(__EMSCRIPTEN__)
 	asset_threads.resize(3);
@@ -388,13 +401,7 @@ void assets_step() {
 	ft_mutex_unlock(assets_multithread_destroy_lock);
 
 	// Do any jobs the assets need on the main thread, like GPU buffer uploads
-	ft_mutex_lock(assets_job_lock);
-	for (int32_t i = 0; i < assets_gpu_jobs.count; i++) {
-		assets_gpu_jobs[i]->success  = assets_gpu_jobs[i]->asset_job(assets_gpu_jobs[i]->data);
-		assets_gpu_jobs[i]->finished = true;
-	}
-	assets_gpu_jobs.clear();
-	ft_mutex_unlock(assets_job_lock);
+	assets_execute_gpu_jobs();
 
 	// Update any on_load event callbacks
 	ft_mutex_lock(assets_load_event_lock);
@@ -438,6 +445,9 @@ void assets_shutdown() {
 	assets_shutdown_check();
 #endif
 
+	sh_shutdown();
+	mesh_shutdown();
+
 	ft_mutex_destroy(&asset_thread_task_mtx);
 	asset_thread_tasks.free();
 	asset_active_tasks.free();
@@ -445,7 +455,6 @@ void assets_shutdown() {
 	assets_multithread_destroy.free();
 	assets_gpu_jobs           .free();
 	ft_mutex_destroy(&assets_multithread_destroy_lock);
-	ft_mutex_destroy(&assets_job_lock);
 	ft_mutex_destroy(&assets_load_event_lock);
 	ft_condition_destroy(&asset_tasks_available);
 
@@ -461,6 +470,18 @@ void assets_shutdown() {
 
 ///////////////////////////////////////////
 
+void assets_execute_gpu_jobs() {
+	ft_mutex_lock(assets_job_mtx());
+	for (int32_t i = 0; i < assets_gpu_jobs.count; i++) {
+		assets_gpu_jobs[i]->success  = assets_gpu_jobs[i]->asset_job(assets_gpu_jobs[i]->data);
+		assets_gpu_jobs[i]->finished = true;
+	}
+	assets_gpu_jobs.clear();
+	ft_mutex_unlock(assets_job_mtx());
+}
+
+///////////////////////////////////////////
+
 bool32_t assets_execute_gpu(bool32_t(*asset_job)(void *data), void *data) {
 	if (ft_id_matches(sk_main_thread())) {
 		return asset_job(data);
@@ -470,9 +491,9 @@ bool32_t assets_execute_gpu(bool32_t(*asset_job)(void *data), void *data) {
 		job->asset_job = asset_job;
 		job->data      = data;
 
-		ft_mutex_lock(assets_job_lock);
+		ft_mutex_lock(assets_job_mtx());
 		assets_gpu_jobs.add(job);
-		ft_mutex_unlock(assets_job_lock);
+		ft_mutex_unlock(assets_job_mtx());
 
 		// Block until the GPU thread has had a chance to take care of the job.
 		uint64_t start      = stm_now();
@@ -690,7 +711,9 @@ void asset_step_task() {
 	asset_load_action_t* action = &task->actions[task->action_curr];
 	if (action->thread_affinity == asset_thread_asset) {
 		// Execute the asset loading action!
+		profiler_zone_begin("Asset Load");
 		bool result = action->action(task, task->asset, task->load_data);
+		profiler_zone_end();
 
 		if (result == false) {
 			// On failure, send an error message, and move to the end
@@ -711,15 +734,16 @@ void asset_step_task() {
 			task->gpu_job.asset_job = [](void* data) {
 				asset_task_t* task = (asset_task_t*)data;
 				asset_load_action_t* action = &task->actions[task->action_curr];
+				profiler_scope("Asset GPU Load");
 				bool result = action->action(task, task->asset, task->load_data);
 
 				return (bool32_t)result;
 			};
 
 			// Add the job to the list
-			ft_mutex_lock(assets_job_lock);
+			ft_mutex_lock(assets_job_mtx());
 			assets_gpu_jobs.add(&task->gpu_job);
-			ft_mutex_unlock(assets_job_lock);
+			ft_mutex_unlock(assets_job_mtx());
 		} else if (task->gpu_job.finished) {
 			if (task->gpu_job.success == false) {
 				// On failure, send an error message, and move to
@@ -751,6 +775,7 @@ int32_t asset_thread(void *thread_inst_obj) {
 	asset_thread_t* thread = (asset_thread_t*)thread_inst_obj;
 	thread->id      = ft_id_current();
 	thread->running = true;
+	profiler_thread_name("Assets");
 
 	ft_mutex_t wait_mtx = ft_mutex_create();
 
@@ -20,6 +20,7 @@ typedef struct font_source_t {
 	int32_t        references;
 	stbtt_fontinfo info;
 	void          *file;
+	size_t         file_size;
 	float          scale;
 	float          char_height;
 } font_source_t;
@@ -61,6 +62,8 @@ int32_t font_source_add(const char *filename) {
 		if (!platform_read_file(filename, (void **)&font_sources[id].file, &length)) {
 			log_warnf("Font file failed to load: %s", filename);
 		} else {
+			font_sources[id].file_size = length;
+			sk_mem_tag_track(memory_tag_font, (int64_t)length);
 			stbtt_InitFont(&font_sources[id].info, (const unsigned char *)font_sources[id].file, stbtt_GetFontOffsetForIndex((const unsigned char *)font_sources[id].file,0));
 			font_sources[id].scale = stbtt_ScaleForPixelHeight(&font_sources[id].info, (float)font_resolution);
 			int32_t x0, y0, x1, y1;
@@ -89,8 +92,10 @@ int32_t font_source_add_data(const char *name, const void *data, size_t data_siz
 	font_sources[id].references += 1;
 
 	if (font_sources[id].references == 1) {
-		font_sources[id].file = sk_malloc(data_size);
+		font_sources[id].file      = sk_malloc(data_size);
+		font_sources[id].file_size = data_size;
 		memcpy(font_sources[id].file, data, data_size);
+		sk_mem_tag_track(memory_tag_font, (int64_t)data_size);
 
 		stbtt_InitFont(&font_sources[id].info, (const unsigned char *)font_sources[id].file, stbtt_GetFontOffsetForIndex((const unsigned char *)font_sources[id].file,0));
 		font_sources[id].scale = stbtt_ScaleForPixelHeight(&font_sources[id].info, (float)font_resolution);
@@ -111,10 +116,13 @@ void font_source_release(int32_t id) {
 
 	font_sources[id].references -= 1;
 	if (font_sources[id].references == 0) {
+		if (font_sources[id].file != nullptr)
+			sk_mem_tag_track(memory_tag_font, -(int64_t)font_sources[id].file_size);
 		sk_free(font_sources[id].file);
 		sk_free(font_sources[id].name);
-		font_sources[id].file = nullptr;
-		font_sources[id].info = {};
+		font_sources[id].file      = nullptr;
+		font_sources[id].file_size = 0;
+		font_sources[id].info      = {};
 	}
 }
 
@@ -146,7 +154,7 @@ bool font_setup(font_t font) {
 	const int32_t atlas_resolution_x = 256;
 	const int32_t atlas_resolution_y = 256;
 	font->atlas      = rect_atlas_create( atlas_resolution_x, atlas_resolution_y );
-	font->atlas_data = sk_malloc_t(uint8_t, font->atlas.w * font->atlas.h);
+	font->atlas_data = sk_malloc_tag_t(memory_tag_font, uint8_t, font->atlas.w * font->atlas.h);
 	memset(font->atlas_data, 0, font->atlas.w * font->atlas.h);
 
 	for (char32_t i = 65; i < 128; i++) font_add_character(font, i);
@@ -270,7 +278,7 @@ void font_destroy(font_t font) {
 
 	tex_release       ( font->font_tex);
 	rect_atlas_destroy(&font->atlas);
-	sk_free           ( font->atlas_data);
+	sk_free_tag       ( font->atlas_data);
 	font->character_map.free();
 	font->glyph_map    .free();
 	font->update_queue .free();
@@ -422,10 +430,10 @@ void font_upsize_texture(font_t font) {
 
 	// Move all our glyphs over to a new chunk of memory that uses the larger
 	// size. We'll copy glyph by glyph to make sorting easier later on.
-	uint8_t *new_data = sk_malloc_t(uint8_t, new_w*new_h);
+	uint8_t *new_data = sk_malloc_tag_t(memory_tag_font, uint8_t, new_w*new_h);
 	memset(new_data, 0, new_w * new_h);
 	for (int32_t i = 0; i < font->glyph_map.capacity; i++) {
-		if (font->glyph_map.items[i].hash == 0) continue;
+		if (!font->glyph_map.has(i)) continue;
 		
 		font_char_t ch     = font->glyph_map.items[i].value;
 		font_char_t new_ch = ch;
@@ -443,8 +451,11 @@ void font_upsize_texture(font_t font) {
 		}
 	}
 	// Update the rest of our rectangles
-	for (int32_t i = 32; i < 128;                          i++) font_char_reuv(&font->characters         [i],       scale_x, scale_y);
-	for (int32_t i = 0;  i < font->character_map.capacity; i++) font_char_reuv(&font->character_map.items[i].value, scale_x, scale_y);
+	for (int32_t i = 32; i < 128;                          i++) font_char_reuv(&font->characters[i], scale_x, scale_y);
+	for (int32_t i = 0;  i < font->character_map.capacity; i++) {
+		if (font->character_map.has(i))
+			font_char_reuv(&font->character_map.items[i].value, scale_x, scale_y);
+	}
 	
 	// This could be a faster copy, but may not make a big difference. Also
 	// doesn't allow for copying to new locations.
@@ -454,7 +465,7 @@ void font_upsize_texture(font_t font) {
 	}*/
 
 	// Update the atlas to the new values
-	sk_free(font->atlas_data);
+	sk_free_tag(font->atlas_data);
 	font->atlas_data = new_data;
 	font->atlas.w = new_w;
 	font->atlas.h = new_h;
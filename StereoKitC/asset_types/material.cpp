@@ -4,6 +4,7 @@
 #include "../libraries/stref.h"
 #include "../libraries/ferr_hash.h"
 #include "../libraries/array.h"
+#include "../libraries/ferr_thread.h"
 #include "../sk_memory.h"
 #include "../systems/defaults.h"
 
@@ -14,10 +15,21 @@ namespace sk {
 
 _material_buffer_t material_buffers[14] = {};
 
+hashmap_t<material_pipeline_key_t, material_pipeline_t *> material_pipelines = {};
+
 ///////////////////////////////////////////
 
-void material_copy_pipeline(material_t dest, const material_t src);
-void material_update_label (material_t material);
+void material_update_label   (material_t material);
+void material_update_pipeline(material_t material);
+
+///////////////////////////////////////////
+
+// Parameter values need to go up to the GPU, and anything caching what this
+// material looks like needs to know it changed.
+inline void material_mark_dirty(material_t material) {
+	material->args.buffer_dirty = true;
+	material->data_version++;
+}
 
 ///////////////////////////////////////////
 
@@ -47,10 +59,8 @@ const char* material_get_id(const material_t material) {
 
 void material_update_label(material_t material) {
 #if !defined(SKG_OPENGL) && (defined(_DEBUG) || defined(SK_GPU_LABELS))
-	if (material->header.id_text != nullptr) {
-		skg_pipeline_name(&material->pipeline, material->header.id_text);
-		skg_buffer_name  (&material->args.buffer_gpu, material->header.id_text);
-	}
+	if (material->header.id_text != nullptr)
+		skg_buffer_name(&material->args.buffer_gpu, material->header.id_text);
 #else
 	(void)material;
 #endif
@@ -58,6 +68,80 @@ void material_update_label(material_t material) {
 
 ///////////////////////////////////////////
 
+ft_mutex_t material_pipeline_mutex() {
+	static ft_mutex_t mtx = ft_mutex_create();
+	return mtx;
+}
+
+///////////////////////////////////////////
+
+material_pipeline_t *material_pipeline_acquire(material_t material) {
+	material_pipeline_key_t key = {};
+	key.shader_generation = material->shader->generation;
+	key.transparency      = material->alpha_mode;
+	key.cull              = material->cull;
+	key.depth_test        = material->depth_test;
+	key.wireframe         = material->wireframe;
+	key.depth_write       = material->depth_write;
+
+	ft_mutex_t mtx = material_pipeline_mutex();
+	ft_mutex_lock(mtx);
+	material_pipeline_t **existing = material_pipelines.get(key);
+	material_pipeline_t  *result   = existing != nullptr ? *existing : nullptr;
+	if (result == nullptr) {
+		result = sk_malloc_t(material_pipeline_t, 1);
+		*result = {};
+		result->key      = key;
+		result->pipeline = skg_pipeline_create(&material->shader->shader);
+		skg_pipeline_set_transparency(&result->pipeline, (skg_transparency_)material->alpha_mode);
+		skg_pipeline_set_cull        (&result->pipeline, (skg_cull_        )material->cull);
+		skg_pipeline_set_depth_test  (&result->pipeline, (skg_depth_test_  )material->depth_test);
+		skg_pipeline_set_wireframe   (&result->pipeline, material->wireframe);
+		skg_pipeline_set_depth_write (&result->pipeline, material->depth_write);
+#if !defined(SKG_OPENGL) && (defined(_DEBUG) || defined(SK_GPU_LABELS))
+		// Pipelines are shared between materials, so the shader's name is
+		// the most useful one we have.
+		if (material->shader->header.id_text != nullptr)
+			skg_pipeline_name(&result->pipeline, material->shader->header.id_text);
+#endif
+		material_pipelines.set(key, result);
+	}
+	result->refs += 1;
+	ft_mutex_unlock(mtx);
+	return result;
+}
+
+///////////////////////////////////////////
+
+void material_pipeline_release(material_pipeline_t *pipeline) {
+	if (pipeline == nullptr) return;
+
+	ft_mutex_t mtx = material_pipeline_mutex();
+	ft_mutex_lock(mtx);
+	pipeline->refs -= 1;
+	if (pipeline->refs <= 0) {
+		material_pipelines.remove(pipeline->key);
+		if (material_pipelines.count == 0)
+			material_pipelines.free();
+		skg_pipeline_destroy(&pipeline->pipeline);
+		sk_free(pipeline);
+	}
+	ft_mutex_unlock(mtx);
+}
+
+///////////////////////////////////////////
+
+void material_update_pipeline(material_t material) {
+	// Acquire before releasing, so a pipeline only used by this material
+	// doesn't get destroyed and re-created when nothing actually changed.
+	material_pipeline_t *old_pipeline = material->pipeline;
+	material->pipeline = material_pipeline_acquire(material);
+	material_pipeline_release(old_pipeline);
+	material->data_version++;
+}
+
+///////////////////////////////////////////
+
 inline size_t material_param_size(material_param_ type) {
 	switch (type) {
 	case material_param_float:    return sizeof(float);
@@ -67,6 +151,14 @@ inline size_t material_param_size(material_param_ type) {
 	case material_param_vector2:  return sizeof(vec2);
 	case material_param_matrix:   return sizeof(matrix);
 	case material_param_texture:  return sizeof(tex_t);
+	case material_param_int:      return sizeof(int32_t);
+	case material_param_int2:     return sizeof(int32_t)  * 2;
+	case material_param_int3:     return sizeof(int32_t)  * 3;
+	case material_param_int4:     return sizeof(int32_t)  * 4;
+	case material_param_uint:     return sizeof(uint32_t);
+	case material_param_uint2:    return sizeof(uint32_t) * 2;
+	case material_param_uint3:    return sizeof(uint32_t) * 3;
+	case material_param_uint4:    return sizeof(uint32_t) * 4;
 	default: log_err("Bad material param type"); return 0;
 	}
 }
@@ -136,9 +228,9 @@ material_t material_create(shader_t shader) {
 	result->shader     = material_shader;
 	result->depth_test = depth_test_less;
 	result->depth_write= true;
-	result->pipeline   = skg_pipeline_create(&result->shader->shader);
+	result->cull       = cull_back;
+	result->pipeline   = material_pipeline_acquire(result);
 
-	material_set_cull(result, cull_back);
 	material_create_arg_defaults(result, material_shader);
 
 	if (shader == nullptr) {
@@ -165,6 +257,7 @@ material_t material_copy(material_t material) {
 	skg_buffer_t      tmp_buffer_gpu    = result->args.buffer_gpu;
 	shaderargs_tex_t *tmp_textures      = result->args.textures;
 	asset_header_t    tmp_header        = result->header;
+	material_pipeline_t *tmp_pipeline   = result->pipeline;
 
 	// Copy everything over from the old one, and then re-write with our own custom memory. Then copy that over too!
 	memcpy(result, material, sizeof(_material_t));
@@ -183,25 +276,19 @@ material_t material_copy(material_t material) {
 	}
 	if (result->chain != nullptr) material_addref(result->chain);
 
-	// Copy over the material's pipeline
-	result->pipeline = skg_pipeline_create(&material->shader->shader);
-	material_copy_pipeline(result, material);
+	// The copy has identical state, so it can share the same pipeline. The
+	// memcpy overwrote the one material_create gave us.
+	ft_mutex_t mtx = material_pipeline_mutex();
+	ft_mutex_lock(mtx);
+	result->pipeline->refs += 1;
+	ft_mutex_unlock(mtx);
+	material_pipeline_release(tmp_pipeline);
 
 	return result;
 }
 
 ///////////////////////////////////////////
 
-void material_copy_pipeline(material_t dest, const material_t src) {
-	material_set_cull        (dest, src->cull);
-	material_set_depth_test  (dest, src->depth_test);
-	material_set_depth_write (dest, src->depth_write);
-	material_set_transparency(dest, src->alpha_mode);
-	material_set_wireframe   (dest, src->wireframe);
-}
-
-///////////////////////////////////////////
-
 material_t material_copy_id(const char *id) {
 	material_t src    = material_find(id);
 	material_t result = material_copy(src);
@@ -231,8 +318,8 @@ void material_destroy(material_t material) {
 		if (material->args.textures[i].tex != nullptr)
 			tex_release(material->args.textures[i].tex);
 	}
+	material_pipeline_release(material->pipeline);
 	shader_release(material->shader);
-	skg_pipeline_destroy(&material->pipeline);
 	sk_free(material->args.buffer);
 	sk_free(material->args.textures);
 	*material = {};
@@ -276,16 +363,16 @@ void material_set_shader(material_t material, shader_t shader) {
 		}
 
 		// And release the old shader content
+		material_pipeline_release(material->pipeline);
+		material->pipeline = nullptr;
 		if (old_shader != nullptr)
 			shader_release(old_shader);
-		skg_pipeline_destroy(&material->pipeline);
 		sk_free(old_buffer);
 		sk_free(old_textures);
 	}
 
-	material->shader   = shader;
-	material->pipeline = skg_pipeline_create(&material->shader->shader);
-	material_copy_pipeline(material, material);
+	material->shader = shader;
+	material_update_pipeline(material);
 }
 
 ///////////////////////////////////////////
@@ -298,47 +385,48 @@ shader_t material_get_shader(material_t material) {
 ///////////////////////////////////////////
 
 void material_set_transparency(material_t material, transparency_ mode) {
+	if (material->alpha_mode == mode) return;
 	material->alpha_mode = mode;
-	skg_pipeline_set_transparency(&material->pipeline, (skg_transparency_)mode);
-	material_update_label(material);
+	material_update_pipeline(material);
 }
 
 ///////////////////////////////////////////
 
 void material_set_cull(material_t material, cull_ mode) {
+	if (material->cull == mode) return;
 	material->cull = mode;
-	skg_pipeline_set_cull(&material->pipeline, (skg_cull_)mode);
-	material_update_label(material);
+	material_update_pipeline(material);
 }
 
 ///////////////////////////////////////////
 
 void material_set_wireframe(material_t material, bool32_t wireframe) {
+	if (material->wireframe == wireframe) return;
 	material->wireframe = wireframe;
-	skg_pipeline_set_wireframe(&material->pipeline, wireframe);
-	material_update_label(material);
+	material_update_pipeline(material);
 }
 
 ///////////////////////////////////////////
 
 void material_set_depth_test(material_t material, depth_test_ depth_test_mode) {
+	if (material->depth_test == depth_test_mode) return;
 	material->depth_test = depth_test_mode;
-	skg_pipeline_set_depth_test(&material->pipeline, (skg_depth_test_)depth_test_mode);
-	material_update_label(material);
+	material_update_pipeline(material);
 }
 
 ///////////////////////////////////////////
 
 void material_set_depth_write(material_t material, bool32_t write_enabled) {
+	if (material->depth_write == write_enabled) return;
 	material->depth_write = write_enabled;
-	skg_pipeline_set_depth_write(&material->pipeline, write_enabled);
-	material_update_label(material);
+	material_update_pipeline(material);
 }
 
 ///////////////////////////////////////////
 
 void material_set_queue_offset(material_t material, int32_t offset) {
 	material->queue_offset = offset;
+	material->data_version++;
 }
 
 ///////////////////////////////////////////
@@ -352,6 +440,7 @@ void material_set_chain(material_t material, material_t chain_material) {
 	if (chain_material ) material_addref (chain_material);
 	if (material->chain) material_release(material->chain);
 	material->chain = chain_material;
+	material->data_version++;
 }
 
 ///////////////////////////////////////////
@@ -417,7 +506,7 @@ void material_set_float(material_t material, const char *name, float value) {
 	float *matparam = (float*)_material_get_ptr(material, name, sizeof(float));
 	if (matparam != nullptr) {
 		*matparam = value;
-		material->args.buffer_dirty = true;
+		material_mark_dirty(material);
 	}
 }
 
@@ -427,7 +516,7 @@ void material_set_color32(material_t material, const char *name, color32 value)
 	color128 *matparam = (color128*)_material_get_ptr(material, name, sizeof(color128));
 	if (matparam != nullptr) {
 		*matparam = color_to_linear(color32_to_128(value));
-		material->args.buffer_dirty = true;
+		material_mark_dirty(material);
 	}
 }
 
@@ -437,7 +526,7 @@ void material_set_color(material_t material, const char *name, color128 value) {
 	color128 *matparam = (color128*)_material_get_ptr(material, name, sizeof(color128));
 	if (matparam != nullptr) {
 		*matparam = color_to_linear(value);
-		material->args.buffer_dirty = true;
+		material_mark_dirty(material);
 	}
 }
 
@@ -453,7 +542,7 @@ void material_set_vector4(material_t material, const char *name, vec4 value) {
 	vec4 *matparam = (vec4*)_material_get_ptr(material, name, sizeof(vec4));
 	if (matparam != nullptr) {
 		*matparam = value;
-		material->args.buffer_dirty = true;
+		material_mark_dirty(material);
 	}
 }
 
@@ -463,7 +552,7 @@ void material_set_vector3(material_t material, const char *name, vec3 value) {
 	vec3 *matparam = (vec3*)_material_get_ptr(material, name, sizeof(vec3));
 	if (matparam != nullptr) {
 		*matparam = value;
-		material->args.buffer_dirty = true;
+		material_mark_dirty(material);
 	}
 }
 
@@ -473,7 +562,7 @@ void material_set_vector2(material_t material, const char *name, vec2 value) {
 	vec2 *matparam = (vec2*)_material_get_ptr(material, name, sizeof(vec2));
 	if (matparam != nullptr) {
 		*matparam = value;
-		material->args.buffer_dirty = true;
+		material_mark_dirty(material);
 	}
 }
 
@@ -483,7 +572,7 @@ void material_set_int(material_t material, const char *name, int32_t value) {
 	int32_t *matparam = (int32_t*)_material_get_ptr(material, name, sizeof(int32_t));
 	if (matparam != nullptr) {
 		*matparam = value;
-		material->args.buffer_dirty = true;
+		material_mark_dirty(material);
 	}
 }
 
@@ -494,7 +583,7 @@ void material_set_int2(material_t material, const char *name, int32_t  value1, i
 	if (matparam != nullptr) {
 		matparam[0] = value1;
 		matparam[1] = value2;
-		material->args.buffer_dirty = true;
+		material_mark_dirty(material);
 	}
 }
 
@@ -506,7 +595,7 @@ void material_set_int3(material_t material, const char *name, int32_t  value1, i
 		matparam[0] = value1;
 		matparam[1] = value2;
 		matparam[2] = value3;
-		material->args.buffer_dirty = true;
+		material_mark_dirty(material);
 	}
 }
 
@@ -519,7 +608,7 @@ void material_set_int4(material_t material, const char *name, int32_t  value1, i
 		matparam[1] = value2;
 		matparam[2] = value3;
 		matparam[3] = value4;
-		material->args.buffer_dirty = true;
+		material_mark_dirty(material);
 	}
 }
 
@@ -529,7 +618,7 @@ void material_set_bool(material_t material, const char *name, bool32_t value) {
 	uint32_t *matparam = (uint32_t*)_material_get_ptr(material, name, sizeof(uint32_t));
 	if (matparam != nullptr) {
 		*matparam = value>0?1:0;
-		material->args.buffer_dirty = true;
+		material_mark_dirty(material);
 	}
 }
 
@@ -539,7 +628,7 @@ void material_set_uint(material_t material, const char *name, uint32_t value) {
 	uint32_t *matparam = (uint32_t*)_material_get_ptr(material, name, sizeof(uint32_t));
 	if (matparam != nullptr) {
 		*matparam = value;
-		material->args.buffer_dirty = true;
+		material_mark_dirty(material);
 	}
 }
 
@@ -550,7 +639,7 @@ void material_set_uint2(material_t material, const char *name, uint32_t value1,
 	if (matparam != nullptr) {
 		matparam[0] = value1;
 		matparam[1] = value2;
-		material->args.buffer_dirty = true;
+		material_mark_dirty(material);
 	}
 }
 
@@ -562,7 +651,7 @@ void material_set_uint3(material_t material, const char *name, uint32_t value1,
 		matparam[0] = value1;
 		matparam[1] = value2;
 		matparam[2] = value3;
-		material->args.buffer_dirty = true;
+		material_mark_dirty(material);
 	}
 }
 
@@ -575,7 +664,7 @@ void material_set_uint4(material_t material, const char *name, uint32_t value1,
 		matparam[1] = value2;
 		matparam[2] = value3;
 		matparam[3] = value4;
-		material->args.buffer_dirty = true;
+		material_mark_dirty(material);
 	}
 }
 
@@ -591,40 +680,45 @@ void material_set_matrix(material_t material, const char *name, matrix value) {
 		return;
 	}
 	*(matrix *)((uint8_t*)material->args.buffer + info->offset) = value;
-	material->args.buffer_dirty = true;
+	material_mark_dirty(material);
 }
 
 ///////////////////////////////////////////
 
-bool32_t material_set_texture_id(material_t material, uint64_t id, tex_t value) {
-
-	for (uint32_t i = 0; i < material->shader->shader.meta->resource_count; i++) {
+void _material_set_texture_at(material_t material, int32_t i, tex_t value) {
+	// Assigning a null texture will crash the renderer, so we want to
+	// instead find the default texture for the material parameter.
+	if (value == nullptr) {
 		const skg_shader_resource_t *resource = &material->shader->shader.meta->resources[i];
-		if (resource->name_hash == id) {
+		if      (string_eq(resource->value, "white")) value = sk_default_tex;
+		else if (string_eq(resource->value, "black")) value = sk_default_tex_black;
+		else if (string_eq(resource->value, "gray" )) value = sk_default_tex_gray;
+		else if (string_eq(resource->value, "flat" )) value = sk_default_tex_flat;
+		else if (string_eq(resource->value, "rough")) value = sk_default_tex_rough;
+		else                                          value = sk_default_tex;
+	}
 
-			// Assigning a null texture will crash the renderer, so we want to
-			// instead find the default texture for the material parameter.
-			if (value == nullptr) {
-				if      (string_eq(resource->value, "white")) value = sk_default_tex;
-				else if (string_eq(resource->value, "black")) value = sk_default_tex_black;
-				else if (string_eq(resource->value, "gray" )) value = sk_default_tex_gray;
-				else if (string_eq(resource->value, "flat" )) value = sk_default_tex_flat;
-				else if (string_eq(resource->value, "rough")) value = sk_default_tex_rough;
-				else                                          value = sk_default_tex;
-			}
+	if (material->args.textures[i].tex != value) {
+		// No need for safe swap, since we know these textures aren't
+		// the same texture.
+		if (material->args.textures[i].tex != nullptr)
+			tex_release(material->args.textures[i].tex);
+		material->args.textures[i].tex = value;
+		tex_addref(value);
+		material->data_version++;
 
-			if (material->args.textures[i].tex != value) {
-				// No need for safe swap, since we know these textures aren't
-				// the same texture.
-				if (material->args.textures[i].tex != nullptr)
-					tex_release(material->args.textures[i].tex);
-				material->args.textures[i].tex = value;
-				tex_addref(value);
-
-				// Information about the texture needs updated as well, but
-				// this is done when checking the material before rendering,
-				// since the texture's internal contents can change at any time
-			}
+		// Information about the texture needs updated as well, but
+		// this is done when checking the material before rendering,
+		// since the texture's internal contents can change at any time
+	}
+}
+
+///////////////////////////////////////////
+
+bool32_t material_set_texture_id(material_t material, uint64_t id, tex_t value) {
+	for (uint32_t i = 0; i < material->shader->shader.meta->resource_count; i++) {
+		if (material->shader->shader.meta->resources[i].name_hash == id) {
+			_material_set_texture_at(material, (int32_t)i, value);
 			return true;
 		}
 	}
@@ -749,7 +843,7 @@ void material_set_param_id(material_t material, uint64_t id, material_param_ typ
 		if (i != -1) {
 			const skg_shader_var_t *info = skg_shader_get_var_info(&material->shader->shader, i);
 			memcpy(((uint8_t *)material->args.buffer + info->offset), value, info->size);
-			material->args.buffer_dirty = true;
+			material_mark_dirty(material);
 		}
 	}
 }
@@ -783,6 +877,132 @@ bool32_t material_get_param_id(material_t material, uint64_t id, material_param_
 
 ///////////////////////////////////////////
 
+material_param_handle_t material_param_handle(const char *name) {
+	material_param_handle_t result = {};
+	result.name_hash     = hash_fnv64_string(name);
+	result.offset        = -1;
+	result.texture_index = -1;
+	return result;
+}
+
+///////////////////////////////////////////
+
+// Shaders never change after creation, so a handle only needs looking up
+// again when it's used with a material on a different shader than last
+// time. This also covers materials that have had material_set_shader
+// called on them.
+inline void _material_handle_resolve(material_t material, material_param_handle_t *handle) {
+	const shader_t shader = material->shader;
+	if (handle->shader_generation == shader->generation) return;
+
+	handle->shader_generation = shader->generation;
+	handle->offset            = -1;
+	handle->size              = 0;
+	handle->texture_index     = -1;
+
+	int32_t i = skg_shader_get_var_index_h(&shader->shader, handle->name_hash);
+	if (i != -1) {
+		const skg_shader_var_t *info = skg_shader_get_var_info(&shader->shader, i);
+		handle->offset = (int32_t)info->offset;
+		handle->size   = (int32_t)info->size;
+		return;
+	}
+	for (uint32_t t = 0; t < shader->shader.meta->resource_count; t++) {
+		if (shader->shader.meta->resources[t].name_hash == handle->name_hash) {
+			handle->texture_index = (int32_t)t;
+			return;
+		}
+	}
+}
+
+///////////////////////////////////////////
+
+void *_material_get_ptr_handle(material_t material, material_param_handle_t *handle, uint32_t size) {
+	_material_handle_resolve(material, handle);
+	if (handle->offset < 0) return nullptr;
+
+	if ((uint32_t)handle->size != size) {
+		log_errf("material_set_: mismatched type for param handle (for shader %s)", material->shader->shader.meta->name);
+		return nullptr;
+	}
+	return (uint8_t*)material->args.buffer + handle->offset;
+}
+
+///////////////////////////////////////////
+
+bool32_t material_set_param_handle(material_t material, material_param_handle_t *handle, material_param_ type, const void *value) {
+	if (type == material_param_texture) {
+		_material_handle_resolve(material, handle);
+		if (handle->texture_index < 0) return false;
+		_material_set_texture_at(material, handle->texture_index, (tex_t)value);
+		return true;
+	}
+
+	void *matparam = _material_get_ptr_handle(material, handle, (uint32_t)material_param_size(type));
+	if (matparam == nullptr) return false;
+	memcpy(matparam, value, handle->size);
+	material_mark_dirty(material);
+	return true;
+}
+
+///////////////////////////////////////////
+
+bool32_t material_get_param_handle(material_t material, material_param_handle_t *handle, material_param_ type, void *out_value) {
+	if (type == material_param_texture) {
+		_material_handle_resolve(material, handle);
+		if (handle->texture_index < 0) return false;
+		memcpy(out_value, &material->args.textures[handle->texture_index].tex, sizeof(tex_t));
+		return true;
+	}
+
+	void *matparam = _material_get_ptr_handle(material, handle, (uint32_t)material_param_size(type));
+	if (matparam == nullptr) return false;
+	memcpy(out_value, matparam, handle->size);
+	return true;
+}
+
+///////////////////////////////////////////
+
+void material_set_float_handle(material_t material, material_param_handle_t *handle, float value) {
+	float *matparam = (float*)_material_get_ptr_handle(material, handle, sizeof(float));
+	if (matparam != nullptr) {
+		*matparam = value;
+		material_mark_dirty(material);
+	}
+}
+
+///////////////////////////////////////////
+
+void material_set_vector4_handle(material_t material, material_param_handle_t *handle, vec4 value) {
+	vec4 *matparam = (vec4*)_material_get_ptr_handle(material, handle, sizeof(vec4));
+	if (matparam != nullptr) {
+		*matparam = value;
+		material_mark_dirty(material);
+	}
+}
+
+///////////////////////////////////////////
+
+void material_set_color_handle(material_t material, material_param_handle_t *handle, color128 value) {
+	color128 *matparam = (color128*)_material_get_ptr_handle(material, handle, sizeof(color128));
+	if (matparam != nullptr) {
+		*matparam = color_to_linear(value);
+		material_mark_dirty(material);
+	}
+}
+
+///////////////////////////////////////////
+
+void material_set_matrix_handle(material_t material, material_param_handle_t *handle, matrix value) {
+	matrix *matparam = (matrix*)_material_get_ptr_handle(material, handle, sizeof(matrix));
+	if (matparam != nullptr) {
+		*matparam = value;
+		material_mark_dirty(material);
+	}
+}
+
+///////////////////////////////////////////
+
 void material_get_param_info(material_t material, int32_t index, char **out_name, material_param_ *out_type) {
 	const skg_shader_meta_t *meta = material->shader->shader.meta;
 
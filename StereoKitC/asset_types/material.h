@@ -22,6 +22,24 @@ struct shaderargs_data_t {
 	int32_t           texture_count;
 };
 
+// Materials that share a shader and the same fixed-function state also share
+// a single GPU pipeline object, which keeps pipeline counts down for apps that
+// copy materials around, and lets the renderer skip redundant binds.
+struct material_pipeline_key_t {
+	uint32_t shader_generation;
+	int32_t  transparency;
+	int32_t  cull;
+	int32_t  depth_test;
+	int32_t  wireframe;
+	int32_t  depth_write;
+};
+
+struct material_pipeline_t {
+	skg_pipeline_t          pipeline;
+	material_pipeline_key_t key;
+	int32_t                 refs;
+};
+
 struct _material_t {
 	asset_header_t    header;
 	shader_t          shader;
@@ -32,8 +50,10 @@ struct _material_t {
 	depth_test_       depth_test;
 	bool32_t          depth_write;
 	int32_t           queue_offset;
-	skg_pipeline_t    pipeline;
+	material_pipeline_t *pipeline;
 	material_t        chain;
+	// Bumped whenever a parameter, texture, or render state changes
+	uint32_t          data_version;
 };
 
 struct _material_buffer_t {
@@ -5,6 +5,14 @@
 #include "mesh.h"
 #include "assets.h"
 
+#include "../libraries/array.h"
+#include "../libraries/atomic_util.h"
+#include "../libraries/ferr_hash.h"
+#include "../libraries/ferr_thread.h"
+#include "../libraries/stref.h"
+#include "../platforms/platform.h"
+
+#include <meshoptimizer.h>
 #include <stdio.h>
 #include <string.h>
 
@@ -18,6 +26,16 @@ namespace sk {
 
 void mesh_update_label(mesh_t mesh);
 
+array_t<mesh_collider_t*> mesh_colliders        = {};
+char*                     mesh_collider_folder  = nullptr;
+
+///////////////////////////////////////////
+
+ft_mutex_t mesh_collider_mutex() {
+	static ft_mutex_t mtx = ft_mutex_create();
+	return mtx;
+}
+
 ///////////////////////////////////////////
 
 void mesh_set_keep_data(mesh_t mesh, bool32_t keep_data) {
@@ -28,8 +46,8 @@ void mesh_set_keep_data(mesh_t mesh, bool32_t keep_data) {
 
 	mesh->discard_data = !keep_data;
 	if (mesh->discard_data) {
-		sk_free(mesh->verts);
-		sk_free(mesh->inds );
+		sk_free_tag(mesh->verts);
+		sk_free_tag(mesh->inds );
 	}
 }
 
@@ -41,11 +59,36 @@ bool32_t mesh_get_keep_data(mesh_t mesh) {
 
 ///////////////////////////////////////////
 
+void mesh_set_occluder(mesh_t mesh, bool32_t occluder) {
+	// Occluders are rasterized on the CPU from the mesh's own data
+	if (occluder && mesh->discard_data) {
+		log_warn("Occluder meshes must keep their data, ignoring mesh_set_occluder call.");
+		return;
+	}
+	mesh->occluder = occluder;
+}
+
+///////////////////////////////////////////
+
+bool32_t mesh_get_occluder(mesh_t mesh) {
+	return mesh->occluder;
+}
+
+///////////////////////////////////////////
+
 void _mesh_set_verts(mesh_t mesh, const vert_t *vertices, uint32_t vertex_count, bool32_t calculate_bounds, bool update_original) {
+	// Any LODs and collision data were made from the old data
+	if (update_original)
+		mesh_collision_release(mesh);
+	if (update_original && mesh->lod_count > 0)
+		mesh_lods_release(mesh);
+	if (update_original && mesh->cluster_count > 0)
+		mesh_clusters_release(mesh);
+
 	// Keep track of vertex data for use on CPU side
 	if (!mesh->discard_data && update_original) {
 		if (mesh->vert_capacity < vertex_count)
-			mesh->verts = sk_realloc_t(vert_t, mesh->verts, vertex_count);
+			mesh->verts = sk_realloc_tag_t(memory_tag_mesh, vert_t, mesh->verts, vertex_count);
 		memcpy(mesh->verts, vertices, sizeof(vert_t) * vertex_count);
 	}
 
@@ -76,6 +119,7 @@ void _mesh_set_verts(mesh_t mesh, const vert_t *vertices, uint32_t vertex_count,
 	}
 
 	mesh->vert_count = vertex_count;
+	mesh->data_version++;
 
 	if (calculate_bounds && vertex_count > 0) {
 		mesh->bounds = mesh_calculate_bounds(vertices, vertex_count);
@@ -127,11 +171,16 @@ void _mesh_set_inds (mesh_t mesh, const vind_t *indices, uint32_t index_count) {
 		log_err("mesh_set_inds index_count must be a multiple of 3!");
 		return;
 	}
+	mesh_collision_release(mesh);
+	if (mesh->lod_count > 0)
+		mesh_lods_release(mesh);
+	if (mesh->cluster_count > 0)
+		mesh_clusters_release(mesh);
 
 	// Keep track of index data for use on CPU side
 	if (!mesh->discard_data) {
 		if (mesh->ind_capacity < index_count)
-			mesh->inds = sk_realloc_t(vind_t, mesh->inds, index_count);
+			mesh->inds = sk_realloc_tag_t(memory_tag_mesh, vind_t, mesh->inds, index_count);
 		memcpy(mesh->inds, indices, sizeof(vind_t) * index_count);
 	}
 
@@ -163,6 +212,7 @@ void _mesh_set_inds (mesh_t mesh, const vind_t *indices, uint32_t index_count) {
 
 	mesh->ind_count = index_count;
 	mesh->ind_draw  = index_count;
+	mesh->data_version++;
 }
 
 ///////////////////////////////////////////
@@ -374,14 +424,14 @@ bool _mesh_set_skin(mesh_t mesh, const bone_weight_t *bone_weights, uint32_t bon
 		return false;
 	}
 
-	mesh->skin_data.bone_data      = sk_malloc_t(bone_weight_t, bone_weight_count);
-	mesh->skin_data.deformed_verts = sk_malloc_t(vert_t,        mesh->vert_count);
+	mesh->skin_data.bone_data      = sk_malloc_tag_t(memory_tag_mesh, bone_weight_t, bone_weight_count);
+	mesh->skin_data.deformed_verts = sk_malloc_tag_t(memory_tag_mesh, vert_t,        mesh->vert_count);
 	memcpy(mesh->skin_data.deformed_verts, mesh->verts, sizeof(vert_t) * mesh->vert_count);
 	if (bone_weights != nullptr)
 		memcpy(mesh->skin_data.bone_data, bone_weights, sizeof(bone_weight_t) * bone_weight_count);
 
-	mesh->skin_data.bone_inverse_transforms = sk_malloc_t(matrix, bone_count);
-	mesh->skin_data.bone_transforms         = sk_malloc_t(matrix, bone_count);
+	mesh->skin_data.bone_inverse_transforms = sk_malloc_tag_t(memory_tag_mesh, matrix, bone_count);
+	mesh->skin_data.bone_transforms         = sk_malloc_tag_t(memory_tag_mesh, matrix, bone_count);
 	memset(mesh->skin_data.bone_inverse_transforms, 0, sizeof(matrix) * bone_count);
 	memset(mesh->skin_data.bone_transforms,         0, sizeof(matrix) * bone_count);
 
@@ -417,6 +467,15 @@ void mesh_set_skin_inv(mesh_t mesh, const bone_weight_t* bone_weights, uint32_t
 ///////////////////////////////////////////
 
 void mesh_update_skin(mesh_t mesh, const matrix *bone_transforms, int32_t bone_count) {
+	mesh_skin_deform(mesh, bone_transforms, bone_count);
+	mesh_skin_upload(mesh);
+}
+
+///////////////////////////////////////////
+
+// CPU side of skinning, this doesn't touch the GPU, so it's safe to run off
+// the main thread as long as nothing else is using this mesh.
+void mesh_skin_deform(mesh_t mesh, const matrix *bone_transforms, int32_t bone_count) {
 	for (int32_t i = 0; i < bone_count; i++) {
 		mesh->skin_data.bone_transforms[i] = mesh->skin_data.bone_inverse_transforms[i] * bone_transforms[i];
 	}
@@ -463,6 +522,11 @@ void mesh_update_skin(mesh_t mesh, const matrix *bone_transforms, int32_t bone_c
 	XMVECTOR dimensions = XMVectorSubtract(max, min);
 	mesh->bounds.center     = math_fast_to_vec3(center);
 	mesh->bounds.dimensions = math_fast_to_vec3(dimensions);
+}
+
+///////////////////////////////////////////
+
+void mesh_skin_upload(mesh_t mesh) {
 	_mesh_set_verts(mesh, mesh->skin_data.deformed_verts, mesh->vert_count, false, false);
 }
 
@@ -535,6 +599,15 @@ mesh_t mesh_copy(mesh_t mesh) {
 		mesh_set_verts(result, mesh->verts, mesh->vert_count, false);
 		if (mesh_has_skin(mesh))
 			mesh_set_skin_inv(result, mesh->skin_data.bone_data, mesh->vert_count, mesh->skin_data.bone_inverse_transforms, mesh->skin_data.bone_count);
+
+		// Same triangles, so the same collision data, no need to hash it
+		if (mesh->collider != nullptr) {
+			ft_mutex_t mtx = mesh_collider_mutex();
+			ft_mutex_lock(mtx);
+			mesh->collider->refs++;
+			result->collider = mesh->collider;
+			ft_mutex_unlock(mtx);
+		}
 	}
 
 	return result;
@@ -543,39 +616,187 @@ mesh_t mesh_copy(mesh_t mesh) {
 ///////////////////////////////////////////
 
 const mesh_collision_t *mesh_get_collision_data(mesh_t mesh) {
-	if (mesh->collision_data.pts != nullptr)
-		return &mesh->collision_data;
+	if (mesh->collider != nullptr)
+		return &mesh->collider->collision;
 	if (mesh->discard_data)
 		return nullptr;
 
-	mesh_collision_t &coll = mesh->collision_data;
-	coll.pts    = sk_malloc_t(vec3   , mesh->ind_count);
-	coll.planes = sk_malloc_t(plane_t, mesh->ind_count/3);
+	vec3 *pts = sk_malloc_tag_t(memory_tag_mesh, vec3, mesh->ind_count);
+	for (uint32_t i = 0; i < mesh->ind_count; i++) pts[i] = mesh->verts[mesh->inds[i]].pos;
+	uint64_t hash = hash_fnv64_data(pts, sizeof(vec3) * mesh->ind_count);
+
+	ft_mutex_t mtx = mesh_collider_mutex();
+	ft_mutex_lock(mtx);
+	// Another thread may have gotten here first
+	if (mesh->collider != nullptr) {
+		ft_mutex_unlock(mtx);
+		sk_free_tag(pts);
+		return &mesh->collider->collision;
+	}
 
-	for (uint32_t i = 0; i < mesh->ind_count; i++) coll.pts[i] = mesh->verts[mesh->inds[i]].pos;
+	mesh_collider_t *collider = nullptr;
+	for (int32_t i = 0; i < mesh_colliders.count; i++) {
+		if (mesh_colliders[i]->hash     == hash           &&
+			mesh_colliders[i]->pt_count == mesh->ind_count &&
+			memcmp(mesh_colliders[i]->collision.pts, pts, sizeof(vec3) * mesh->ind_count) == 0) {
+			collider = mesh_colliders[i];
+			break;
+		}
+	}
 
-	for (uint32_t i = 0; i < mesh->ind_count; i += 3) {
-		vec3    dir1   = coll.pts[i+1] - coll.pts[i];
-		vec3    dir2   = coll.pts[i+1] - coll.pts[i+2];
-		vec3    normal = vec3_normalize( vec3_cross(dir2, dir1) );
-		plane_t plane  = { normal, -vec3_dot(coll.pts[i + 1], normal) };
-		coll.planes[i/3] = plane;
+	if (collider != nullptr) {
+		sk_free_tag(pts);
+	} else {
+		collider = sk_malloc_t(mesh_collider_t, 1);
+		*collider = {};
+		collider->hash     = hash;
+		collider->pt_count = mesh->ind_count;
+
+		mesh_collision_t &coll = collider->collision;
+		coll.pts    = pts;
+		coll.planes = sk_malloc_tag_t(memory_tag_mesh, plane_t, mesh->ind_count/3);
+		for (uint32_t i = 0; i < mesh->ind_count; i += 3) {
+			vec3    dir1   = coll.pts[i+1] - coll.pts[i];
+			vec3    dir2   = coll.pts[i+1] - coll.pts[i+2];
+			vec3    normal = vec3_normalize( vec3_cross(dir2, dir1) );
+			plane_t plane  = { normal, -vec3_dot(coll.pts[i + 1], normal) };
+			coll.planes[i/3] = plane;
+		}
+		mesh_colliders.add(collider);
 	}
+	collider->refs++;
+	atomic_fence();
+	mesh->collider = collider;
+	ft_mutex_unlock(mtx);
 
-	return &mesh->collision_data;
+	return &collider->collision;
+}
+
+///////////////////////////////////////////
+
+// The folder can be changed from any thread, so this takes the lock and
+// returns false if there's no cache folder set.
+bool mesh_collider_path(uint64_t hash, char *out_path, size_t path_size) {
+	ft_mutex_t mtx = mesh_collider_mutex();
+	ft_mutex_lock(mtx);
+	bool result = mesh_collider_folder != nullptr;
+	if (result)
+		snprintf(out_path, path_size, "%s/%016llx.skbvh", mesh_collider_folder, (unsigned long long)hash);
+	ft_mutex_unlock(mtx);
+	return result;
 }
 
 ///////////////////////////////////////////
 
 const mesh_bvh_t *mesh_get_bvh_data(mesh_t mesh) {
-	if (mesh->bvh_data != nullptr)
-		return mesh->bvh_data;
-	if (mesh->discard_data)
+	if (mesh->collider != nullptr && mesh->collider->bvh != nullptr)
+		return mesh->collider->bvh;
+	const mesh_collision_t *coll = mesh_get_collision_data(mesh);
+	if (coll == nullptr)
+		return nullptr;
+
+	// Big meshes can take a while to build, and a previous run may have left
+	// one behind for us. Neither of those should hold up other threads, so
+	// the lock is only taken to publish the result.
+	mesh_collider_t *collider  = mesh->collider;
+	uint32_t         tri_count = mesh->ind_count / 3;
+	char             path[512];
+	mesh_bvh_t      *bvh       = nullptr;
+	bool             built     = false;
+	bool             cached    = mesh_collider_path(collider->hash, path, sizeof(path));
+	if (cached) {
+		void  *data = nullptr;
+		size_t size = 0;
+		if (platform_file_exists(path) && platform_read_file_direct(path, &data, &size)) {
+			bvh = mesh_bvh_deserialize(data, size, collider->hash, coll, tri_count);
+			if (bvh == nullptr) log_diagf("Ignoring stale collision cache file <~grn>%s<~clr>", path);
+		}
+		sk_free(data);
+	}
+	if (bvh == nullptr) {
+		bvh   = mesh_bvh_create(mesh, 16);
+		built = bvh != nullptr;
+	}
+	if (bvh == nullptr)
 		return nullptr;
+	// Shared between meshes, so this can't point back at any one of them
+	bvh->the_mesh = nullptr;
+
+	ft_mutex_t mtx       = mesh_collider_mutex();
+	bool       published = false;
+	ft_mutex_lock(mtx);
+	if (collider->bvh == nullptr) {
+		atomic_fence();
+		collider->bvh = bvh;
+		published     = true;
+	}
+	ft_mutex_unlock(mtx);
+
+	if (!published) {
+		// Another thread beat us to it
+		mesh_bvh_destroy(bvh);
+		sk_free(bvh);
+	} else if (built && cached) {
+		size_t size = 0;
+		void  *data = mesh_bvh_serialize(bvh, collider->hash, coll, tri_count, &size);
+		if (!platform_write_file(path, data, size))
+			log_warnf("Couldn't write collision cache file <~grn>%s<~clr>", path);
+		sk_free(data);
+	}
+
+	return collider->bvh;
+}
+
+///////////////////////////////////////////
+
+void mesh_collision_release(mesh_t mesh) {
+	mesh_collider_t *collider = mesh->collider;
+	if (collider == nullptr) return;
+	mesh->collider = nullptr;
+
+	ft_mutex_t mtx = mesh_collider_mutex();
+	ft_mutex_lock(mtx);
+	collider->refs--;
+	if (collider->refs > 0) {
+		ft_mutex_unlock(mtx);
+		return;
+	}
+	int32_t idx = mesh_colliders.index_of(collider);
+	if (idx >= 0) mesh_colliders.remove(idx);
+	if (mesh_colliders.count == 0) mesh_colliders.free();
+	ft_mutex_unlock(mtx);
+
+	sk_free_tag(collider->collision.pts   );
+	sk_free_tag(collider->collision.planes);
+	if (collider->bvh) {
+		mesh_bvh_destroy(collider->bvh);
+		sk_free(collider->bvh);
+	}
+	sk_free(collider);
+}
+
+///////////////////////////////////////////
+
+void mesh_set_collision_cache(const char *folder_utf8) {
+	ft_mutex_t mtx = mesh_collider_mutex();
+	ft_mutex_lock(mtx);
+	sk_free(mesh_collider_folder);
+	mesh_collider_folder = folder_utf8 != nullptr && folder_utf8[0] != '\0'
+		? string_copy(folder_utf8)
+		: nullptr;
+	ft_mutex_unlock(mtx);
+}
+
+///////////////////////////////////////////
+
+const char *mesh_get_collision_cache() {
+	return mesh_collider_folder;
+}
 
-	mesh->bvh_data = mesh_bvh_create(mesh, 16);
+///////////////////////////////////////////
 
-	return mesh->bvh_data;
+void mesh_shutdown() {
+	mesh_set_collision_cache(nullptr);
 }
 
 ///////////////////////////////////////////
@@ -592,22 +813,322 @@ void mesh_destroy(mesh_t mesh) {
 	skg_mesh_destroy  (&mesh->gpu_mesh);
 	skg_buffer_destroy(&mesh->vert_buffer);
 	skg_buffer_destroy(&mesh->ind_buffer);
-	sk_free(mesh->verts);
-	sk_free(mesh->inds);
-	sk_free(mesh->collision_data.pts   );	// XXX doesn't this fail when no colldata has been created?
-	sk_free(mesh->collision_data.planes);
-	if (mesh->bvh_data)
-		mesh_bvh_destroy(mesh->bvh_data);
-
-	sk_free(mesh->skin_data.bone_data);
-	sk_free(mesh->skin_data.bone_inverse_transforms);
-	sk_free(mesh->skin_data.bone_transforms);
-	sk_free(mesh->skin_data.deformed_verts);
+	sk_free_tag(mesh->verts);
+	sk_free_tag(mesh->inds);
+	mesh_collision_release(mesh);
+	mesh_lods_release(mesh);
+	mesh_clusters_release(mesh);
+
+	sk_free_tag(mesh->skin_data.bone_data);
+	sk_free_tag(mesh->skin_data.bone_inverse_transforms);
+	sk_free_tag(mesh->skin_data.bone_transforms);
+	sk_free_tag(mesh->skin_data.deformed_verts);
 
 	*mesh = {};
 }
 
 
+///////////////////////////////////////////
+
+void mesh_generate_lods(mesh_t mesh, int32_t level_count, float level_reduction) {
+	if (mesh->discard_data || mesh->verts == nullptr || mesh->inds == nullptr) {
+		log_warn("mesh_generate_lods needs a mesh that keeps its data!");
+		return;
+	}
+	if (mesh_has_skin(mesh)) {
+		log_warn("mesh_generate_lods doesn't support skinned meshes.");
+		return;
+	}
+	if (level_reduction <= 0 || level_reduction >= 1) {
+		log_warn("mesh_generate_lods level_reduction must be between 0 and 1.");
+		return;
+	}
+
+	// The mesh's data can only change on the main thread, so that's where
+	// a copy of it gets made. This may be running on any thread, so only the
+	// simplification happens here, the GPU side of each level is created
+	// back on the main thread.
+	struct lod_level_t {
+		vert_t  *verts;
+		vind_t  *inds;
+		uint32_t vert_count;
+		uint32_t ind_count;
+		float    error;
+	};
+	struct lod_job_t {
+		mesh_t       mesh;
+		vert_t      *verts;
+		vind_t      *inds;
+		uint32_t     vert_count;
+		uint32_t     ind_count;
+		bounds_t     bounds;
+		uint32_t     version;
+		lod_level_t *levels;
+		int32_t      level_count;
+	};
+	lod_job_t job = {};
+	job.mesh = mesh;
+	assets_execute_gpu([](void *data) {
+		lod_job_t *job  = (lod_job_t *)data;
+		mesh_t     mesh = job->mesh;
+		if (mesh->verts == nullptr || mesh->inds == nullptr)
+			return (bool32_t)false;
+		job->vert_count = mesh->vert_count;
+		job->ind_count  = mesh->ind_count;
+		job->bounds     = mesh->bounds;
+		job->version    = mesh->data_version;
+		job->verts      = sk_malloc_t(vert_t, job->vert_count);
+		job->inds       = sk_malloc_t(vind_t, job->ind_count);
+		memcpy(job->verts, mesh->verts, sizeof(vert_t) * job->vert_count);
+		memcpy(job->inds,  mesh->inds,  sizeof(vind_t) * job->ind_count);
+		return (bool32_t)true;
+	}, &job);
+	if (job.verts == nullptr || job.inds == nullptr) {
+		sk_free(job.verts);
+		sk_free(job.inds);
+		return;
+	}
+
+	const vert_t *verts      = job.verts;
+	const vind_t *inds       = job.inds;
+	uint32_t      vert_count = job.vert_count;
+	uint32_t      ind_count  = job.ind_count;
+	float         scale      = meshopt_simplifyScale(&verts[0].pos.x, vert_count, sizeof(vert_t));
+
+	array_t<lod_level_t> levels     = {};
+	vind_t              *lod_inds   = sk_malloc_t(vind_t, ind_count);
+	vert_t              *lod_verts  = sk_malloc_t(vert_t, vert_count);
+	size_t               prev_count = ind_count;
+	for (int32_t l = 1; l <= level_count; l++) {
+		// Each level simplifies from the original, which gives better
+		// results than simplifying the previous level.
+		size_t target = (size_t)(ind_count * powf(level_reduction, (float)l)) / 3 * 3;
+		if (target < 3) break;
+
+		float  error     = 0;
+		size_t lod_count = meshopt_simplify(lod_inds, inds, ind_count, &verts[0].pos.x, vert_count, sizeof(vert_t), target, 1.0f, 0, &error);
+		// If the simplifier can't make much progress, more levels won't
+		// help anything.
+		if (lod_count == 0 || lod_count > prev_count * 0.9f) break;
+		prev_count = lod_count;
+
+		// Only keep the vertices this level actually uses
+		size_t lod_vert_count = meshopt_optimizeVertexFetch(lod_verts, lod_inds, lod_count, verts, vert_count, sizeof(vert_t));
+
+		lod_level_t level = {};
+		level.error      = error * scale;
+		level.vert_count = (uint32_t)lod_vert_count;
+		level.ind_count  = (uint32_t)lod_count;
+		level.verts      = sk_malloc_t(vert_t, lod_vert_count);
+		level.inds       = sk_malloc_t(vind_t, lod_count);
+		memcpy(level.verts, lod_verts, sizeof(vert_t) * lod_vert_count);
+		memcpy(level.inds,  lod_inds,  sizeof(vind_t) * lod_count);
+		levels.add(level);
+	}
+	sk_free(lod_inds);
+	sk_free(lod_verts);
+	sk_free(job.verts);
+	sk_free(job.inds);
+
+	// The levels are uploaded and swapped in on the main thread, between
+	// frames, so GPU buffers are only ever created there, and the renderer
+	// is never partway through reading the old set when it gets released.
+	job.levels      = levels.data;
+	job.level_count = levels.count;
+	assets_execute_gpu([](void *data) {
+		lod_job_t *job  = (lod_job_t *)data;
+		mesh_t     mesh = job->mesh;
+		// The mesh changed while these were being built, so they're stale
+		if (mesh->data_version != job->version)
+			return (bool32_t)false;
+
+		mesh_lod_t *lods = sk_malloc_t(mesh_lod_t, job->level_count);
+		for (int32_t i = 0; i < job->level_count; i++) {
+			const lod_level_t &level = job->levels[i];
+			lods[i].error = level.error;
+			lods[i].mesh  = mesh_create();
+			mesh_set_keep_data(lods[i].mesh, false);
+			mesh_set_data     (lods[i].mesh, level.verts, (int32_t)level.vert_count, level.inds, (int32_t)level.ind_count, false);
+			// Culling should match the original
+			mesh_set_bounds   (lods[i].mesh, job->bounds);
+			if (mesh->header.id_text != nullptr) {
+				char id[256];
+				snprintf(id, sizeof(id), "%s/lod%d", mesh->header.id_text, i + 1);
+				mesh_set_id(lods[i].mesh, id);
+			}
+		}
+
+		mesh_lods_release(mesh);
+		mesh->lods      = lods;
+		mesh->lod_count = job->level_count;
+		mesh->lod_last  = 0;
+		return (bool32_t)true;
+	}, &job);
+
+	for (int32_t i = 0; i < job.level_count; i++) {
+		sk_free(job.levels[i].verts);
+		sk_free(job.levels[i].inds);
+	}
+	sk_free(job.levels);
+}
+
+///////////////////////////////////////////
+
+int32_t mesh_get_lod_count(mesh_t mesh) {
+	return mesh->lod_count;
+}
+
+///////////////////////////////////////////
+
+void mesh_lods_release(mesh_t mesh) {
+	mesh_lod_t *lods  = mesh->lods;
+	int32_t     count = mesh->lod_count;
+	mesh->lod_count = 0;
+	mesh->lods      = nullptr;
+	for (int32_t i = 0; i < count; i++)
+		mesh_release(lods[i].mesh);
+	sk_free(lods);
+}
+
+///////////////////////////////////////////
+
+void mesh_build_clusters(mesh_t mesh) {
+	if (mesh->discard_data || mesh->verts == nullptr || mesh->inds == nullptr) {
+		log_warn("mesh_build_clusters needs a mesh that keeps its data!");
+		return;
+	}
+	if (mesh_has_skin(mesh)) {
+		log_warn("mesh_build_clusters doesn't support skinned meshes.");
+		return;
+	}
+
+	// Like LODs, the mesh's data is copied on the main thread, the clusters
+	// are built on whichever thread called this, and the results are
+	// uploaded and published back on the main thread, where the renderer
+	// reads them.
+	struct cluster_job_t {
+		mesh_t          mesh;
+		vert_t         *verts;
+		vind_t         *inds;
+		uint32_t        vert_count;
+		uint32_t        ind_count;
+		uint32_t        version;
+		mesh_cluster_t *clusters;
+		int32_t         cluster_count;
+	};
+	cluster_job_t job = {};
+	job.mesh = mesh;
+	assets_execute_gpu([](void *data) {
+		cluster_job_t *job  = (cluster_job_t *)data;
+		mesh_t         mesh = job->mesh;
+		if (mesh->verts == nullptr || mesh->inds == nullptr)
+			return (bool32_t)false;
+		job->vert_count = mesh->vert_count;
+		job->ind_count  = mesh->ind_count;
+		job->version    = mesh->data_version;
+		job->verts      = sk_malloc_t(vert_t, job->vert_count);
+		job->inds       = sk_malloc_t(vind_t, job->ind_count);
+		memcpy(job->verts, mesh->verts, sizeof(vert_t) * job->vert_count);
+		memcpy(job->inds,  mesh->inds,  sizeof(vind_t) * job->ind_count);
+		return (bool32_t)true;
+	}, &job);
+	if (job.verts == nullptr || job.inds == nullptr) {
+		sk_free(job.verts);
+		sk_free(job.inds);
+		return;
+	}
+
+	// These sizes fit nicely in the vertex cache, while still being large
+	// enough that per-cluster culling stays cheap.
+	const size_t max_verts = 64;
+	const size_t max_tris  = 124;
+
+	const vert_t *verts      = job.verts;
+	uint32_t      vert_count = job.vert_count;
+	uint32_t      ind_count  = job.ind_count;
+
+	size_t           max_meshlets  = meshopt_buildMeshletsBound(ind_count, max_verts, max_tris);
+	meshopt_Meshlet *meshlets      = sk_malloc_t(meshopt_Meshlet, max_meshlets);
+	uint32_t        *meshlet_verts = sk_malloc_t(uint32_t,        max_meshlets * max_verts);
+	uint8_t         *meshlet_tris  = sk_malloc_t(uint8_t,         max_meshlets * max_tris * 3);
+	size_t           meshlet_count = meshopt_buildMeshlets(meshlets, meshlet_verts, meshlet_tris, job.inds, ind_count, &verts[0].pos.x, vert_count, sizeof(vert_t), max_verts, max_tris, 0.25f);
+
+	// Each cluster's triangles are written back out contiguously, so a
+	// cluster is just a range of the index buffer when drawing.
+	mesh_cluster_t *clusters = sk_malloc_t(mesh_cluster_t, meshlet_count);
+	vind_t         *inds     = sk_malloc_t(vind_t,         ind_count);
+	uint32_t        curr     = 0;
+	for (size_t i = 0; i < meshlet_count; i++) {
+		const meshopt_Meshlet *m      = &meshlets[i];
+		meshopt_Bounds         bounds = meshopt_computeMeshletBounds(&meshlet_verts[m->vertex_offset], &meshlet_tris[m->triangle_offset], m->triangle_count, &verts[0].pos.x, vert_count, sizeof(vert_t));
+
+		mesh_cluster_t *cluster = &clusters[i];
+		cluster->center      = { bounds.center   [0], bounds.center   [1], bounds.center   [2] };
+		cluster->radius      = bounds.radius;
+		cluster->cone_apex   = { bounds.cone_apex[0], bounds.cone_apex[1], bounds.cone_apex[2] };
+		cluster->cone_axis   = { bounds.cone_axis[0], bounds.cone_axis[1], bounds.cone_axis[2] };
+		cluster->cone_cutoff = bounds.cone_cutoff;
+		cluster->ind_start   = curr;
+		cluster->ind_count   = m->triangle_count * 3;
+
+		for (uint32_t t = 0; t < m->triangle_count * 3; t++)
+			inds[curr++] = meshlet_verts[m->vertex_offset + meshlet_tris[m->triangle_offset + t]];
+	}
+	sk_free(meshlets);
+	sk_free(meshlet_verts);
+	sk_free(meshlet_tris);
+	sk_free(job.verts);
+
+	// The reordered indices replace the copy, so they can go to the main
+	// thread in the same spot.
+	sk_free(job.inds);
+	job.inds          = inds;
+	job.clusters      = clusters;
+	job.cluster_count = (int32_t)meshlet_count;
+	assets_execute_gpu([](void *data) {
+		cluster_job_t *job  = (cluster_job_t *)data;
+		mesh_t         mesh = job->mesh;
+		// The mesh changed while these were being built, so they're stale
+		if (mesh->data_version != job->version)
+			return (bool32_t)false;
+
+		// This is the same set of triangles, just in a different order, so
+		// LODs are still valid and are kept. mesh_set_inds would otherwise
+		// release them along with the collision data, which does depend on
+		// triangle order.
+		mesh_lod_t *lods      = mesh->lods;
+		int32_t     lod_count = mesh->lod_count;
+		mesh->lods      = nullptr;
+		mesh->lod_count = 0;
+		mesh_set_inds(mesh, job->inds, (int32_t)job->ind_count);
+		mesh->lods      = lods;
+		mesh->lod_count = lod_count;
+
+		mesh->clusters      = job->clusters;
+		mesh->cluster_count = job->cluster_count;
+		job->clusters       = nullptr;
+		return (bool32_t)true;
+	}, &job);
+
+	sk_free(job.inds);
+	sk_free(job.clusters);
+}
+
+///////////////////////////////////////////
+
+int32_t mesh_get_cluster_count(mesh_t mesh) {
+	return mesh->cluster_count;
+}
+
+///////////////////////////////////////////
+
+void mesh_clusters_release(mesh_t mesh) {
+	mesh_cluster_t *clusters = mesh->clusters;
+	mesh->cluster_count = 0;
+	mesh->clusters      = nullptr;
+	sk_free(clusters);
+}
+
 ///////////////////////////////////////////
 
 void mesh_draw(mesh_t mesh, material_t material, matrix transform, color128 color_linear, render_layer_ layer) {
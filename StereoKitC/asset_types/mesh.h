@@ -19,6 +19,37 @@ struct mesh_weights_t {
 	int32_t   bone_count;
 };
 
+// A simplified version of a mesh, with error measuring how far the
+// simplified surface strays from the original, in the mesh's own units.
+struct mesh_lod_t {
+	mesh_t mesh;
+	float  error;
+};
+
+// A small group of triangles that occupies a contiguous range of the index
+// buffer, with a bounding sphere and a cone that bounds the triangle normals,
+// so it can be culled on its own.
+struct mesh_cluster_t {
+	vec3     center;
+	float    radius;
+	vec3     cone_apex;
+	vec3     cone_axis;
+	float    cone_cutoff;
+	uint32_t ind_start;
+	uint32_t ind_count;
+};
+
+// Collision data only depends on the triangles' positions, so meshes with
+// identical content share a single copy of it, found by a hash of those
+// positions.
+struct mesh_collider_t {
+	uint64_t         hash;
+	int32_t          refs;
+	uint32_t         pt_count;
+	mesh_collision_t collision;
+	mesh_bvh_t*      bvh;
+};
+
 struct _mesh_t {
 	asset_header_t   header;
 	uint32_t         vert_count;
@@ -35,11 +66,25 @@ struct _mesh_t {
 	bool32_t         discard_data;
 	vert_t*          verts;
 	vind_t*          inds;
-	mesh_collision_t collision_data;
-	mesh_bvh_t*      bvh_data;
+	mesh_collider_t* collider;
 	mesh_weights_t   skin_data;
+	mesh_lod_t*      lods;
+	int32_t          lod_count;
+	// The LOD last picked when drawing this mesh, for hysteresis
+	int32_t          lod_last;
+	mesh_cluster_t*  clusters;
+	int32_t          cluster_count;
+	bool32_t         occluder;
+	// Bumped whenever vertex or index data is uploaded
+	uint32_t         data_version;
 };
 
-void mesh_destroy(mesh_t mesh);
+void mesh_destroy    (mesh_t mesh);
+void mesh_skin_deform(mesh_t mesh, const matrix *bone_transforms, int32_t bone_count);
+void mesh_skin_upload(mesh_t mesh);
+void mesh_lods_release(mesh_t mesh);
+void mesh_clusters_release(mesh_t mesh);
+void mesh_collision_release(mesh_t mesh);
+void mesh_shutdown         ();
 
 } // namespace sk
\ No newline at end of file
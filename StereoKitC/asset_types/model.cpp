@@ -6,21 +6,34 @@
 #include "model.h"
 #include "mesh.h"
 #include "../libraries/stref.h"
+#include "../libraries/atomic_util.h"
 #include "../platforms/platform.h"
 
 using namespace DirectX;
 
+#include <meshoptimizer.h>
 #include <stdio.h>
 #include <string.h>
 #include <float.h>
 
 namespace sk {
 
+void model_proto_unique(model_t model);
+void model_proto_free  (model_proto_t *proto, array_t<model_node_t> *nodes);
+
+static model_import_ model_import_flags = model_import_none;
+
+// Below this, culling clusters one at a time costs more than drawing the
+// whole mesh in a single call.
+const int32_t model_import_cluster_min_inds = 4096 * 3;
+
 ///////////////////////////////////////////
 
 model_t model_create() {
 	model_t result = (_model_t*)assets_allocate(asset_type_model);
-	result->anim_inst.anim_id = -1;
+	result->proto  = sk_malloc_t(model_proto_t, 1);
+	*result->proto = {};
+	result->proto->refs = 1;
 	return result;
 }
 
@@ -55,26 +68,26 @@ model_t model_copy(model_t model) {
 		return nullptr;
 	}
 
+	// Node names, info and animation data are shared with the original,
+	// only the per-instance state gets copied.
+	atomic_increment(&model->proto->refs);
 	model_t result = (model_t)assets_allocate(asset_type_model);
+	result->proto        = model->proto;
 	result->visuals      = model->visuals.copy();
 	result->nodes        = model->nodes  .copy();
 	result->bounds       = model->bounds;
 	result->nodes_used   = model->nodes_used;
-	result->anim_inst.anim_id = -1;
 	for (int32_t i = 0; i < result->visuals.count; i++) {
 		model_visual_t* vis = &result->visuals[i];
 		if (vis->material) material_addref(vis->material);
 		if (vis->mesh    ) mesh_addref    (vis->mesh);
 	}
-	for (int32_t i = 0; i < result->nodes.count; i++) {
-		result->nodes[i].name = string_copy(result->nodes[i].name);
-	}
 
 	// If the original Model is animating, we want to set this Model up with
 	// the original meshes, not the active, modified meshes.
 	if (model->anim_inst.skinned_meshes != nullptr) {
 		for (int32_t i = 0; i < model->anim_inst.skinned_mesh_count; i++) {
-			model_node_id   node = model->anim_data.skeletons[i].skin_node;
+			model_node_id   node = model->proto->anim_data.skeletons[i].skin_node;
 			model_visual_t* vis  = &result->visuals[result->nodes[node].visual];
 
 			mesh_t old_mesh = vis->mesh;
@@ -83,13 +96,57 @@ model_t model_copy(model_t model) {
 			mesh_release(old_mesh);
 		}
 	}
-	result->anim_data = anim_data_copy(&model->anim_data);
 
 	return result;
 }
 
 ///////////////////////////////////////////
 
+void model_proto_free(model_proto_t *proto, array_t<model_node_t> *nodes) {
+	for (int32_t i = 0; i < nodes->count; i++) {
+		model_node_t *node = &nodes->get(i);
+		node->info.each([](char*& val) { sk_free(val); });
+		node->info.free();
+		sk_free(node->name);
+	}
+	anim_data_destroy(&proto->anim_data);
+	sk_free(proto);
+}
+
+///////////////////////////////////////////
+
+void model_proto_unique(model_t model) {
+	if (model->proto->refs <= 1) return;
+
+	model_proto_t *proto = sk_malloc_t(model_proto_t, 1);
+	*proto = {};
+	proto->refs      = 1;
+	proto->anim_data = anim_data_copy(&model->proto->anim_data);
+
+	// Keep the old strings around until we know whether we were the last one
+	// holding on to them.
+	array_t<model_node_t> old_nodes = model->nodes.copy();
+	for (int32_t i = 0; i < model->nodes.count; i++) {
+		model_node_t *node = &model->nodes[i];
+		dictionary_t<char*> info = {};
+		info.reserve(node->info.count);
+		for (int32_t e = 0; e < node->info.capacity; e++) {
+			if (node->info.has(e))
+				info.set(node->info.items[e].key, string_copy(node->info.items[e].value));
+		}
+		node->info = info;
+		node->name = string_copy(node->name);
+	}
+
+	model_proto_t *old_proto = model->proto;
+	model->proto = proto;
+	if (atomic_decrement(&old_proto->refs) == 0)
+		model_proto_free(old_proto, &old_nodes);
+	old_nodes.free();
+}
+
+///////////////////////////////////////////
+
 model_t model_create_mesh(mesh_t mesh, material_t material) {
 	model_t result = model_create();
 
@@ -101,21 +158,27 @@ model_t model_create_mesh(mesh_t mesh, material_t material) {
 ///////////////////////////////////////////
 
 model_t model_create_mem(const char *filename, const void *data, size_t data_size, shader_t shader) {
+	return model_create_mem_flags(filename, data, data_size, model_import_flags, shader);
+}
+
+///////////////////////////////////////////
+
+model_t model_create_mem_flags(const char *filename, const void *data, size_t data_size, model_import_ import_flags, shader_t shader) {
 	model_t result = model_create();
 	
 	if (string_endswith(filename, ".glb",  false) || 
 		string_endswith(filename, ".gltf", false) ||
 		string_endswith(filename, ".vrm",  false)) {
-		if (!modelfmt_gltf(result, filename, data, data_size, shader))
+		if (!modelfmt_gltf(result, filename, data, data_size, shader, import_flags))
 			log_errf("Issue loading GLTF file: %s!", filename);
 	} else if (string_endswith(filename, ".obj", false)) {
-		if (!modelfmt_obj (result, filename, data, data_size, shader))
+		if (!modelfmt_obj (result, filename, data, data_size, shader, import_flags))
 			log_errf("Issue loading Wavefront OBJ file: %s!", filename);
 	} else if (string_endswith(filename, ".stl", false)) {
-		if (!modelfmt_stl (result, filename, data, data_size, shader))
+		if (!modelfmt_stl (result, filename, data, data_size, shader, import_flags))
 			log_errf("Issue loading STL file: %s!", filename);
 	} else if (string_endswith(filename, ".ply", false)) {
-		if (!modelfmt_ply (result, filename, data, data_size, shader))
+		if (!modelfmt_ply (result, filename, data, data_size, shader, import_flags))
 			log_errf("Issue loading PLY file: %s!", filename);
 	} else {
 		log_errf("Issue loading %s! Unrecognized file extension.", filename);
@@ -127,7 +190,16 @@ model_t model_create_mem(const char *filename, const void *data, size_t data_siz
 ///////////////////////////////////////////
 
 model_t model_create_file(const char *filename, shader_t shader) {
-	model_t result = model_find(filename);
+	return model_create_file_flags(filename, model_import_flags, shader);
+}
+
+///////////////////////////////////////////
+
+model_t model_create_file_flags(const char *filename, model_import_ import_flags, shader_t shader) {
+	char id[512];
+	snprintf(id, sizeof(id), "%s", filename);
+	modelfmt_id_flags(id, sizeof(id), import_flags);
+	model_t result = model_find(id);
 	if (result != nullptr)
 		return result;
 
@@ -139,9 +211,9 @@ model_t model_create_file(const char *filename, shader_t shader) {
 		return nullptr;
 	}
 
-	result = model_create_mem(filename, data, length, shader);
+	result = model_create_mem_flags(filename, data, length, import_flags, shader);
 	if (result != nullptr) {
-		model_set_id(result, filename);
+		model_set_id(result, id);
 	}
 	
 	sk_free(data);
@@ -150,6 +222,74 @@ model_t model_create_file(const char *filename, shader_t shader) {
 
 ///////////////////////////////////////////
 
+void model_set_import_flags(model_import_ import_flags) {
+	model_import_flags = import_flags;
+}
+
+///////////////////////////////////////////
+
+model_import_ model_get_import_flags() {
+	return model_import_flags;
+}
+
+///////////////////////////////////////////
+
+// Import flags change what gets loaded, so assets made with them get the
+// flags in their id. This keeps them from being found and shared with a
+// load of the same file that used different flags. Unflagged ids stay
+// as they always were.
+void modelfmt_id_flags(char *id, size_t id_size, model_import_ flags) {
+	if (flags == model_import_none) return;
+
+	size_t len = strlen(id);
+	if (len < id_size)
+		snprintf(id + len, id_size - len, "/import/%u", (uint32_t)flags);
+}
+
+///////////////////////////////////////////
+
+mesh_t modelfmt_create_mesh(const char *id, const vert_t *verts, int32_t vert_count, const vind_t *inds, int32_t ind_count, model_import_ flags) {
+	mesh_t result = mesh_create();
+	mesh_set_id(result, id);
+
+	if ((flags & model_import_optimize) && ind_count >= 3) {
+		// Merge identical vertices first, file formats like STL don't share
+		// any at all.
+		uint32_t *remap          = sk_malloc_t(uint32_t, vert_count);
+		size_t    opt_vert_count = meshopt_generateVertexRemap(remap, inds, ind_count, verts, vert_count, sizeof(vert_t));
+		vert_t   *opt_verts      = sk_malloc_t(vert_t, opt_vert_count);
+		vind_t   *opt_inds       = sk_malloc_t(vind_t, ind_count);
+		meshopt_remapIndexBuffer   (opt_inds,  inds,  ind_count,  remap);
+		meshopt_remapVertexBuffer  (opt_verts, verts, vert_count, sizeof(vert_t), remap);
+
+		// Then order triangles for the post-transform cache, re-order them
+		// to reduce overdraw where that doesn't cost too much cache
+		// efficiency, and finally lay the vertices out in the order they
+		// get used.
+		meshopt_optimizeVertexCache(opt_inds,  opt_inds, ind_count, opt_vert_count);
+		meshopt_optimizeOverdraw   (opt_inds,  opt_inds, ind_count, &opt_verts[0].pos.x, opt_vert_count, sizeof(vert_t), 1.05f);
+		meshopt_optimizeVertexFetch(opt_verts, opt_inds, ind_count, opt_verts, opt_vert_count, sizeof(vert_t));
+
+		mesh_set_data(result, opt_verts, (int32_t)opt_vert_count, opt_inds, ind_count);
+		sk_free(remap);
+		sk_free(opt_verts);
+		sk_free(opt_inds);
+	} else {
+		mesh_set_data(result, verts, vert_count, inds, ind_count);
+	}
+
+	// Clusters re-order triangles, which would invalidate any LODs, so
+	// they're built first.
+	if ((flags & model_import_clusters) && ind_count >= model_import_cluster_min_inds)
+		mesh_build_clusters(result);
+	if ((flags & model_import_lods) && ind_count >= 3)
+		mesh_generate_lods(result);
+
+	return result;
+}
+
+///////////////////////////////////////////
+
 void model_recalculate_bounds(model_t model) {
 	model->bounds_dirty = false;
 
@@ -476,11 +616,8 @@ bool32_t model_ray_intersect_bvh_detailed(model_t model, ray_t model_space_ray,
 
 void model_destroy(model_t model) {
 	anim_inst_destroy(&model->anim_inst);
-	anim_data_destroy(&model->anim_data);
-	for (int32_t i = 0; i < model->nodes.count; i++) {
-		sk_free(model->nodes[i].name);
-		model_node_info_clear(model, i);
-	}
+	if (model->proto != nullptr && atomic_decrement(&model->proto->refs) == 0)
+		model_proto_free(model->proto, &model->nodes);
 	for (int32_t i = 0; i < model->visuals.count; i++) {
 		mesh_release    (model->visuals[i].mesh);
 		material_release(model->visuals[i].material);
@@ -499,6 +636,8 @@ model_node_id model_node_add(model_t model, const char *name, matrix transform,
 ///////////////////////////////////////////
 
 model_node_id model_node_add_child(model_t model, model_node_id parent, const char *name, matrix local_transform, mesh_t mesh, material_t material, bool32_t solid) {
+	model_proto_unique(model);
+
 	model_node_id node_id = (model_node_id)model->nodes.count;
 	char          tmp_name[32];
 	if (name == nullptr) {
@@ -703,6 +842,7 @@ matrix model_node_get_transform_local(model_t model, model_node_id node) {
 ///////////////////////////////////////////
 
 void model_node_set_name(model_t model, model_node_id node, const char* name) {
+	model_proto_unique(model);
 	sk_free(model->nodes[node].name);
 	char tmp_name[32];
 	if (name == nullptr) {
@@ -798,8 +938,9 @@ void model_node_set_transform_model(model_t model, model_node_id node, matrix tr
 		_model_node_update_transforms(model, curr);
 		curr = model->nodes[curr].sibling;
 	}
-	model->transforms_changed = true;
-	model->bounds_dirty       = true;
+	model->transforms_changed    = true;
+	model->bounds_dirty          = true;
+	model->anim_inst.pose_edited = model->anim_inst.layers.count > 0;
 }
 
 ///////////////////////////////////////////
@@ -807,8 +948,9 @@ void model_node_set_transform_model(model_t model, model_node_id node, matrix tr
 void model_node_set_transform_local(model_t model, model_node_id node, matrix transform_local_space) {
 	model->nodes[node].transform_local = transform_local_space;
 	_model_node_update_transforms(model, node);
-	model->transforms_changed = true;
-	model->bounds_dirty       = true;
+	model->transforms_changed    = true;
+	model->bounds_dirty          = true;
+	model->anim_inst.pose_edited = model->anim_inst.layers.count > 0;
 }
 
 ///////////////////////////////////////////
@@ -828,6 +970,7 @@ void model_node_info_set(model_t model, model_node_id node, const char* info_key
 		return;
 	}
 
+	model_proto_unique(model);
 	dictionary_t<char*>* info = &model->nodes[node].info;
 	int32_t              at   = info->contains(info_key_u8);
 	if (at != -1) {
@@ -844,6 +987,9 @@ bool32_t model_node_info_remove(model_t model, model_node_id node, const char* i
 	int32_t idx = model->nodes[node].info.contains(info_key_u8);
 	if (idx < 0) return false;
 
+	model_proto_unique(model);
+	idx = model->nodes[node].info.contains(info_key_u8);
+
 	sk_free(model->nodes[node].info.items[idx].value);
 	model->nodes[node].info.remove_at(idx);
 
@@ -853,6 +999,7 @@ bool32_t model_node_info_remove(model_t model, model_node_id node, const char* i
 ///////////////////////////////////////////
 
 void model_node_info_clear(model_t model, model_node_id node) {
+	model_proto_unique(model);
 	model->nodes[node].info.each([](char*& val) { sk_free(val); });
 	model->nodes[node].info.free();
 }
@@ -869,7 +1016,7 @@ bool32_t model_node_info_iterate(model_t model, model_node_id node, int32_t* ref
 	dictionary_t<char*> *info = &model->nodes[node].info;
 
 	if (*ref_iterator >= info->capacity) return false;
-	while (info->items[*ref_iterator].hash == 0) {
+	while (!info->has(*ref_iterator)) {
 		*ref_iterator = *ref_iterator + 1;
 		if (*ref_iterator >= info->capacity) return false;
 	}
@@ -904,31 +1051,64 @@ void model_play_anim_idx(model_t model, int32_t index, anim_mode_ mode) {
 
 ///////////////////////////////////////////
 
+void model_play_anim_crossfade(model_t model, int32_t index, anim_mode_ mode, float fade_seconds, int32_t layer) {
+	anim_inst_crossfade(model, layer, index, mode, fade_seconds);
+}
+
+///////////////////////////////////////////
+
+void model_play_anim_blend(model_t model, int32_t index, anim_mode_ mode, float weight, float fade_seconds, int32_t layer) {
+	anim_inst_blend(model, layer, index, mode, weight, fade_seconds);
+}
+
+///////////////////////////////////////////
+
+void model_stop_anim(model_t model, float fade_seconds, int32_t layer) {
+	anim_inst_stop(model, layer, fade_seconds);
+}
+
+///////////////////////////////////////////
+
+void model_anim_layer_set(model_t model, int32_t layer, anim_blend_ blend, float weight) {
+	anim_inst_layer_set(model, layer, blend, weight);
+}
+
+///////////////////////////////////////////
+
+void model_anim_layer_set_mask(model_t model, int32_t layer, model_node_id node, float weight, bool32_t include_children) {
+	anim_inst_layer_mask(model, layer, node, weight, include_children);
+}
+
+///////////////////////////////////////////
+
 void model_set_anim_time(model_t model, float time) {
-	if (model->anim_inst.anim_id < 0)
+	anim_clip_t *clip = anim_inst_primary(&model->anim_inst);
+	if (clip == nullptr)
 		return;
 
-	if (model->anim_inst.mode == anim_mode_manual) {
-		float max_time = model->anim_data.anims[model->anim_inst.anim_id].duration;
-		model->anim_inst.start_time = fmaxf(0, fminf(time, max_time));
+	if (clip->mode == anim_mode_manual) {
+		float max_time = model->proto->anim_data.anims[clip->anim_id].duration;
+		clip->start_time = fmaxf(0, fminf(time, max_time));
 	} else {
-		model->anim_inst.start_time = time_totalf() - time;
+		clip->start_time = time_totalf() - time;
 	}
+	model->anim_inst.dirty = true;
 }
 
 ///////////////////////////////////////////
 
 void model_set_anim_completion(model_t model, float percent) {
-	if (model->anim_inst.anim_id < 0)
+	anim_clip_t *clip = anim_inst_primary(&model->anim_inst);
+	if (clip == nullptr)
 		return;
-	model_set_anim_time(model, model->anim_data.anims[model->anim_inst.anim_id].duration * percent);
+	model_set_anim_time(model, model->proto->anim_data.anims[clip->anim_id].duration * percent);
 }
 
 ///////////////////////////////////////////
 
 int32_t model_anim_find(model_t model, const char *animation_name) {
-	for (int32_t i = 0; i < model->anim_data.anims.count; i++)
-		if (string_eq(model->anim_data.anims[i].name, animation_name))
+	for (int32_t i = 0; i < model->proto->anim_data.anims.count; i++)
+		if (string_eq(model->proto->anim_data.anims[i].name, animation_name))
 			return i;
 	return -1;
 }
@@ -936,56 +1116,53 @@ int32_t model_anim_find(model_t model, const char *animation_name) {
 ///////////////////////////////////////////
 
 int32_t model_anim_count(model_t model) {
-	return model->anim_data.anims.count;
+	return model->proto->anim_data.anims.count;
 }
 
 ///////////////////////////////////////////
 
 int32_t model_anim_active(model_t model) {
-	return model->anim_inst.anim_id;
+	anim_clip_t *clip = anim_inst_primary(&model->anim_inst);
+	return clip ? clip->anim_id : -1;
 }
 
 ///////////////////////////////////////////
 
 anim_mode_ model_anim_active_mode(model_t model) {
-	return model->anim_inst.mode;
+	anim_clip_t *clip = anim_inst_primary(&model->anim_inst);
+	return clip ? clip->mode : anim_mode_loop;
 }
 
 ///////////////////////////////////////////
 
 float model_anim_active_time(model_t model) {
-	if (model->anim_inst.anim_id < 0)
+	anim_clip_t *clip = anim_inst_primary(&model->anim_inst);
+	if (clip == nullptr)
 		return 0;
-
-	float max_time = model->anim_data.anims[model->anim_inst.anim_id].duration;
-	switch (model->anim_inst.mode) {
-	case anim_mode_manual: return fminf(                model->anim_inst.start_time, max_time);
-	case anim_mode_once:   return fminf(time_totalf() - model->anim_inst.start_time, max_time);
-	case anim_mode_loop:   return fmodf(time_totalf() - model->anim_inst.start_time, max_time);
-	default:               return 0;
-	}
+	return anim_clip_time(&model->proto->anim_data, clip);
 }
 
 ///////////////////////////////////////////
 
 float model_anim_active_completion(model_t model) {
-	if (model->anim_inst.anim_id < 0)
+	anim_clip_t *clip = anim_inst_primary(&model->anim_inst);
+	if (clip == nullptr)
 		return 0;
-	return model_anim_active_time(model) / model->anim_data.anims[model->anim_inst.anim_id].duration;
+	return anim_clip_time(&model->proto->anim_data, clip) / model->proto->anim_data.anims[clip->anim_id].duration;
 }
 
 ///////////////////////////////////////////
 
 const char *model_anim_get_name(model_t model, int32_t index) {
-	assert(index < model->anim_data.anims.count);
-	return model->anim_data.anims[index].name;
+	assert(index < model->proto->anim_data.anims.count);
+	return model->proto->anim_data.anims[index].name;
 }
 
 ///////////////////////////////////////////
 
 float model_anim_get_duration(model_t model, int32_t index) {
-	assert(index < model->anim_data.anims.count);
-	return model->anim_data.anims[index].duration;
+	assert(index < model->proto->anim_data.anims.count);
+	return model->proto->anim_data.anims[index].duration;
 }
 
 } // namespace sk
@@ -27,22 +27,34 @@ struct model_node_t {
 	dictionary_t<char*> info;
 };
 
+// The parts of a Model that copies don't change: animation curves, skeleton
+// maps, and the node name and info strings. model_copy shares these between
+// copies by reference, and a Model makes its own unique copy before it edits
+// any of them. Node names and info live in each Model's node list, but are
+// owned by the prototype, so only its last user frees them.
+struct model_proto_t {
+	volatile int32_t refs;
+	anim_data_t      anim_data;
+};
+
 struct _model_t {
 	asset_header_t          header;
 	array_t<model_visual_t> visuals;
 	array_t<model_node_t>   nodes;
 	int32_t                 nodes_used;
 	bool32_t                transforms_changed;
-	anim_data_t             anim_data;
+	model_proto_t          *proto;
 	anim_inst_t             anim_inst;
 	bounds_t                bounds;
 	bool32_t                bounds_dirty;
 };
 
-bool modelfmt_obj (model_t model, const char *filename, const void *file_data, size_t file_size, shader_t shader);
-bool modelfmt_gltf(model_t model, const char *filename, const void *file_data, size_t file_size, shader_t shader);
-bool modelfmt_stl (model_t model, const char *filename, const void *file_data, size_t file_size, shader_t shader);
-bool modelfmt_ply (model_t model, const char *filename, const void *file_data, size_t file_size, shader_t shader);
+bool   modelfmt_obj        (model_t model, const char *filename, const void *file_data, size_t file_size, shader_t shader, model_import_ flags);
+bool   modelfmt_gltf       (model_t model, const char *filename, const void *file_data, size_t file_size, shader_t shader, model_import_ flags);
+bool   modelfmt_stl        (model_t model, const char *filename, const void *file_data, size_t file_size, shader_t shader, model_import_ flags);
+bool   modelfmt_ply        (model_t model, const char *filename, const void *file_data, size_t file_size, shader_t shader, model_import_ flags);
+mesh_t modelfmt_create_mesh(const char *id, const vert_t *verts, int32_t vert_count, const vind_t *inds, int32_t ind_count, model_import_ flags);
+void   modelfmt_id_flags   (char *id, size_t id_size, model_import_ flags);
 void model_destroy(model_t model);
 
 } // namespace sk
@@ -295,7 +295,7 @@ void gltf_view_to_vert_f(void* destination_buffer, size_t dest_step, size_t vert
 
 ///////////////////////////////////////////
 
-mesh_t gltf_parsemesh(cgltf_mesh *mesh, int node_id, int primitive_id, const char *filename, array_t<const char *> *warnings) {
+mesh_t gltf_parsemesh(cgltf_mesh *mesh, int node_id, int primitive_id, const char *filename, model_import_ flags, array_t<const char *> *warnings) {
 	cgltf_mesh      *m = mesh;
 	cgltf_primitive *p = &m->primitives[primitive_id];
 
@@ -310,6 +310,7 @@ mesh_t gltf_parsemesh(cgltf_mesh *mesh, int node_id, int primitive_id, const cha
 
 	char id[512];
 	snprintf(id, sizeof(id), "%s/mesh/%d_%d_%s", filename, node_id, primitive_id, m->name);
+	modelfmt_id_flags(id, sizeof(id), flags);
 	mesh_t result = mesh_find(id);
 	if (result != nullptr) {
 		return result;
@@ -437,26 +438,7 @@ mesh_t gltf_parsemesh(cgltf_mesh *mesh, int node_id, int primitive_id, const cha
 		mesh_calculate_normals(verts, vert_count, inds, (int32_t)ind_count);
 	}
 
-	/*uint32_t* remap = sk_malloc_t(uint32_t, vert_count);
-	size_t    final_vertex_count = meshopt_generateVertexRemap(remap, inds, ind_count, verts, vert_count, sizeof(vert_t));
-	vert_t*   final_verts        = sk_malloc_t(vert_t, final_vertex_count);
-
-	meshopt_remapIndexBuffer   (inds, inds, ind_count, &remap[0]);
-	meshopt_remapVertexBuffer  (final_verts, &verts[0], vert_count, sizeof(vert_t), &remap[0]);
-	meshopt_optimizeVertexCache(inds, inds, ind_count, final_vertex_count);
-	meshopt_optimizeOverdraw   (inds, inds, ind_count, &final_verts[0].pos.x, final_vertex_count, sizeof(vert_t), 1.05f);
-	meshopt_optimizeVertexFetch(final_verts, inds, ind_count, final_verts,    final_vertex_count, sizeof(vert_t));
-	
-	result = mesh_create();
-	mesh_set_data(result, final_verts, final_vertex_count, inds, (int32_t)ind_count);
-
-	sk_free(final_verts);
-	sk_free(remap);
-	*/
-
-	result = mesh_create();
-	mesh_set_data(result, verts, vert_count, inds, (int32_t)ind_count);
-	mesh_set_id  (result, id);
+	result = modelfmt_create_mesh(id, verts, vert_count, inds, (int32_t)ind_count, flags);
 	sk_free(verts);
 	sk_free(inds );
 
@@ -805,6 +787,7 @@ anim_t gltf_parseanim(const cgltf_animation *anim, hashmap_t<cgltf_node*, model_
 
 		result.curves.add(curve);
 	}
+	anim_finalize(&result);
 
 	return result;
 }
@@ -840,16 +823,20 @@ int32_t gltf_node_index(cgltf_data *data, cgltf_node *node) {
 
 ///////////////////////////////////////////
 
-void gltf_add_node(model_t model, shader_t shader, model_node_id parent, const char *filename, cgltf_data *data, cgltf_node *node, hashmap_t<cgltf_node*, model_node_id> *node_map, array_t<const char *> *warnings) {
+void gltf_add_node(model_t model, shader_t shader, model_import_ flags, model_node_id parent, const char *filename, cgltf_data *data, cgltf_node *node, hashmap_t<cgltf_node*, model_node_id> *node_map, array_t<const char *> *warnings) {
 	int32_t       index   = (int32_t)(node - data->nodes);
 	model_node_id node_id = -1;
 
+	// Skin data is read in the file's vertex order after the mesh is made,
+	// so skinned meshes can't be re-ordered or simplified.
+	model_import_ mesh_flags = node->skin ? model_import_none : flags;
+
 	matrix transform = gltf_build_node_matrix(node);
 	if (parent == -1)
 		transform = transform * gltf_orientation_correction;
 
 	for (cgltf_size p = 0; node->mesh && p < node->mesh->primitives_count; p++) {
-		mesh_t mesh = gltf_parsemesh(node->mesh, index, (int)p, filename, warnings);
+		mesh_t mesh = gltf_parsemesh(node->mesh, index, (int)p, filename, mesh_flags, warnings);
 		if (mesh == nullptr) continue;
 
 		// If we're splitting this node into multiple meshes, then add the
@@ -884,13 +871,13 @@ void gltf_add_node(model_t model, shader_t shader, model_node_id parent, const c
 	}
 
 	for (size_t i = 0; i < node->children_count; i++) {
-		gltf_add_node(model, shader, node_id, filename, data, node->children[i], node_map, warnings);
+		gltf_add_node(model, shader, flags, node_id, filename, data, node->children[i], node_map, warnings);
 	}
 }
 
 ///////////////////////////////////////////
 
-bool modelfmt_gltf(model_t model, const char *filename, const void *file_data, size_t file_size, shader_t shader) {
+bool modelfmt_gltf(model_t model, const char *filename, const void *file_data, size_t file_size, shader_t shader, model_import_ flags) {
 	cgltf_options options = {};
 	options.file.read = [](const struct cgltf_memory_options*, const struct cgltf_file_options*, const char* path, cgltf_size* size, void** data) {
 		return platform_read_file_direct(path, data, size)
@@ -930,12 +917,12 @@ bool modelfmt_gltf(model_t model, const char *filename, const void *file_data, s
 	for (cgltf_size i = 0; i < data->nodes_count; i++) {
 		cgltf_node *n = &data->nodes[i];
 		if (n->parent == nullptr)
-			gltf_add_node(model, shader, -1, filename, data, n, &node_map, &warnings);
+			gltf_add_node(model, shader, flags, -1, filename, data, n, &node_map, &warnings);
 	}
 
 	// Load each animation
 	for (cgltf_size i = 0; i < data->animations_count; i++) {
-		model->anim_data.anims.add( gltf_parseanim(&data->animations[i], &node_map) );
+		model->proto->anim_data.anims.add( gltf_parseanim(&data->animations[i], &node_map) );
 	}
 
 	// Load all the skeletons/skins
@@ -953,7 +940,7 @@ bool modelfmt_gltf(model_t model, const char *filename, const void *file_data, s
 			for (int32_t b = 0; b < skel.bone_count; b++) {
 				skel.bone_to_node_map[b] = *node_map.get(skin->joints[b]);
 			}
-			model->anim_data.skeletons.add(skel);
+			model->proto->anim_data.skeletons.add(skel);
 		}
 	}
 
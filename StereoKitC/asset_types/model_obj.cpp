@@ -28,10 +28,11 @@ int indexof(int iV, int iT, int iN, array_t<vec3> *verts, array_t<vec3> *norms,
 
 ///////////////////////////////////////////
 
-bool modelfmt_obj(model_t model, const char *filename, const void *file_data, size_t, shader_t shader) {
+bool modelfmt_obj(model_t model, const char *filename, const void *file_data, size_t, shader_t shader, model_import_ flags) {
 	material_t material = shader == nullptr ? material_find(default_id_material) : material_create(shader);
 	char id[512];
 	snprintf(id, sizeof(id), "%s/mesh", filename);
+	modelfmt_id_flags(id, sizeof(id), flags);
 	mesh_t mesh = mesh_find(id);
 
 	if (mesh) {
@@ -105,9 +106,7 @@ bool modelfmt_obj(model_t model, const char *filename, const void *file_data, si
 	if (norms.count <= 0)
 		mesh_calculate_normals(&verts[0], verts.count, &faces[0], faces.count);
 
-	mesh = mesh_create();
-	mesh_set_id  (mesh, id);
-	mesh_set_data(mesh, &verts[0], verts.count, &faces[0], faces.count);
+	mesh = modelfmt_create_mesh(id, &verts[0], verts.count, &faces[0], faces.count, flags);
 
 	model_add_subset(model, mesh, material, matrix_identity);
 
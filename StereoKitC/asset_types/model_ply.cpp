@@ -11,12 +11,13 @@ namespace sk {
 
 ///////////////////////////////////////////
 
-bool modelfmt_ply(model_t model, const char *filename, const void *file_data, size_t file_length, shader_t shader) {
+bool modelfmt_ply(model_t model, const char *filename, const void *file_data, size_t file_length, shader_t shader, model_import_ flags) {
 	material_t material = shader == nullptr ? material_find(default_id_material) : material_create(shader);
 	bool       result   = true;
 
 	char id[512];
 	snprintf(id, sizeof(id), "%s/mesh", filename);
+	modelfmt_id_flags(id, sizeof(id), flags);
 	mesh_t mesh = mesh_find(id);
 
 	if (mesh) {
@@ -69,17 +70,18 @@ bool modelfmt_ply(model_t model, const char *filename, const void *file_data, si
 
 		// SK doesn't work well with zero face meshes, but PLYs often have
 		// point clouds, and we want to provide data for that.
+		// Optimizing would merge away every point that isn't used by the
+		// placeholder triangle, so that's skipped too.
 		vind_t* final_inds = inds;
 		vind_t  ind_tmp[] = { 0,0,0 };
 		if (ind_count == 0) {
 			final_inds = ind_tmp;
 			ind_count  = 3;
+			flags      = model_import_none;
 		}
 
 		// Make a mesh out of it all
-		mesh = mesh_create();
-		mesh_set_id  (mesh, id);
-		mesh_set_data(mesh, verts, vert_count, final_inds, ind_count);
+		mesh = modelfmt_create_mesh(id, verts, vert_count, final_inds, ind_count, flags);
 
 		model_add_subset(model, mesh, material, matrix_identity);
 
@@ -21,6 +21,17 @@ struct stl_triangle_t {
 
 ///////////////////////////////////////////
 
+// The header's triangle count comes straight from the file, so don't trust
+// it past what the file can actually hold.
+uint32_t stl_binary_tri_count(const void *file_data, size_t file_size) {
+	if (file_size < sizeof(stl_header_t)) return 0;
+	stl_header_t *header = (stl_header_t *)file_data;
+	size_t        max    = (file_size - sizeof(stl_header_t)) / sizeof(stl_triangle_t);
+	return header->tri_count < max ? header->tri_count : (uint32_t)max;
+}
+
+///////////////////////////////////////////
+
 vind_t indexof(vec3 pt, vec3 normal, array_t<vert_t> *verts, hashmap_t<vec3, vind_t> *indmap) {
 	vind_t  result = 0;
 	int32_t id     = indmap->contains(pt);
@@ -36,12 +47,18 @@ vind_t indexof(vec3 pt, vec3 normal, array_t<vert_t> *verts, hashmap_t<vec3, vin
 
 ///////////////////////////////////////////
 
-bool modelfmt_stl_binary_smooth(const void *file_data, size_t, array_t<vert_t> *verts, array_t<vind_t> *faces) {
-	stl_header_t *header = (stl_header_t *)file_data;
+bool modelfmt_stl_binary_smooth(const void *file_data, size_t file_size, array_t<vert_t> *verts, array_t<vind_t> *faces) {
+	uint32_t tri_count = stl_binary_tri_count(file_data, file_size);
+	if (tri_count == 0) return false;
+
 	hashmap_t<vec3, vind_t> indmap = {};
+	// Closed meshes share each vertex between ~6 triangles, so they end up
+	// with about half as many vertices as triangles.
+	indmap.reserve((int32_t)(tri_count / 2));
+	faces->resize(faces->count + (int32_t)tri_count * 3);
 
 	stl_triangle_t *tris = (stl_triangle_t *)(((uint8_t *)file_data) + sizeof(stl_header_t));
-	for (uint32_t i = 0; i < header->tri_count; i++) {
+	for (uint32_t i = 0; i < tri_count; i++) {
 		faces->add(indexof(tris[i].verts[0], tris[i].normal, verts, &indmap));
 		faces->add(indexof(tris[i].verts[1], tris[i].normal, verts, &indmap));
 		faces->add(indexof(tris[i].verts[2], tris[i].normal, verts, &indmap));
@@ -98,13 +115,15 @@ bool modelfmt_stl_text_smooth(const void *file_data, size_t, array_t<vert_t> *ve
 
 ///////////////////////////////////////////
 
-bool modelfmt_stl_binary_flat(const void *file_data, size_t, array_t<vert_t> *verts, array_t<vind_t> *faces) {
-	stl_header_t   *header = (stl_header_t *)file_data;
-	stl_triangle_t *tris   = (stl_triangle_t *)(((uint8_t *)file_data) + sizeof(stl_header_t));
+bool modelfmt_stl_binary_flat(const void *file_data, size_t file_size, array_t<vert_t> *verts, array_t<vind_t> *faces) {
+	uint32_t tri_count = stl_binary_tri_count(file_data, file_size);
+	if (tri_count == 0) return false;
+
+	stl_triangle_t *tris = (stl_triangle_t *)(((uint8_t *)file_data) + sizeof(stl_header_t));
 
-	verts->resize(header->tri_count * 3);
-	faces->resize(header->tri_count * 3);
-	for (uint32_t i = 0; i < header->tri_count; i++) {
+	verts->resize(tri_count * 3);
+	faces->resize(tri_count * 3);
+	for (uint32_t i = 0; i < tri_count; i++) {
 		vind_t ind1 = (vind_t)verts->add(vert_t{ tris[i].verts[0], tris[i].normal, {}, {255,255,255,255} });
 		vind_t ind2 = (vind_t)verts->add(vert_t{ tris[i].verts[1], tris[i].normal, {}, {255,255,255,255} });
 		vind_t ind3 = (vind_t)verts->add(vert_t{ tris[i].verts[2], tris[i].normal, {}, {255,255,255,255} });
@@ -165,12 +184,13 @@ bool modelfmt_stl_text_flat(const void *file_data, size_t, array_t<vert_t> *vert
 
 ///////////////////////////////////////////
 
-bool modelfmt_stl(model_t model, const char *filename, const void *file_data, size_t file_length, shader_t shader) {
+bool modelfmt_stl(model_t model, const char *filename, const void *file_data, size_t file_length, shader_t shader, model_import_ flags) {
 	material_t material = shader == nullptr ? material_find(default_id_material) : material_create(shader);
 	bool       result   = true;
 
 	char id[512];
 	snprintf(id, sizeof(id), "%s/mesh", filename);
+	modelfmt_id_flags(id, sizeof(id), flags);
 	mesh_t mesh = mesh_find(id);
 
 	if (mesh) {
@@ -187,9 +207,7 @@ bool modelfmt_stl(model_t model, const char *filename, const void *file_data, si
 		for (int32_t i = 0; i < verts.count; i++)
 			verts[i].norm = vec3_normalize(verts[i].norm);
 
-		mesh = mesh_create();
-		mesh_set_id  (mesh, id);
-		mesh_set_data(mesh, &verts[0], verts.count, &faces[0], faces.count);
+		mesh = modelfmt_create_mesh(id, &verts[0], verts.count, &faces[0], faces.count, flags);
 
 		model_add_subset(model, mesh, material, matrix_identity);
 
@@ -2,6 +2,7 @@
 #include "../sk_memory.h"
 #include "../platforms/platform.h"
 #include "../libraries/stref.h"
+#include "../libraries/atomic_util.h"
 #include "shader.h"
 #include "assets.h"
 
@@ -9,6 +10,8 @@
 
 namespace sk {
 
+volatile int32_t shader_generation = 0;
+
 void shader_update_label(shader_t shader);
 
 ///////////////////////////////////////////
@@ -84,7 +87,8 @@ shader_t shader_create_mem(void *data, size_t data_size) {
 	}
 
 	shader_t result = (shader_t)assets_allocate(asset_type_shader);
-	result->shader = shader;
+	result->shader     = shader;
+	result->generation = (uint32_t)atomic_increment(&shader_generation);
 
 	return result;
 }
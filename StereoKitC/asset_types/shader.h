@@ -11,6 +11,9 @@ extern const size_t shaderarg_sz[];
 struct _shader_t {
 	asset_header_t header;
 	skg_shader_t   shader;
+	// Unique to each shader ever created, material_param_handle_t uses
+	// this to know when its cached lookup is stale. Never 0.
+	uint32_t       generation;
 };
 
 void shader_destroy(shader_t shader);
@@ -71,7 +71,7 @@ sound_t sound_create_stream(float buffer_duration) {
 	result->type      = sound_type_stream;
 	result->data_lock = ft_mutex_create();
 	result->buffer.capacity = (uint64_t)((double)buffer_duration * AU_SAMPLE_RATE);
-	result->buffer.data     = sk_malloc_t(float, (size_t)result->buffer.capacity);
+	result->buffer.data     = sk_malloc_tag_t(memory_tag_audio, float, (size_t)result->buffer.capacity);
 	memset(result->buffer.data, 0, (size_t)(result->buffer.capacity * sizeof(float)));
 	ma_pcm_rb_init(AU_SAMPLE_FORMAT, 1, (ma_uint32)result->buffer.capacity, result->buffer.data, nullptr, &result->stream_buffer);
 
@@ -86,7 +86,7 @@ sound_t sound_create_samples(const float *samples_at_48000s, uint64_t sample_cou
 	result->type = sound_type_buffer;
 	result->buffer.capacity = sample_count;
 	result->buffer.count    = sample_count;
-	result->buffer.data     = sk_malloc_t(float, (size_t)sample_count);
+	result->buffer.data     = sk_malloc_tag_t(memory_tag_audio, float, (size_t)sample_count);
 	memcpy(result->buffer.data, samples_at_48000s, (size_t)(sample_count * sizeof(float)));
 
 	return result;
@@ -100,7 +100,7 @@ sound_t sound_generate(float (*function)(float sample_time), float duration) {
 	result->type = sound_type_buffer;
 	result->buffer.capacity = (uint64_t)((double)duration * AU_SAMPLE_RATE);
 	result->buffer.count    = result->buffer.capacity;
-	result->buffer.data     = sk_malloc_t(float, (size_t)result->buffer.capacity);
+	result->buffer.data     = sk_malloc_tag_t(memory_tag_audio, float, (size_t)result->buffer.capacity);
 	for (uint64_t i = 0, s = result->buffer.capacity; i < s; i += 1) {
 		result->buffer.data[i] = function((float)i / (float)AU_SAMPLE_RATE);
 	}
@@ -273,7 +273,7 @@ void sound_destroy(sound_t sound) {
 		ma_pcm_rb_uninit(&sound->stream_buffer);
 	}
 	if (sound->buffer.data) {
-		sk_free         ( sound->buffer.data);
+		sk_free_tag     ( sound->buffer.data);
 		ft_mutex_destroy(&sound->data_lock);
 	}
 	memset(sound, 0, sizeof(_sound_t));
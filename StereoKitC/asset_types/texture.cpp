@@ -11,6 +11,7 @@
 #include "../sk_math.h"
 #include "../sk_memory.h"
 #include "../spherical_harmonics.h"
+#include "../systems/render.h"
 #include "texture.h"
 #include "texture_.h"
 #include "texture_compression.h"
@@ -66,12 +67,20 @@ struct tex_load_t {
 
 ///////////////////////////////////////////
 
+void tex_load_free_file(tex_load_t *data, int32_t idx) {
+	if (data->file_data[idx] == nullptr) return;
+	sk_mem_tag_track(memory_tag_texture, -(int64_t)data->file_sizes[idx]);
+	sk_free(data->file_data[idx]);
+}
+
+///////////////////////////////////////////
+
 void tex_load_free(asset_header_t *, void *job_data) {
 	tex_load_t *data = (tex_load_t *)job_data;
 
 	for (int32_t i = 0; i < data->file_count; i++) {
 		if (data->file_names != nullptr) sk_free(data->file_names[i]);
-		if (data->file_data  != nullptr) sk_free(data->file_data [i]);
+		if (data->file_data  != nullptr) tex_load_free_file(data, i);
 		if (data->color_data != nullptr) sk_free(data->color_data[i]);
 	}
 	sk_free(data->file_names);
@@ -87,8 +96,8 @@ bool32_t tex_load_arr_files_shared(asset_task_t* task, asset_header_t* asset, vo
 	tex_load_t* data = (tex_load_t*)job_data;
 	tex_t       tex  = (tex_t)asset;
 
-	data->file_data  = sk_malloc_t(void *, data->file_count);
-	data->file_sizes = sk_malloc_t(size_t, data->file_count);
+	data->file_data  = (void  **)sk_calloc(sizeof(void *) * data->file_count);
+	data->file_sizes = (size_t *)sk_calloc(sizeof(size_t) * data->file_count);
 
 	int32_t     final_width       = 0;
 	int32_t     final_height      = 0;
@@ -105,6 +114,7 @@ bool32_t tex_load_arr_files_shared(asset_task_t* task, asset_header_t* asset, vo
 			tex->header.state = asset_state_error_not_found;
 			return false;
 		}
+		sk_mem_tag_track(memory_tag_texture, (int64_t)data->file_sizes[i]);
 
 		// Grab the image metadata
 		int32_t     curr_width       = 0;
@@ -212,7 +222,7 @@ end:
 
 	// Release file memory now that we're done with it
 	for (int32_t i = 0; i < data->file_count; i++)
-		sk_free(data->file_data[i]);
+		tex_load_free_file(data, i);
 
 	if (tex->header.state >= asset_state_none) {
 		tex->header.state = asset_state_loaded_meta;
@@ -390,6 +400,7 @@ tex_t tex_create_mem_type(tex_type_ type, void *data, size_t data_size, bool32_t
 	load_data->file_sizes[0] = data_size;
 	load_data->file_data [0] = sk_malloc(sizeof(uint8_t) * data_size);
 	memcpy(load_data->file_data[0], data, data_size);
+	sk_mem_tag_track(memory_tag_texture, (int64_t)data_size);
 
 	// Grab the file meta right away since we already have the file data, no
 	// point in delaying that until the task.
@@ -575,81 +586,81 @@ tex_t tex_create_cubemap_file(const char *cubemap_file, bool32_t srgb_data, int3
 			return tex_load_arr_upload(task, asset, job_data);
 		}
 
-		const vec3 up   [6] = { vec3_up, vec3_up, -vec3_forward, vec3_forward, vec3_up, vec3_up };
-		const vec3 fwd  [6] = { {1,0, 0}, {-1,0,0}, {0,-1,0}, {0,1,0}, {0,0,1}, { 0,0,-1} };
-		const vec3 right[6] = { {0,0,-1}, { 0,0,1}, {1, 0,0}, {1,0,0}, {1,0,0}, {-1,0, 0} };
-
 		tex_t equirect = tex_create(tex_type_image_nomips, tex->format);
 		tex_set_color_arr(equirect, data->color_width, data->color_height, data->color_data, data->file_count);
 		tex_set_address  (equirect, tex_address_clamp);
-	
+
 		material_t convert_material = material_find(default_id_material_equirect);
 		material_set_texture(convert_material, "source", equirect);
 
-		tex_t    face         = tex_create(tex_type_rendertarget, equirect->format);
-		void    *face_data[6] = {};
-		size_t   size         = tex_format_size(equirect->format, tex->width, tex->height);
-		tex_set_colors(face, tex->width, tex->height, nullptr);
-		for (int32_t i = 0; i < 6; i++) {
-			material_set_vector4(convert_material, "up",      { up   [i].x, up   [i].y, up   [i].z, 0 });
-			material_set_vector4(convert_material, "right",   { right[i].x, right[i].y, right[i].z, 0 });
-			material_set_vector4(convert_material, "forward", { fwd  [i].x, fwd  [i].y, fwd  [i].z, 0 });
-
-			face_data[i] = sk_malloc(size);
-
-			// Blit conversion _definitely_ needs executed on the GPU thread
-			struct blit_t {
-				tex_t      face;
-				material_t material;
-				void      *face_data;
-				size_t     size;
-			};
-			blit_t blit_data = { face, convert_material, face_data[i], size };
-			assets_execute_gpu([](void *data) {
-				blit_t *blit_data = (blit_t *)data;
-				render_blit (blit_data->face, blit_data->material);
-				tex_get_data(blit_data->face, blit_data->face_data, blit_data->size);
-				return (bool32_t)true;
-			}, &blit_data);
-
+		// The whole conversion stays on the GPU: each face is rendered
+		// directly into a layer of a mipped rendertarget array, mips are
+		// generated there, and the result is copied straight into the final
+		// cubemap. Nothing is read back, so SH lighting is the only thing
+		// that touches the CPU, and tex_get_cubemap_lighting only reads a
+		// small mip when it's asked for.
+		struct convert_t {
+			tex_t      tex;
+			material_t material;
+		};
+		convert_t convert_data = { tex, convert_material };
+		bool32_t  result = assets_execute_gpu([](void *data) {
+			convert_t *convert = (convert_t *)data;
+			tex_t      tex     = convert->tex;
+
+			const vec3 up   [6] = { vec3_up, vec3_up, -vec3_forward, vec3_forward, vec3_up, vec3_up };
+			const vec3 fwd  [6] = { {1,0, 0}, {-1,0,0}, {0,-1,0}, {0,1,0}, {0,0,1}, { 0,0,-1} };
+			const vec3 right[6] = { {0,0,-1}, { 0,0,1}, {1, 0,0}, {1,0,0}, {1,0,0}, {-1,0, 0} };
+
+			int32_t   mip_count = skg_mip_count(tex->width, tex->height);
+			skg_tex_t faces     = skg_tex_create(skg_tex_type_rendertarget, skg_use_static, (skg_tex_fmt_)tex->format, skg_mip_generate);
+			skg_tex_set_contents_arr(&faces, nullptr, 6, mip_count, tex->width, tex->height, 1);
+			if (!skg_tex_is_valid(&faces))
+				return (bool32_t)false;
+
+			skg_tex_t *old_target = skg_tex_target_get();
+			for (int32_t i = 0; i < 6; i++) {
+				// GL rendertargets come out vertically flipped relative to how
+				// cubemap faces are stored, so we flip the face's up axis
+				// instead of flipping rows on the CPU afterwards.
 #if defined(SKG_OPENGL)
-			size_t line_size = tex_format_pitch(equirect->format, tex->width);
-			void*  tmp       = sk_malloc(line_size);
-			for (int32_t y = 0; y < tex->height/2; y++) {
-				void *top_line = ((uint8_t*)face_data[i]) + line_size * y;
-				void *bot_line = ((uint8_t*)face_data[i]) + line_size * ((tex->height-1) - y);
-				memcpy(tmp,      top_line, line_size);
-				memcpy(top_line, bot_line, line_size);
-				memcpy(bot_line, tmp,      line_size);
-			}
-			sk_free(tmp);
+				vec3 face_up = -up[i];
+#else
+				vec3 face_up =  up[i];
 #endif
-		}
+				material_set_vector4(convert->material, "up",      { face_up .x, face_up .y, face_up .z, 0 });
+				material_set_vector4(convert->material, "right",   { right[i].x, right[i].y, right[i].z, 0 });
+				material_set_vector4(convert->material, "forward", { fwd  [i].x, fwd  [i].y, fwd  [i].z, 0 });
+
+				skg_tex_target_bind (&faces, i, 0);
+				render_blit_to_bound(convert->material);
+			}
+			skg_tex_target_bind(old_target, -1, 0);
+			skg_tex_gen_mips   (&faces);
+
+			skg_tex_t cubemap = skg_tex_create(skg_tex_type_cubemap, skg_use_static, (skg_tex_fmt_)tex->format, skg_mip_generate);
+			_tex_set_options        (&cubemap, tex->sample_mode, tex->address_mode, tex->anisotropy);
+			skg_tex_set_contents_arr(&cubemap, nullptr, 6, mip_count, tex->width, tex->height, 1);
+			skg_tex_copy_to         (&faces, -1, &cubemap, -1);
+			skg_tex_destroy         (&faces);
+
+			if (skg_tex_is_valid(&tex->tex))
+				skg_tex_destroy(&tex->tex);
+			tex->tex = cubemap;
+			tex_update_label(tex);
+			return (bool32_t)skg_tex_is_valid(&tex->tex);
+		}, &convert_data);
 
-		tex_release(face);
 		material_release(convert_material);
 		tex_release(equirect);
 
-		// When tex_set_color_arr is called on _mipped_ textures from a non-gpu
-		// thread, it uses the deferred context! This can lead to things
-		// happening out of order when listening to asset_state_loaded, so we
-		// force this call to happen on the GPU thread.
-		struct set_tex_t {
-			tex_t   tex;
-			void**  data;
-		};
-		set_tex_t set_data = {};
-		set_data.tex  = tex;
-		set_data.data = (void**)&face_data;
-		assets_execute_gpu([](void* data) {
-			set_tex_t* set_data = (set_tex_t*)data;
-			tex_set_color_arr(set_data->tex, set_data->tex->width, set_data->tex->height, set_data->data, 6);
-			return (bool32_t)true;
-		}, &set_data);
-		for (int32_t i = 0; i < 6; i++) {
-			sk_free(face_data[i]);
+		if (!result) {
+			tex_set_fallback(tex, tex_error_texture);
+			tex->header.state = asset_state_error;
+			return (bool32_t)false;
 		}
 
+		tex_set_fallback(tex, nullptr);
 		tex->header.state = asset_state_loaded;
 		return (bool32_t)true;
 	};
@@ -997,6 +1008,7 @@ void tex_set_mem(tex_t texture, void* data, size_t data_size, bool32_t srgb_data
 	load_data->file_sizes[0] = data_size;
 	load_data->file_data [0] = sk_malloc(sizeof(uint8_t) * data_size);
 	memcpy(load_data->file_data[0], data, data_size);
+	sk_mem_tag_track(memory_tag_texture, (int64_t)data_size);
 
 	// Grab the file meta right away since we already have the file data, no
 	// point in delaying that until the task.
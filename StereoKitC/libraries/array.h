@@ -71,6 +71,7 @@ Example usage:
 
 #include <stdint.h>
 #include <stdlib.h>
+#include <string.h>
 #include "../sk_memory.h"
 
 //////////////////////////////////////
@@ -134,6 +135,7 @@ struct array_t {
 
 	int32_t     add        (const T &item)              { if (count+1   > capacity) { resize(capacity * 2 < 4         ? 4         : capacity * 2); } data[count] = item; count += 1; return count - 1; }
 	void        add_range  (const T *list, int32_t num) { if (count+num > capacity) { resize(capacity * 2 < count+num ? count+num : capacity * 2); } ARRAY_MEMCPY(&data[count], list, sizeof(T)*num); count += num; }
+	T          *add_empty_range(int32_t num)           { if (count+num > capacity) { resize(capacity * 2 < count+num ? count+num : capacity * 2); } count += num; return &data[count - num]; }
 	void        insert     (int32_t at, const T &item);
 	void        resize     (int32_t to_capacity);
 	void        trim       ()                         { resize(count); }
@@ -256,266 +258,358 @@ struct array_t {
 // hashmap_t                        //
 //////////////////////////////////////
 
-const float   _hashmap_search_dist_pct = 0.001f;
-const int32_t _hashmap_search_dist_min = 3;
+/*
+	hashmap_t is an open addressing hash table in the style of Abseil's
+	SwissTable. Alongside the entries is an array of control bytes, one per
+	slot, holding either a slot state (empty/deleted) or 7 bits of the key's
+	hash. Lookups probe the table a group of 16 control bytes at a time,
+	comparing the whole group against the hash bits in one go, so keys only
+	need compared when their 7 bits already match.
+
+	Slot indices returned by set/contains stay valid until the next insert
+	that grows the table, and full slots can be iterated by walking
+	0..capacity and checking has(i).
+
+	Keys are hashed and compared through a KeyOps type, which defaults to
+	the key's raw bytes. Make your own with the same four static functions
+	for keys that need different treatment, see hashmap_key_string_t.
+*/
 
-template <typename K, typename T>
-struct hashmap_t {
-	struct entry_t {
-		uint64_t hash;
-		K        key;
-		T        value;
-	};
-	entry_t* items;
-	int32_t  count;
-	int32_t  capacity;
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define ARRAY_HASHMAP_SSE2
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__) || defined(_M_ARM64)
+#include <arm_neon.h>
+#define ARRAY_HASHMAP_NEON
+#endif
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
 
-	uint64_t _hash(const K &key) const {
-		uint64_t       hash  = 14695981039346656037UL;
-		const uint8_t *bytes = (const uint8_t *)&key;
-		for (int32_t i=0; i<sizeof(K); i++)
-			hash = (hash ^ bytes[i]) * 1099511628211;
-		return hash;
-	}
+const int32_t _hashmap_group_size = 16;
+const int8_t  _hashmap_empty      = -128; // 0b10000000
+const int8_t  _hashmap_deleted    = -2;   // 0b11111110
 
-	void resize(int32_t size) {
-		if (size < count)
-			size = count;
-		if (size == capacity) return;
-		
-		entry_t* old_items    = items;
-		int32_t  old_capacity = capacity;
-		items    = (entry_t*)ARRAY_MALLOC(sizeof(entry_t) * size);
-		capacity = size;
-		count    = 0;
+//////////////////////////////////////
 
-		memset(items, 0, sizeof(entry_t) * size);
-		for (int32_t i = 0; i < old_capacity; i++) {
-			if (old_items[i].hash == 0) continue;
-			set(old_items[i].key, old_items[i].value);
+// 64x64->128 bit multiply, a and b are replaced with the low and high
+// halves. This is the core of wyhash's mixing.
+inline void _hash_mum(uint64_t *a, uint64_t *b) {
+#if defined(__SIZEOF_INT128__)
+	__uint128_t r = (__uint128_t)*a * *b;
+	*a = (uint64_t)r;
+	*b = (uint64_t)(r >> 64);
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_AMD64))
+	*a = _umul128(*a, *b, b);
+#elif defined(_MSC_VER) && defined(_M_ARM64)
+	uint64_t lo = *a * *b;
+	*b = __umulh(*a, *b);
+	*a = lo;
+#else
+	uint64_t ha = *a >> 32, la = (uint32_t)*a;
+	uint64_t hb = *b >> 32, lb = (uint32_t)*b;
+	uint64_t rh = ha * hb, rm0 = ha * lb, rm1 = hb * la, rl = la * lb;
+	uint64_t t  = rl + (rm0 << 32);
+	uint64_t c  = t < rl;
+	uint64_t lo = t + (rm1 << 32);
+	c += lo < t;
+	*a = lo;
+	*b = rh + (rm0 >> 32) + (rm1 >> 32) + c;
+#endif
+}
+inline uint64_t _hash_mix(uint64_t a, uint64_t b) { _hash_mum(&a, &b); return a ^ b; }
+inline uint64_t _hash_read64(const uint8_t *p) { uint64_t v; ARRAY_MEMCPY(&v, p, 8); return v; }
+inline uint64_t _hash_read32(const uint8_t *p) { uint32_t v; ARRAY_MEMCPY(&v, p, 4); return v; }
+
+//////////////////////////////////////
+
+// wyhash (final version 4), a fast hash with excellent mixing, so similar
+// keys like neighboring vertices won't cluster together in the table.
+inline uint64_t hash_bytes(const void *data, size_t size, uint64_t seed = 0) {
+	const uint64_t s0 = 0xa0761d6478bd642full;
+	const uint64_t s1 = 0xe7037ed1a0b428dbull;
+	const uint64_t s2 = 0x8ebc6af09c88c6e3ull;
+	const uint64_t s3 = 0x589965cc75374cc3ull;
+	const uint8_t *p  = (const uint8_t *)data;
+
+	seed ^= _hash_mix(seed ^ s0, s1);
+	uint64_t a, b;
+	if (size <= 16) {
+		if (size >= 4) {
+			size_t offset = (size >> 3) << 2;
+			a = (_hash_read32(p) << 32) | _hash_read32(p + offset);
+			b = (_hash_read32(p + size - 4) << 32) | _hash_read32(p + size - 4 - offset);
+		} else if (size > 0) {
+			a = ((uint64_t)p[0] << 16) | ((uint64_t)p[size >> 1] << 8) | p[size - 1];
+			b = 0;
+		} else {
+			a = b = 0;
 		}
-		
-		ARRAY_FREE(old_items);
-	}
-	
-	int32_t set(const K &key, const T &value) {
-		if (count+1 >= capacity) {
-			resize(capacity == 0 ? 4 : capacity * 2);
+	} else {
+		size_t i = size;
+		if (i > 48) {
+			uint64_t seed1 = seed, seed2 = seed;
+			do {
+				seed  = _hash_mix(_hash_read64(p     ) ^ s1, _hash_read64(p +  8) ^ seed );
+				seed1 = _hash_mix(_hash_read64(p + 16) ^ s2, _hash_read64(p + 24) ^ seed1);
+				seed2 = _hash_mix(_hash_read64(p + 32) ^ s3, _hash_read64(p + 40) ^ seed2);
+				p += 48;
+				i -= 48;
+			} while (i > 48);
+			seed ^= seed1 ^ seed2;
 		}
-
-		// When this searches _past_ a certain distance for a free slot, then
-		// we should resize the hashmap.
-		int32_t search_distance = (int32_t)(capacity * _hashmap_search_dist_pct);
-		if (search_distance < _hashmap_search_dist_min)
-			search_distance = _hashmap_search_dist_min;
-		
-		// Find the first slot that is empty or has the same key.
-		uint64_t hash = _hash(key);
-		int32_t  id   = hash % capacity;
-		while (items[id].hash != 0 && search_distance > 0) {
-			if (items[id].hash == hash && memcmp(&items[id].key, &key, sizeof(K)) == 0)
-				break;
-			id              += 1;
-			search_distance -= 1;
-			if (id >= capacity) id = 0;
+		while (i > 16) {
+			seed = _hash_mix(_hash_read64(p) ^ s1, _hash_read64(p + 8) ^ seed);
+			i -= 16;
+			p += 16;
 		}
+		a = _hash_read64(p + i - 16);
+		b = _hash_read64(p + i - 8);
+	}
+	a ^= s1;
+	b ^= seed;
+	_hash_mum(&a, &b);
+	return _hash_mix(a ^ s0 ^ size, b ^ s1);
+}
 
-		// We didn't find a slot in range, resize and try again!
-		if (items[id].hash != 0 && items[id].hash != hash) {
-			resize(capacity * 2);
-			id = set(key, value);
-			return id;
-		}
+//////////////////////////////////////
+
+// Group matching returns a bitmask with one set bit per matching slot. NEON
+// has no movemask, so there each slot gets 4 bits of the mask instead, and
+// _hashmap_lane_shift accounts for that.
+#if defined(ARRAY_HASHMAP_SSE2)
+
+const int32_t _hashmap_lane_shift = 0;
+inline uint64_t _hashmap_match      (const int8_t *group, int8_t h2) { return (uint64_t)_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_set1_epi8(h2), _mm_loadu_si128((const __m128i *)group))); }
+inline uint64_t _hashmap_match_empty(const int8_t *group)            { return _hashmap_match(group, _hashmap_empty); }
+inline uint64_t _hashmap_match_free (const int8_t *group)            { return (uint64_t)_mm_movemask_epi8(_mm_loadu_si128((const __m128i *)group)); }
+
+#elif defined(ARRAY_HASHMAP_NEON)
+
+const int32_t _hashmap_lane_shift = 2;
+inline uint64_t _hashmap_neon_mask(uint8x16_t cmp) { return vget_lane_u64(vreinterpret_u64_u8(vshrn_n_u16(vreinterpretq_u16_u8(cmp), 4)), 0) & 0x8888888888888888ull; }
+inline uint64_t _hashmap_match      (const int8_t *group, int8_t h2) { return _hashmap_neon_mask(vceqq_s8(vdupq_n_s8(h2), vld1q_s8(group))); }
+inline uint64_t _hashmap_match_empty(const int8_t *group)            { return _hashmap_match(group, _hashmap_empty); }
+inline uint64_t _hashmap_match_free (const int8_t *group)            { return _hashmap_neon_mask(vcltq_s8(vld1q_s8(group), vdupq_n_s8(0))); }
+
+#else
+
+const int32_t _hashmap_lane_shift = 0;
+inline uint64_t _hashmap_match(const int8_t *group, int8_t h2) {
+	uint64_t result = 0;
+	for (int32_t i = 0; i < _hashmap_group_size; i++)
+		result |= (uint64_t)(group[i] == h2) << i;
+	return result;
+}
+inline uint64_t _hashmap_match_empty(const int8_t *group) { return _hashmap_match(group, _hashmap_empty); }
+inline uint64_t _hashmap_match_free (const int8_t *group) {
+	uint64_t result = 0;
+	for (int32_t i = 0; i < _hashmap_group_size; i++)
+		result |= (uint64_t)(group[i] < 0) << i;
+	return result;
+}
+
+#endif
+
+inline int32_t _hashmap_lane(uint64_t mask) {
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_AMD64) || defined(_M_ARM64))
+	unsigned long idx;
+	_BitScanForward64(&idx, mask);
+	return (int32_t)idx >> _hashmap_lane_shift;
+#elif defined(_MSC_VER)
+	unsigned long idx;
+	if (_BitScanForward(&idx, (unsigned long)mask)) return (int32_t)idx >> _hashmap_lane_shift;
+	_BitScanForward(&idx, (unsigned long)(mask >> 32));
+	return (int32_t)(idx + 32) >> _hashmap_lane_shift;
+#else
+	return __builtin_ctzll(mask) >> _hashmap_lane_shift;
+#endif
+}
+
+//////////////////////////////////////
+
+template <typename K>
+struct hashmap_key_bytes_t {
+	static uint64_t hash   (const K &key)               { return hash_bytes(&key, sizeof(K)); }
+	static bool     equals (const K &a, const K &b)     { return memcmp(&a, &b, sizeof(K)) == 0; }
+	static K        store  (const K &key)               { return key; }
+	static void     release(K &)                        { }
+};
+
+struct hashmap_key_string_t {
+	static uint64_t    hash   (const char *key)                { return hash_bytes(key, strlen(key)); }
+	static bool        equals (const char *a, const char *b)   { return strcmp(a, b) == 0; }
+	static const char *store  (const char *key)                { size_t size = strlen(key) + 1; char *result = (char*)ARRAY_MALLOC(size); ARRAY_MEMCPY(result, key, size); return result; }
+	static void        release(const char *&key)               { ARRAY_FREE((void*)key); key = nullptr; }
+};
+
+//////////////////////////////////////
+
+template <typename K, typename T, typename KeyOps = hashmap_key_bytes_t<K> >
+struct hashmap_t {
+	struct entry_t {
+		K key;
+		T value;
+	};
+	entry_t *items;
+	int8_t  *ctrl;
+	int32_t  count;
+	int32_t  capacity;
+	// Slots that can still be claimed before the table needs to grow. This
+	// keeps the table at most 7/8 full, counting tombstones as full.
+	int32_t  growth_left;
 
-		// Increment the count if we found a totally empty slot.
-		if (items[id].hash != hash) {
-			items[id].key = key;
-			count += 1;
+	int32_t set(const K &key, const T &value) {
+		uint64_t hash = KeyOps::hash(key);
+		int32_t  at   = _find(key, hash);
+		if (at == -1) {
+			at = _claim(hash);
+			items[at].key = KeyOps::store(key);
 		}
-		
-		items[id].hash  = hash;
-		items[id].value = value;
-		return id;
+		items[at].value = value;
+		return at;
 	}
 
-	int32_t contains(const K& key)  {
+	int32_t contains(const K &key) const {
 		if (capacity == 0) return -1;
-		
-		uint64_t hash = _hash(key);
-		int32_t  id   = hash % capacity;
-
-		int32_t search_distance = (int32_t)(capacity * _hashmap_search_dist_pct);
-		if (search_distance < _hashmap_search_dist_min)
-			search_distance = _hashmap_search_dist_min;
-
-		while (search_distance >= 0) {
-			if (items[id].hash == 0) return -1;
-			if (memcmp(&items[id].key, &key, sizeof(K)) == 0)
-				return id;
-
-			id              += 1;
-			search_distance -= 1;
-			if (id >= capacity) id = 0;
-		}
-		return -1;
+		return _find(key, KeyOps::hash(key));
 	}
 
-	T *get(const K &key)  {
+	T *get(const K &key) {
 		int32_t id = contains(key);
-		if (id == -1)
-			return nullptr;
 		return id == -1
 			? nullptr
 			: &items[id].value;
 	}
-	
-	const T* get_or(const K& key, const T& default_value)  {
+
+	T get_or(const K &key, const T &default_value) const {
 		int32_t id = contains(key);
 		return id == -1
 			? default_value
-			: &items[id].value;
+			: items[id].value;
 	}
-	
-	void free     ()                 { ARRAY_FREE(items); *this = {}; }
-	bool remove   (const K& key)     { int32_t at = contains(key); if (at != -1) { if (items[at].hash != 0) { count--; } items[at].hash = 0; } return at != -1; }
-	void remove_at(const int32_t at) { if (items[at].hash != 0) { count--; } items[at].hash = 0; }
-};
 
-//////////////////////////////////////
-// dictionary_t                     //
-//////////////////////////////////////
-
-template <typename T>
-struct dictionary_t {
-	struct entry_t {
-		uint64_t hash;
-		char*    key;
-		T        value;
-	};
-	entry_t* items;
-	int32_t  count;
-	int32_t  capacity;
+	// Make sure item_count items can be in the table without it needing to
+	// grow. Handy for large bulk inserts.
+	void reserve(int32_t item_count) {
+		// Capacity stays a power of two, so stop before doubling past the
+		// largest one int32_t can hold.
+		int32_t size = _hashmap_group_size;
+		while (size - size / 8 < item_count && size <= INT32_MAX / 2) size *= 2;
+		if (size > capacity) _rehash(size);
+	}
 
-	uint64_t _hash(const char* string) const {
-		uint64_t hash = 14695981039346656037UL;
-		uint8_t  c    = string[0];
-		for (size_t i = 0; i < 64; i++) {
-			if (c != 0) c = string[i];
-			hash = (hash ^ c) * 1099511628211;
+	bool has      (int32_t at) const   { return ctrl[at] >= 0; }
+	void each     (void (*e)(T&))      { for (int32_t i = 0; i < capacity; i++) if (ctrl[i] >= 0) e(items[i].value); }
+	bool remove   (const K &key)       { int32_t at = contains(key); if (at != -1) remove_at(at); return at != -1; }
+	void remove_at(int32_t at) {
+		if (ctrl[at] < 0) return;
+		KeyOps::release(items[at].key);
+		count -= 1;
+
+		// If this slot's group still has an empty slot, no probe has ever
+		// needed to pass through it, so it can go straight back to empty.
+		// Otherwise it needs a tombstone to keep later probes going.
+		if (_hashmap_match_empty(&ctrl[at - at % _hashmap_group_size])) {
+			ctrl[at]     = _hashmap_empty;
+			growth_left += 1;
+		} else {
+			ctrl[at]     = _hashmap_deleted;
 		}
-		return hash;
 	}
-	char *_string_copy(const char *string) {
-		size_t size   = strlen(string) + 1;
-		char  *result = (char*)ARRAY_MALLOC(size);
-		memcpy(result, string, size);
-		return result;
+	void clear() {
+		for (int32_t i = 0; i < capacity; i++) if (ctrl[i] >= 0) KeyOps::release(items[i].key);
+		if (capacity > 0) memset(ctrl, _hashmap_empty, capacity);
+		count       = 0;
+		growth_left = capacity - capacity / 8;
+	}
+	void free() {
+		for (int32_t i = 0; i < capacity; i++) if (ctrl[i] >= 0) KeyOps::release(items[i].key);
+		ARRAY_FREE(items);
+		*this = {};
 	}
 
-	void resize(int32_t size) {
-		if (size < count)
-			size = count;
-		if (size == capacity) return;
-		
-		entry_t* old_items    = items;
-		int32_t  old_capacity = capacity;
-		items    = (entry_t*)ARRAY_MALLOC(sizeof(entry_t) * size);
-		capacity = size;
-		count    = 0;
+	//////////////////////////////////////
 
-		memset(items, 0, sizeof(entry_t) * size);
-		for (int32_t i = 0; i < old_capacity; i++) {
-			if (old_items[i].hash == 0) continue;
-			set(old_items[i].key, old_items[i].value);
-		}
-		
-		ARRAY_FREE(old_items);
-	}
-	
-	int32_t set(const char *key, const T &value) {
-		if (count+1 >= capacity) {
-			resize(capacity == 0 ? 4 : capacity * 2);
-		}
+	int32_t _find(const K &key, uint64_t hash) const {
+		if (capacity == 0) return -1;
 
-		// When this searches _past_ a certain distance for a free slot, then
-		// we should resize the hashmap.
-		int32_t search_distance = (int32_t)(capacity * _hashmap_search_dist_pct);
-		if (search_distance < _hashmap_search_dist_min)
-			search_distance = _hashmap_search_dist_min;
-		
-		// Find the first slot that is empty or has the same key.
-		uint64_t hash = _hash(key);
-		int32_t  id   = hash % capacity;
-		while (items[id].hash != 0 && search_distance > 0) {
-			if (items[id].hash == hash && strcmp(items[id].key, key) == 0)
-				break;
-			id              += 1;
-			search_distance -= 1;
-			if (id >= capacity) id = 0;
+		int8_t  h2    = (int8_t)(hash & 0x7F);
+		int32_t mask  = capacity / _hashmap_group_size - 1;
+		int32_t group = (int32_t)(hash >> 7) & mask;
+		// Triangular probing over a power of two group count will visit
+		// every group, and the load limit guarantees an empty slot to stop
+		// on somewhere.
+		for (int32_t step = 1; ; step++) {
+			const int8_t *g = &ctrl[group * _hashmap_group_size];
+			for (uint64_t m = _hashmap_match(g, h2); m != 0; m &= m - 1) {
+				int32_t at = group * _hashmap_group_size + _hashmap_lane(m);
+				if (KeyOps::equals(items[at].key, key))
+					return at;
+			}
+			if (_hashmap_match_empty(g) != 0) return -1;
+			group = (group + step) & mask;
 		}
+	}
 
-		// We didn't find a slot in range, resize and try again!
-		if (items[id].hash != 0 && items[id].hash != hash) {
-			resize(capacity * 2);
-			id = set(key, value);
-			return id;
+	// Finds a free slot for a key that's known not to be in the table, and
+	// marks it full. The caller fills in the entry.
+	int32_t _claim(uint64_t hash) {
+		if (growth_left == 0) {
+			// Lots of tombstones means we can just clean up in place rather
+			// than grow.
+			_rehash(capacity == 0
+				? _hashmap_group_size
+				: (count + 1 > capacity / 2 - capacity / 16 ? capacity * 2 : capacity));
 		}
 
-		// Increment the count if we found a totally empty slot.
-		if (items[id].hash != hash) {
-			items[id].key = _string_copy(key);
-			count += 1;
+		int8_t  h2    = (int8_t)(hash & 0x7F);
+		int32_t mask  = capacity / _hashmap_group_size - 1;
+		int32_t group = (int32_t)(hash >> 7) & mask;
+		for (int32_t step = 1; ; step++) {
+			uint64_t m = _hashmap_match_free(&ctrl[group * _hashmap_group_size]);
+			if (m != 0) {
+				int32_t at = group * _hashmap_group_size + _hashmap_lane(m);
+				if (ctrl[at] == _hashmap_empty) growth_left -= 1;
+				ctrl[at] = h2;
+				count   += 1;
+				return at;
+			}
+			group = (group + step) & mask;
 		}
-		
-		items[id].hash  = hash;
-		items[id].value = value;
-		return id;
 	}
 
-	int32_t contains(const char* key)  {
-		if (capacity == 0) return -1;
-		
-		uint64_t hash = _hash(key);
-		int32_t  id   = hash % capacity;
-
-		int32_t search_distance = (int32_t)(capacity * _hashmap_search_dist_pct);
-		if (search_distance < _hashmap_search_dist_min)
-			search_distance = _hashmap_search_dist_min;
-
-		while (search_distance >= 0) {
-			if (items[id].hash == 0) return -1;
-			if (strcmp(items[id].key, key) == 0)
-				return id;
-
-			id              += 1;
-			search_distance -= 1;
-			if (id >= capacity) id = 0;
-		}
-		return -1;
-	}
+	void _rehash(int32_t size) {
+		entry_t *old_items    = items;
+		int8_t  *old_ctrl     = ctrl;
+		int32_t  old_capacity = capacity;
 
-	T *get(const char* key)  {
-		int32_t id = contains(key);
-		if (id == -1)
-			return nullptr;
-		return id == -1
-			? nullptr
-			: &items[id].value;
-	}
-	
-	const T* get_or(const char* key, const T& default_value) {
-		int32_t id = contains(key);
-		return id == -1
-			? default_value
-			: &items[id].value;
+		// Entries and control bytes share one allocation
+		items       = (entry_t*)ARRAY_MALLOC(sizeof(entry_t) * size + size);
+		ctrl        = (int8_t*)(items + size);
+		capacity    = size;
+		count       = 0;
+		growth_left = size - size / 8;
+		memset(ctrl, _hashmap_empty, size);
+
+		for (int32_t i = 0; i < old_capacity; i++) {
+			if (old_ctrl[i] < 0) continue;
+			int32_t at = _claim(KeyOps::hash(old_items[i].key));
+			ARRAY_MEMCPY(&items[at], &old_items[i], sizeof(entry_t));
+		}
+		ARRAY_FREE(old_items);
 	}
-	
-	void each     (void (*e)(T&))    { for (int32_t i = 0; i < count; i++) if (items[i].hash != 0) e(items[i].value); }
-	void free     ()                 { for(int i=0;i<capacity;i+=1) {if (items[i].hash != 0) ARRAY_FREE(items[i].key); } ARRAY_FREE(items); *this = {}; }
-	bool remove   (const char* key)  { int32_t at = contains(key); if (at != -1) { if (items[at].hash != 0) { count--; } items[at].hash = 0; ARRAY_FREE(items[at].key); } return at != -1; }
-	void remove_at(const int32_t at) { if (items[at].hash != 0) { count--; } items[at].hash = 0; }
 };
 
+//////////////////////////////////////
+// dictionary_t                     //
+//////////////////////////////////////
+
+// A hashmap_t keyed by strings. It keeps its own copy of each key, which is
+// released when the item is removed or the dictionary is freed.
+template <typename T>
+using dictionary_t = hashmap_t<const char *, T, hashmap_key_string_t>;
+
 //////////////////////////////////////
 // array_t methods                  //
 //////////////////////////////////////
@@ -6,8 +6,20 @@
 	#include <winnt.h>
 	#define atomic_increment(int_val_ref) InterlockedIncrement((LONG*)int_val_ref)
 	#define atomic_decrement(int_val_ref) InterlockedDecrement((LONG*)int_val_ref)
+	#define atomic_add64(int64_val_ref, amount) (InterlockedExchangeAdd64((LONG64*)int64_val_ref, amount) + (amount))
+	#define atomic_cas64(int64_val_ref, expected, desired) InterlockedCompareExchange64((LONG64*)int64_val_ref, desired, expected)
+	#define atomic_load32(int_val_ref) InterlockedCompareExchange((LONG*)int_val_ref, 0, 0)
+	#define atomic_load64(int64_val_ref) InterlockedCompareExchange64((LONG64*)int64_val_ref, 0, 0)
+	#define atomic_store64(int64_val_ref, value) InterlockedExchange64((LONG64*)int64_val_ref, value)
+	#define atomic_fence() MemoryBarrier()
 #else
 	// gcc and clang both implement these at least
 	#define atomic_increment(int_val_ref) __sync_add_and_fetch(int_val_ref, 1)
 	#define atomic_decrement(int_val_ref) __sync_sub_and_fetch(int_val_ref, 1)
+	#define atomic_add64(int64_val_ref, amount) __sync_add_and_fetch(int64_val_ref, amount)
+	#define atomic_cas64(int64_val_ref, expected, desired) __sync_val_compare_and_swap(int64_val_ref, expected, desired)
+	#define atomic_load32(int_val_ref) __atomic_load_n(int_val_ref, __ATOMIC_SEQ_CST)
+	#define atomic_load64(int64_val_ref) __atomic_load_n(int64_val_ref, __ATOMIC_SEQ_CST)
+	#define atomic_store64(int64_val_ref, value) __atomic_store_n(int64_val_ref, value, __ATOMIC_SEQ_CST)
+	#define atomic_fence() __sync_synchronize()
 #endif
\ No newline at end of file
@@ -50,6 +50,7 @@ void           ft_mutex_unlock       (ft_mutex_t  mutex);
 ft_condition_t ft_condition_create   (void);
 void           ft_condition_destroy  (ft_condition_t *condition);
 void           ft_condition_wait     (ft_condition_t  condition, ft_mutex_t wait_mutex);
+void           ft_condition_wait_ms  (ft_condition_t  condition, ft_mutex_t wait_mutex, uint32_t timeout_ms);
 void           ft_condition_broadcast(ft_condition_t  condition);
 void           ft_condition_signal   (ft_condition_t  condition);
 
@@ -60,6 +61,8 @@ ft_id_t        ft_id_current         (void);
 ft_thread_t    ft_thread_create      (int32_t (*thread_func)(void *args), void *args);
 ft_thread_t    ft_thread_current     (void);
 void           ft_thread_name        (ft_thread_t thread, const char* name);
+void           ft_thread_join        (ft_thread_t thread);
+void           ft_thread_detach      (ft_thread_t thread);
 
 void           ft_yield              (void);
 
@@ -84,6 +87,7 @@ void           ft_yield              (void);
 #else
 
 	#include <pthread.h>
+	#include <time.h>
 	struct _ft_mutex_t {
 		pthread_mutex_t mutex;
 	};
@@ -205,6 +209,26 @@ void ft_condition_wait(ft_condition_t condition, ft_mutex_t wait_mutex) {
 
 ///////////////////////////////////////////
 
+// Like ft_condition_wait, but gives up after timeout_ms. Spurious wakeups
+// can happen here too, so callers should re-check whatever they wait on.
+void ft_condition_wait_ms(ft_condition_t condition, ft_mutex_t wait_mutex, uint32_t timeout_ms) {
+#if defined(FT_WIN)
+	SleepConditionVariableCS(&condition->condition, &wait_mutex->section, timeout_ms);
+#else
+	struct timespec until = {};
+	clock_gettime(CLOCK_REALTIME, &until);
+	until.tv_sec  += timeout_ms / 1000;
+	until.tv_nsec += (long)(timeout_ms % 1000) * 1000000;
+	if (until.tv_nsec >= 1000000000) {
+		until.tv_sec  += 1;
+		until.tv_nsec -= 1000000000;
+	}
+	pthread_cond_timedwait(&condition->condition, &wait_mutex->mutex, &until);
+#endif
+}
+
+///////////////////////////////////////////
+
 void ft_condition_broadcast(ft_condition_t condition) {
 #if defined(FT_WIN)
 	WakeAllConditionVariable(&condition->condition);
@@ -328,6 +352,30 @@ void ft_thread_name(ft_thread_t thread, const char* name) {
 
 ///////////////////////////////////////////
 
+// Waits for the thread to finish, and releases its handle.
+void ft_thread_join(ft_thread_t thread) {
+#if defined(FT_WIN)
+	WaitForSingleObject(thread, INFINITE);
+	CloseHandle(thread);
+#else
+	pthread_join(thread, nullptr);
+#endif
+}
+
+///////////////////////////////////////////
+
+// Lets the thread clean up after itself when it finishes, for threads that
+// are never joined.
+void ft_thread_detach(ft_thread_t thread) {
+#if defined(FT_WIN)
+	CloseHandle(thread);
+#else
+	pthread_detach(thread);
+#endif
+}
+
+///////////////////////////////////////////
+
 void ft_yield(void) {
 #if defined(FT_WIN)
 	Sleep(0);
@@ -1,8 +1,12 @@
 #include "stereokit.h"
+#include "_stereokit.h"
 #include "sk_memory.h"
 #include "log.h"
 #include "libraries/stref.h"
 #include "libraries/array.h"
+#include "libraries/atomic_util.h"
+#include "libraries/ferr_thread.h"
+#include "libraries/sokol_time.h"
 #include "platforms/platform.h"
 
 #include <string.h>
@@ -33,6 +37,66 @@ struct log_callback_t {
 	void* context;
 };
 array_t<log_callback_t> log_listeners = {};
+ft_id_t                 log_listeners_owner;
+int32_t                 log_listeners_depth;
+
+// Listeners are app code that usually touches app state, so the log thread
+// doesn't call them directly. It queues up messages here instead, and the
+// main thread hands them out during sk_step, or when it calls log_flush.
+struct log_pending_t {
+	log_  level;
+	char *text;
+};
+array_t<log_pending_t> log_pending = {};
+
+// Once the log thread is running, messages are handed off to it through a
+// bounded multi-producer queue. Each slot has a sequence number that says
+// whose turn it is: producers claim a position with a CAS, fill in the slot,
+// and then bump its sequence so the log thread knows it's ready. Messages
+// that don't fit in a slot's text go to the heap instead.
+#define LOG_QUEUE_SIZE 1024
+#define LOG_SLOT_TEXT  240
+
+struct log_slot_t {
+	volatile int64_t sequence;
+	log_             level;
+	char            *heap_text;
+	char             text[LOG_SLOT_TEXT];
+};
+
+struct log_async_t {
+	log_slot_t      *slots;
+	volatile int64_t enqueue_pos;
+	volatile int64_t dequeue_pos;
+	volatile int64_t flush_requested;
+	volatile int64_t flush_completed;
+	volatile int64_t dropped;
+	volatile int64_t rate_request; // -1 when there's no new limit to apply
+	ft_id_t          thread_id;
+	ft_thread_t      thread;
+	volatile bool32_t running;
+	volatile bool32_t thread_running;
+
+	// The log thread sleeps on this when there's nothing to do. Producers
+	// only take the lock to wake it when it says it's sleeping.
+	ft_mutex_t       wake_mtx;
+	ft_condition_t   wake;
+	volatile bool32_t sleeping;
+
+	// Only touched by the log thread
+	int32_t          rate_limit;
+	double           rate_tokens;
+	uint64_t         rate_time;
+	int32_t          rate_dropped;
+	char            *last_text;
+	size_t           last_size;
+	log_             last_level;
+	int32_t          last_repeats;
+	uint64_t         last_repeat_time;
+};
+log_async_t       log_async   = {};
+volatile bool32_t log_is_async = false;
+volatile bool32_t log_dedup    = false;
 
 log_        log_filter = log_diagnostic;
 log_colors_ log_colors = log_colors_ansi;
@@ -84,7 +148,126 @@ const char *log_colorcodes[_countof(log_tags)] = {
 
 ///////////////////////////////////////////
 
-void log_platform_output(log_ level, const char* text);
+void    log_platform_output(log_ level, const char* text);
+void    log_deliver        (log_ level, const char* text);
+void    log_writev         (log_ level, const char* text, va_list args);
+int32_t log_thread         (void *);
+void    log_thread_wake    ();
+
+///////////////////////////////////////////
+
+// Listeners are called from the log thread, but a listener may need to
+// subscribe or unsubscribe from inside its own callback, so this lock is
+// re-entrant for whichever thread holds it.
+ft_mutex_t log_listeners_mtx() {
+	static ft_mutex_t mtx = ft_mutex_create();
+	return mtx;
+}
+
+void log_listeners_lock() {
+	if (log_listeners_depth > 0 && ft_id_matches(log_listeners_owner)) {
+		log_listeners_depth += 1;
+		return;
+	}
+	ft_mutex_lock(log_listeners_mtx());
+	log_listeners_owner = ft_id_current();
+	log_listeners_depth = 1;
+}
+
+void log_listeners_unlock() {
+	log_listeners_depth -= 1;
+	if (log_listeners_depth == 0)
+		ft_mutex_unlock(log_listeners_mtx());
+}
+
+ft_mutex_t log_pending_mtx() {
+	static ft_mutex_t mtx = ft_mutex_create();
+	return mtx;
+}
+
+///////////////////////////////////////////
+
+void log_call_listeners(log_ level, const char *text) {
+	log_listeners_lock();
+	for (int32_t i = 0; i < log_listeners.count; i++) {
+		log_listeners[i].callback(log_listeners[i].context, level, text);
+	}
+	log_listeners_unlock();
+}
+
+///////////////////////////////////////////
+
+void log_step() {
+	// Swap the queue out first, listeners may log, and anything they log
+	// waits for the next step rather than extending this one.
+	ft_mutex_lock(log_pending_mtx());
+	array_t<log_pending_t> pending = log_pending;
+	log_pending = {};
+	ft_mutex_unlock(log_pending_mtx());
+
+	for (int32_t i = 0; i < pending.count; i++) {
+		log_call_listeners(pending[i].level, pending[i].text);
+		sk_free(pending[i].text);
+	}
+	pending.free();
+}
+
+///////////////////////////////////////////
+
+void log_init() {
+#if !defined(__EMSCRIPTEN__)
+	if (log_is_async) return;
+
+	int32_t rate_limit = log_async.rate_limit;
+	log_async = {};
+	log_async.rate_limit = rate_limit;
+	log_async.slots      = sk_malloc_t(log_slot_t, LOG_QUEUE_SIZE);
+	for (int32_t i = 0; i < LOG_QUEUE_SIZE; i++) {
+		log_async.slots[i].sequence  = i;
+		log_async.slots[i].heap_text = nullptr;
+	}
+	log_async.rate_time      = stm_now();
+	log_async.rate_request   = -1;
+	log_async.running        = true;
+	log_async.thread_running = true;
+	log_async.wake_mtx       = ft_mutex_create();
+	log_async.wake           = ft_condition_create();
+
+	log_async.thread = ft_thread_create(log_thread, nullptr);
+	ft_thread_name(log_async.thread, "StereoKit Log");
+	log_is_async = true;
+#endif
+}
+
+///////////////////////////////////////////
+
+void log_shutdown() {
+	if (!log_is_async) return;
+
+	log_flush();
+	log_async.running = false;
+	log_thread_wake();
+	ft_thread_join(log_async.thread);
+
+	// Listeners get whatever the log thread had queued for them, and
+	// anything that slipped in after the final drain still gets written,
+	// just synchronously.
+	log_is_async = false;
+	log_step();
+	for (int64_t pos = log_async.dequeue_pos; pos < log_async.enqueue_pos; pos++) {
+		log_slot_t *slot = &log_async.slots[pos & (LOG_QUEUE_SIZE - 1)];
+		while (slot->sequence != pos + 1) ft_yield();
+		log_deliver(slot->level, slot->heap_text ? slot->heap_text : slot->text);
+		sk_free(slot->heap_text);
+	}
+	sk_free(log_async.slots);
+	sk_free(log_async.last_text);
+	ft_mutex_destroy    (&log_async.wake_mtx);
+	ft_condition_destroy(&log_async.wake);
+	int32_t rate_limit = log_async.rate_limit;
+	log_async = {};
+	log_async.rate_limit = rate_limit;
+}
 
 ///////////////////////////////////////////
 
@@ -147,10 +330,7 @@ void log_replace_colors(const char *src, char *dest, const char **color_tags, co
 
 ///////////////////////////////////////////
 
-void log_write(log_ level, const char *text) {
-	if (level < log_filter)
-		return;
-
+void log_deliver(log_ level, const char *text) {
 	const char* tag   = "";
 	const char* color = "";
 	switch (level) {
@@ -186,24 +366,342 @@ void log_write(log_ level, const char *text) {
 		log_replace_colors(text, replace_buffer, log_tags, nullptr, _countof(log_tags), 0);
 		plain_text = replace_buffer;
 	}
-	for (int32_t i = 0; i < log_listeners.count; i++) {
-		log_listeners[i].callback(log_listeners[i].context, level, plain_text);
-	}
 	log_platform_output(level, plain_text);
-	if (level == log_error) platform_print_callstack();
+
+	if (!log_is_async || !ft_id_matches(log_async.thread_id)) {
+		log_call_listeners(level, plain_text);
+		return;
+	}
+
+	log_listeners_lock();
+	bool has_listeners = log_listeners.count > 0;
+	log_listeners_unlock();
+	if (!has_listeners) return;
+
+	log_pending_t item = {};
+	item.level = level;
+	item.text  = string_copy(plain_text);
+	ft_mutex_lock(log_pending_mtx());
+	log_pending.add(item);
+	ft_mutex_unlock(log_pending_mtx());
 }
 
 ///////////////////////////////////////////
 
-char *make_variadic_string(const char* text, va_list args) {
-	va_list copy;
-	va_copy (copy, args);
-	size_t length = vsnprintf(nullptr, 0, text, args) + 1;
-	char*  buffer = sk_malloc_t(char, length);
-	vsnprintf(buffer, length, text, copy);
-	va_end(copy);
+log_slot_t *log_queue_claim(int64_t *out_pos) {
+	// The log thread can't wait on itself to make room, so if a listener
+	// logs while the queue is full, that message is dropped.
+	bool on_log_thread = ft_id_matches(log_async.thread_id);
+
+	int64_t pos = log_async.enqueue_pos;
+	while (true) {
+		log_slot_t *slot = &log_async.slots[pos & (LOG_QUEUE_SIZE - 1)];
+		int64_t     seq  = slot->sequence;
+		atomic_fence();
+
+		int64_t diff = seq - pos;
+		if (diff == 0) {
+			int64_t prev = atomic_cas64(&log_async.enqueue_pos, pos, pos + 1);
+			if (prev == pos) {
+				*out_pos = pos;
+				return slot;
+			}
+			pos = prev;
+		} else if (diff < 0) {
+			if (on_log_thread) {
+				atomic_add64(&log_async.dropped, 1);
+				return nullptr;
+			}
+			ft_yield();
+			pos = log_async.enqueue_pos;
+		} else {
+			pos = log_async.enqueue_pos;
+		}
+	}
+}
+
+///////////////////////////////////////////
+
+void log_thread_wake() {
+	// Pairs with the fence in log_thread_sleep, either we see that it's
+	// sleeping, or it sees whatever we just did.
+	atomic_fence();
+	if (!log_async.sleeping) return;
 
-	return buffer;
+	ft_mutex_lock       (log_async.wake_mtx);
+	ft_condition_signal (log_async.wake);
+	ft_mutex_unlock     (log_async.wake_mtx);
+}
+
+///////////////////////////////////////////
+
+void log_queue_commit(log_slot_t *slot, int64_t pos) {
+	atomic_fence();
+	slot->sequence = pos + 1;
+	log_thread_wake();
+}
+
+///////////////////////////////////////////
+
+void log_write(log_ level, const char *text) {
+	if (level < log_filter || level == log_none)
+		return;
+	if (text == nullptr) text = "(null)";
+
+	if (!log_is_async) {
+		log_deliver(level, text);
+	} else {
+		int64_t     pos;
+		log_slot_t *slot = log_queue_claim(&pos);
+		if (slot == nullptr) return;
+
+		size_t size = strlen(text) + 1;
+		slot->level = level;
+		if (size <= LOG_SLOT_TEXT) {
+			memcpy(slot->text, text, size);
+			slot->heap_text = nullptr;
+		} else {
+			slot->heap_text = sk_malloc_t(char, size);
+			memcpy(slot->heap_text, text, size);
+		}
+		log_queue_commit(slot, pos);
+	}
+
+	// Errors are worth getting out right away, in case we're about to crash,
+	// and the callstack is only useful from the thread that logged it.
+	if (level == log_error) {
+		log_flush();
+		platform_print_callstack();
+	}
+}
+
+///////////////////////////////////////////
+
+void log_writev(log_ level, const char *text, va_list args) {
+	if (level < log_filter || level == log_none)
+		return;
+
+	if (!log_is_async) {
+		va_list copy;
+		va_copy(copy, args);
+		size_t length = vsnprintf(nullptr, 0, text, args) + 1;
+		char*  buffer = sk_malloc_t(char, length);
+		vsnprintf(buffer, length, text, copy);
+		va_end(copy);
+
+		log_deliver(level, buffer);
+		sk_free(buffer);
+	} else {
+		// Format straight into the queue slot, so short messages never
+		// touch the heap.
+		int64_t     pos;
+		log_slot_t *slot = log_queue_claim(&pos);
+		if (slot == nullptr) return;
+
+		va_list copy;
+		va_copy(copy, args);
+		int32_t length = vsnprintf(slot->text, LOG_SLOT_TEXT, text, args);
+		slot->level     = level;
+		slot->heap_text = nullptr;
+		if (length >= LOG_SLOT_TEXT) {
+			slot->heap_text = sk_malloc_t(char, length + 1);
+			vsnprintf(slot->heap_text, length + 1, text, copy);
+		} else if (length < 0) {
+			slot->text[0] = '\0';
+		}
+		va_end(copy);
+		log_queue_commit(slot, pos);
+	}
+
+	if (level == log_error) {
+		log_flush();
+		platform_print_callstack();
+	}
+}
+
+///////////////////////////////////////////
+
+void log_flush() {
+	if (!log_is_async || ft_id_matches(log_async.thread_id)) return;
+
+	int64_t target  = log_async.enqueue_pos;
+	int64_t request = atomic_add64(&log_async.flush_requested, 1);
+	log_thread_wake();
+	while (log_async.dequeue_pos < target || log_async.flush_completed < request) {
+		if (!log_async.thread_running) return;
+		ft_yield();
+	}
+
+	if (ft_id_matches(sk_main_thread()))
+		log_step();
+}
+
+///////////////////////////////////////////
+
+void log_set_dedup(bool32_t collapse_repeats) {
+	log_dedup = collapse_repeats;
+	if (log_is_async) log_thread_wake();
+}
+
+///////////////////////////////////////////
+
+void log_set_rate_limit(int32_t messages_per_second) {
+	int32_t rate_limit = messages_per_second < 0 ? 0 : messages_per_second;
+
+	// The rate limiter's state belongs to the log thread, so hand it over
+	// rather than changing it out from under the thread.
+	if (log_is_async) {
+		int64_t prev = log_async.rate_request;
+		while (true) {
+			int64_t curr = atomic_cas64(&log_async.rate_request, prev, (int64_t)rate_limit);
+			if (curr == prev) break;
+			prev = curr;
+		}
+		log_thread_wake();
+	} else {
+		log_async.rate_limit  = rate_limit;
+		log_async.rate_tokens = rate_limit;
+	}
+}
+
+///////////////////////////////////////////
+
+void log_thread_flush_repeats() {
+	if (log_async.last_repeats <= 0) return;
+
+	char msg[64];
+	snprintf(msg, sizeof(msg), "(previous message repeated %d more times)", log_async.last_repeats);
+	log_deliver(log_async.last_level, msg);
+	log_async.last_repeats = 0;
+}
+
+///////////////////////////////////////////
+
+void log_thread_process(log_ level, const char *text) {
+	// When enabled, collapse runs of the same message into a single count,
+	// which is reported when something else gets logged, or every second or
+	// so.
+	if (log_dedup) {
+		size_t size = strlen(text) + 1;
+		if (log_async.last_text != nullptr && level == log_async.last_level && size == log_async.last_size && memcmp(text, log_async.last_text, size) == 0) {
+			if (log_async.last_repeats == 0)
+				log_async.last_repeat_time = stm_now();
+			log_async.last_repeats += 1;
+			return;
+		}
+		log_thread_flush_repeats();
+		if (size > log_async.last_size || log_async.last_text == nullptr)
+			log_async.last_text = sk_realloc_t(char, log_async.last_text, size);
+		memcpy(log_async.last_text, text, size);
+		log_async.last_size  = size;
+		log_async.last_level = level;
+	} else {
+		log_thread_flush_repeats();
+		log_async.last_size = 0;
+	}
+
+	// Token bucket rate limiting, errors always get through
+	if (log_async.rate_limit > 0 && level != log_error) {
+		uint64_t now = stm_now();
+		log_async.rate_tokens += stm_sec(stm_diff(now, log_async.rate_time)) * log_async.rate_limit;
+		log_async.rate_time    = now;
+		if (log_async.rate_tokens > log_async.rate_limit)
+			log_async.rate_tokens = log_async.rate_limit;
+
+		if (log_async.rate_tokens < 1) {
+			log_async.rate_dropped += 1;
+			return;
+		}
+		log_async.rate_tokens -= 1;
+	}
+	if (log_async.rate_dropped > 0) {
+		char msg[80];
+		snprintf(msg, sizeof(msg), "%d log messages were skipped by the rate limit", log_async.rate_dropped);
+		log_deliver(log_warning, msg);
+		log_async.rate_dropped = 0;
+	}
+
+	log_deliver(level, text);
+}
+
+///////////////////////////////////////////
+
+bool log_thread_has_work() {
+	int64_t pos = log_async.dequeue_pos;
+	return
+		log_async.slots[pos & (LOG_QUEUE_SIZE - 1)].sequence == pos + 1 ||
+		log_async.flush_requested != log_async.flush_completed           ||
+		log_async.rate_request    >= 0                                   ||
+		log_async.dropped          > 0                                   ||
+		log_async.running         == false;
+}
+
+///////////////////////////////////////////
+
+void log_thread_sleep() {
+	ft_mutex_lock(log_async.wake_mtx);
+	log_async.sleeping = true;
+	atomic_fence();
+	if (!log_thread_has_work()) {
+		// Repeated messages still need reporting after a second or so, even
+		// if nothing else comes along.
+		if (log_async.last_repeats > 0) ft_condition_wait_ms(log_async.wake, log_async.wake_mtx, 1000);
+		else                            ft_condition_wait   (log_async.wake, log_async.wake_mtx);
+	}
+	log_async.sleeping = false;
+	ft_mutex_unlock(log_async.wake_mtx);
+}
+
+///////////////////////////////////////////
+
+int32_t log_thread(void *) {
+	log_async.thread_id = ft_id_current();
+
+	while (true) {
+		int64_t     pos  = log_async.dequeue_pos;
+		log_slot_t *slot = &log_async.slots[pos & (LOG_QUEUE_SIZE - 1)];
+		int64_t     seq  = slot->sequence;
+		atomic_fence();
+
+		if (seq == pos + 1) {
+			log_thread_process(slot->level, slot->heap_text ? slot->heap_text : slot->text);
+			sk_free(slot->heap_text);
+
+			atomic_fence();
+			slot->sequence        = pos + LOG_QUEUE_SIZE;
+			log_async.dequeue_pos = pos + 1;
+			continue;
+		}
+
+		// Nothing is ready, so this is a good time for housekeeping
+		int64_t rate_request = log_async.rate_request;
+		if (rate_request >= 0 && atomic_cas64(&log_async.rate_request, rate_request, (int64_t)-1) == rate_request) {
+			log_async.rate_limit  = (int32_t)rate_request;
+			log_async.rate_tokens = log_async.rate_limit;
+			log_async.rate_time   = stm_now();
+		}
+		int64_t dropped = log_async.dropped;
+		if (dropped > 0) {
+			atomic_add64(&log_async.dropped, -dropped);
+			char msg[80];
+			snprintf(msg, sizeof(msg), "%d log messages were dropped while the log queue was full", (int32_t)dropped);
+			log_deliver(log_warning, msg);
+		}
+		int64_t request = log_async.flush_requested;
+		if (request != log_async.flush_completed) {
+			log_thread_flush_repeats();
+			log_async.flush_completed = request;
+		} else if (log_async.last_repeats > 0 && stm_sec(stm_since(log_async.last_repeat_time)) > 1) {
+			log_thread_flush_repeats();
+		}
+
+		if (!log_async.running && log_async.dequeue_pos == log_async.enqueue_pos)
+			break;
+		log_thread_sleep();
+	}
+	log_thread_flush_repeats();
+	log_async.thread_running = false;
+	return 0;
 }
 
 ///////////////////////////////////////////
@@ -211,11 +709,8 @@ char *make_variadic_string(const char* text, va_list args) {
 void log_writef(log_ level, const char *text, ...) {
 	va_list args;
 	va_start(args, text);
-	char* buffer = make_variadic_string(text, args);
+	log_writev(level, text, args);
 	va_end(args);
-
-	log_write(level, buffer);
-	sk_free(buffer);
 }
 
 ///////////////////////////////////////////
@@ -227,38 +722,26 @@ void log_err (const char* text) { log_write(log_error,      text); }
 void log_diagf(const char* text, ...) {
 	va_list args;
 	va_start(args, text);
-	char* buffer = make_variadic_string(text, args);
+	log_writev(log_diagnostic, text, args);
 	va_end(args);
-
-	log_write(log_diagnostic, buffer);
-	sk_free(buffer);
 }
 void log_infof(const char* text, ...) {
 	va_list args;
 	va_start(args, text);
-	char* buffer = make_variadic_string(text, args);
+	log_writev(log_inform, text, args);
 	va_end(args);
-
-	log_write(log_inform, buffer);
-	sk_free(buffer);
 }
 void log_warnf(const char* text, ...) {
 	va_list args;
 	va_start(args, text);
-	char* buffer = make_variadic_string(text, args);
+	log_writev(log_warning, text, args);
 	va_end(args);
-
-	log_write(log_warning, buffer);
-	sk_free(buffer);
 }
 void log_errf (const char* text, ...) {
 	va_list args;
 	va_start(args, text);
-	char* buffer = make_variadic_string(text, args);
+	log_writev(log_error, text, args);
 	va_end(args);
-
-	log_write(log_error, buffer);
-	sk_free(buffer);
 }
 
 ///////////////////////////////////////////
@@ -342,12 +825,16 @@ void log_subscribe_data(void (*log_callback)(void* context, log_ level, const ch
 	log_callback_t item = {};
 	item.callback = log_callback;
 	item.context  = context;
+
+	log_listeners_lock();
 	log_listeners.add(item);
+	log_listeners_unlock();
 }
 
 ///////////////////////////////////////////
 
 void log_unsubscribe_data(void (*log_callback)(void* context, log_ level, const char* text), void* context) {
+	log_listeners_lock();
 	for (int32_t i = 0; i < log_listeners.count; i++) {
 		if (log_listeners[i].callback == log_callback &&
 			log_listeners[i].context  == context) {
@@ -355,12 +842,15 @@ void log_unsubscribe_data(void (*log_callback)(void* context, log_ level, const
 			break;
 		}
 	}
+	log_listeners_unlock();
 }
 
 ///////////////////////////////////////////
 
 void log_clear_subscribers() {
+	log_listeners_lock();
 	log_listeners.free();
+	log_listeners_unlock();
 }
 
 ///////////////////////////////////////////
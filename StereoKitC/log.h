@@ -4,6 +4,9 @@
 
 namespace sk {
 
+void log_init        ();
+void log_shutdown    ();
+void log_step        ();
 void log_fail_reason (int32_t confidence, log_ log_as, const char *fail_reason);
 void log_fail_reasonf(int32_t confidence, log_ log_as, const char *fail_reason, ...);
 void log_show_any_fail_reason();
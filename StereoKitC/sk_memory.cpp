@@ -1,4 +1,6 @@
 #include "sk_memory.h"
+#include "libraries/ferr_thread.h"
+#include "libraries/atomic_util.h"
 
 #include <stdio.h>
 #include <stdlib.h>
@@ -178,4 +180,328 @@ void sk_mem_log_allocations() {
 }
 #endif
 
+///////////////////////////////////////////
+// Frame arena                           //
+///////////////////////////////////////////
+
+#define FRAME_ARENA_ALIGN    16
+#define FRAME_ARENA_MIN_SIZE (256 * 1024)
+
+struct frame_overflow_t {
+	frame_overflow_t *next;
+	size_t            bytes;
+};
+
+struct frame_arena_t {
+	uint8_t          *memory;
+	size_t            capacity;
+	size_t            used;
+	frame_overflow_t *overflow;
+	size_t            overflow_bytes;
+	size_t            high_water;
+	int32_t           frame;
+	frame_arena_t    *next;
+};
+
+struct frame_arena_state_t {
+	frame_arena_t *arenas;
+	int32_t        overflows;
+};
+static frame_arena_state_t frame_arena = {};
+// Only ever touched through atomic_util, since every thread checks these
+// on each allocation.
+static int32_t             frame_arena_frame      = 0;
+static int32_t             frame_arena_generation = 1;
+
+static thread_local frame_arena_t *frame_arena_tls     = nullptr;
+static thread_local int32_t        frame_arena_tls_gen = 0;
+
+///////////////////////////////////////////
+
+// Threads can hit their first allocation at the same time, so the lock
+// can't be created lazily by hand. It lives for the whole process.
+static ft_mutex_t frame_arena_mtx() {
+	static ft_mutex_t mtx = ft_mutex_create();
+	return mtx;
+}
+
+///////////////////////////////////////////
+
+// Only ever called by the thread that owns the arena, so nothing else can
+// be bumping through it at the same time.
+static void frame_arena_recycle(frame_arena_t *arena) {
+	size_t total = arena->used + arena->overflow_bytes;
+	if (total > arena->high_water)
+		arena->high_water = total;
+
+	if (arena->overflow != nullptr) {
+		atomic_increment(&frame_arena.overflows);
+		while (arena->overflow != nullptr) {
+			frame_overflow_t *next = arena->overflow->next;
+			sk_free(arena->overflow);
+			arena->overflow = next;
+		}
+
+		// Grow to fit everything from the last frame, so next time it all
+		// comes from the arena.
+		size_t capacity = arena->capacity;
+		while (capacity < total) capacity *= 2;
+		sk_free(arena->memory);
+		arena->memory   = (uint8_t*)sk_malloc(capacity);
+		arena->capacity = capacity;
+	}
+	arena->used           = 0;
+	arena->overflow_bytes = 0;
+}
+
+///////////////////////////////////////////
+
+static frame_arena_t *frame_arena_get() {
+	int32_t frame = atomic_load32(&frame_arena_frame);
+	if (frame_arena_tls != nullptr && frame_arena_tls_gen == atomic_load32(&frame_arena_generation)) {
+		if (frame_arena_tls->frame != frame) {
+			frame_arena_recycle(frame_arena_tls);
+			frame_arena_tls->frame = frame;
+		}
+		return frame_arena_tls;
+	}
+
+	frame_arena_t *arena = (frame_arena_t*)sk_calloc(sizeof(frame_arena_t));
+	arena->capacity = FRAME_ARENA_MIN_SIZE;
+	arena->memory   = (uint8_t*)sk_malloc(arena->capacity);
+	arena->frame    = frame;
+
+	ft_mutex_lock(frame_arena_mtx());
+	arena->next        = frame_arena.arenas;
+	frame_arena.arenas = arena;
+	frame_arena_tls_gen = atomic_load32(&frame_arena_generation);
+	ft_mutex_unlock(frame_arena_mtx());
+
+	frame_arena_tls = arena;
+	return arena;
+}
+
+///////////////////////////////////////////
+
+void *sk_frame_alloc(size_t bytes) {
+	frame_arena_t *arena = frame_arena_get();
+	bytes = (bytes + (FRAME_ARENA_ALIGN - 1)) & ~(size_t)(FRAME_ARENA_ALIGN - 1);
+
+	if (arena->used + bytes <= arena->capacity) {
+		void *result = arena->memory + arena->used;
+		arena->used += bytes;
+		return result;
+	}
+
+	// Out of room, so this one goes on the heap until the next reset. The
+	// header is padded to keep the allocation aligned.
+	size_t            header   = (sizeof(frame_overflow_t) + (FRAME_ARENA_ALIGN - 1)) & ~(size_t)(FRAME_ARENA_ALIGN - 1);
+	frame_overflow_t *overflow = (frame_overflow_t*)sk_malloc(header + bytes);
+	overflow->next  = arena->overflow;
+	overflow->bytes = bytes;
+	arena->overflow        = overflow;
+	arena->overflow_bytes += bytes;
+	return ((uint8_t*)overflow) + header;
+}
+
+///////////////////////////////////////////
+
+void sk_frame_reset() {
+	// Arenas belong to their threads, so this just starts a new frame. Each
+	// thread recycles its own arena the next time it allocates.
+	atomic_increment(&frame_arena_frame);
+}
+
+///////////////////////////////////////////
+
+void sk_frame_shutdown() {
+	ft_mutex_lock(frame_arena_mtx());
+	while (frame_arena.arenas != nullptr) {
+		frame_arena_t *next = frame_arena.arenas->next;
+		while (frame_arena.arenas->overflow != nullptr) {
+			frame_overflow_t *next_overflow = frame_arena.arenas->overflow->next;
+			sk_free(frame_arena.arenas->overflow);
+			frame_arena.arenas->overflow = next_overflow;
+		}
+		sk_free(frame_arena.arenas->memory);
+		sk_free(frame_arena.arenas);
+		frame_arena.arenas = next;
+	}
+	frame_arena = {};
+
+	// Any thread still holding an arena will notice it's out of date
+	atomic_increment(&frame_arena_generation);
+	ft_mutex_unlock(frame_arena_mtx());
+}
+
+///////////////////////////////////////////
+
+// Arenas are owned by other threads, so this is only exact once they've
+// stopped allocating, like at shutdown. The high water mark adds up each
+// thread's own peak.
+void sk_frame_stats(size_t *out_used, size_t *out_high_water, int32_t *out_overflows) {
+	size_t used       = 0;
+	size_t high_water = 0;
+	ft_mutex_lock(frame_arena_mtx());
+	for (frame_arena_t *arena = frame_arena.arenas; arena != nullptr; arena = arena->next) {
+		size_t total = arena->used + arena->overflow_bytes;
+		used       += total;
+		high_water += arena->high_water > total ? arena->high_water : total;
+	}
+	ft_mutex_unlock(frame_arena_mtx());
+
+	if (out_used      ) *out_used       = used;
+	if (out_high_water) *out_high_water = high_water;
+	if (out_overflows ) *out_overflows  = atomic_load32(&frame_arena.overflows);
+}
+
+///////////////////////////////////////////
+// Tagged memory accounting              //
+///////////////////////////////////////////
+
+// Kept at 16 bytes so tagged allocations keep malloc's usual alignment
+struct mem_tag_header_t {
+	int64_t bytes;
+	int64_t tag;
+};
+
+struct mem_tag_state_t {
+	volatile int64_t current[memory_tag_max];
+	volatile int64_t peak   [memory_tag_max];
+	volatile int64_t budget [memory_tag_max];
+	// The callback and its context are only touched under
+	// mem_tag_callback_mutex, so they're always read and written as a pair.
+	void           (*on_exceeded)(void *context, memory_tag_ tag, int64_t current_bytes, int64_t budget_bytes);
+	void            *on_exceeded_context;
+};
+static mem_tag_state_t mem_tags = {};
+
+///////////////////////////////////////////
+
+ft_mutex_t mem_tag_callback_mutex() {
+	static ft_mutex_t mtx = ft_mutex_create();
+	return mtx;
+}
+
+///////////////////////////////////////////
+
+void sk_mem_tag_track(memory_tag_ tag, int64_t bytes) {
+	if (tag < 0 || tag >= memory_tag_max || bytes == 0) return;
+
+	int64_t curr = atomic_add64(&mem_tags.current[tag], bytes);
+	if (bytes < 0) return;
+
+	int64_t peak = mem_tags.peak[tag];
+	while (curr > peak) {
+		int64_t prev = atomic_cas64(&mem_tags.peak[tag], peak, curr);
+		if (prev == peak) break;
+		peak = prev;
+	}
+
+	// Only report when crossing the budget, rather than on every allocation
+	// past it.
+	int64_t budget = atomic_load64(&mem_tags.budget[tag]);
+	if (budget <= 0 || curr <= budget || curr - bytes > budget) return;
+
+	// Copy the pair out so the callback runs unlocked, and is free to
+	// allocate or swap itself out.
+	ft_mutex_t mtx = mem_tag_callback_mutex();
+	ft_mutex_lock(mtx);
+	void (*on_exceeded)(void *, memory_tag_, int64_t, int64_t) = mem_tags.on_exceeded;
+	void  *context                                             = mem_tags.on_exceeded_context;
+	ft_mutex_unlock(mtx);
+
+	if (on_exceeded != nullptr)
+		on_exceeded(context, tag, curr, budget);
+}
+
+///////////////////////////////////////////
+
+void *sk_malloc_tag(memory_tag_ tag, size_t bytes) {
+	mem_tag_header_t *header = (mem_tag_header_t*)sk_malloc(sizeof(mem_tag_header_t) + bytes);
+	header->bytes = (int64_t)bytes;
+	header->tag   = tag;
+	sk_mem_tag_track(tag, (int64_t)bytes);
+	return header + 1;
+}
+
+///////////////////////////////////////////
+
+void *sk_calloc_tag(memory_tag_ tag, size_t bytes) {
+	mem_tag_header_t *header = (mem_tag_header_t*)sk_calloc(sizeof(mem_tag_header_t) + bytes);
+	header->bytes = (int64_t)bytes;
+	header->tag   = tag;
+	sk_mem_tag_track(tag, (int64_t)bytes);
+	return header + 1;
+}
+
+///////////////////////////////////////////
+
+void *sk_realloc_tag(memory_tag_ tag, void *memory, size_t bytes) {
+	if (memory == nullptr) return sk_malloc_tag(tag, bytes);
+
+	mem_tag_header_t *header    = ((mem_tag_header_t*)memory) - 1;
+	int64_t           old_bytes = header->bytes;
+	memory_tag_       old_tag   = (memory_tag_)header->tag;
+
+	header = (mem_tag_header_t*)sk_realloc(header, sizeof(mem_tag_header_t) + bytes);
+	header->bytes = (int64_t)bytes;
+	header->tag   = tag;
+	// Staying in the same category only counts the change in size, so a
+	// realloc that's already over budget doesn't dip under and cross it
+	// again.
+	if (old_tag == tag) {
+		sk_mem_tag_track(tag, (int64_t)bytes - old_bytes);
+	} else {
+		sk_mem_tag_track(old_tag, -old_bytes);
+		sk_mem_tag_track(tag,     (int64_t)bytes);
+	}
+	return header + 1;
+}
+
+///////////////////////////////////////////
+
+void _sk_free_tag(void *memory) {
+	if (memory == nullptr) return;
+
+	mem_tag_header_t *header = ((mem_tag_header_t*)memory) - 1;
+	sk_mem_tag_track((memory_tag_)header->tag, -header->bytes);
+	sk_free(header);
+}
+
+///////////////////////////////////////////
+
+int64_t memory_get_current(memory_tag_ tag) {
+	return tag >= 0 && tag < memory_tag_max ? mem_tags.current[tag] : 0;
+}
+
+///////////////////////////////////////////
+
+int64_t memory_get_peak(memory_tag_ tag) {
+	return tag >= 0 && tag < memory_tag_max ? mem_tags.peak[tag] : 0;
+}
+
+///////////////////////////////////////////
+
+void memory_set_budget(memory_tag_ tag, int64_t budget_bytes) {
+	if (tag < 0 || tag >= memory_tag_max) return;
+	atomic_store64(&mem_tags.budget[tag], budget_bytes);
+}
+
+///////////////////////////////////////////
+
+int64_t memory_get_budget(memory_tag_ tag) {
+	return tag >= 0 && tag < memory_tag_max ? atomic_load64(&mem_tags.budget[tag]) : 0;
+}
+
+///////////////////////////////////////////
+
+void memory_on_budget_exceeded(void (*on_exceeded)(void *context, memory_tag_ tag, int64_t current_bytes, int64_t budget_bytes), void *context) {
+	ft_mutex_t mtx = mem_tag_callback_mutex();
+	ft_mutex_lock(mtx);
+	mem_tags.on_exceeded_context = context;
+	mem_tags.on_exceeded         = on_exceeded;
+	ft_mutex_unlock(mtx);
+}
+
 } // namespace sk
\ No newline at end of file
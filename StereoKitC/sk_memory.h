@@ -6,6 +6,7 @@
 
 #pragma once
 
+#include "stereokit.h"
 #include <stdint.h>
 #include <stddef.h>
 #if defined(_WIN32) || defined(WINDOWS_UWP)
@@ -51,6 +52,37 @@ void  _sk_free_d      (void *memory, const char* filename, int32_t line);
 
 void sk_mem_log_allocations();
 
+// Transient allocations that only live until the end of the current frame.
+// There's no need to free these, sk_step_end releases all of them at once.
+// Each thread bumps through its own arena, and recycles it on its first
+// allocation of a new frame. So this is only for threads that stay in sync
+// with the frame, like the main thread and job workers, never asset
+// threads. If an arena runs out of room, the allocation falls back to the
+// heap, and the arena grows to fit at the next reset.
+void *sk_frame_alloc   (size_t bytes);
+void  sk_frame_reset   ();
+void  sk_frame_shutdown();
+void  sk_frame_stats   (size_t *out_used, size_t *out_high_water, int32_t *out_overflows);
+
+#define sk_frame_alloc_t(T, count) ((T*)sk_frame_alloc((count) * sizeof(T)))
+
+// Tagged allocations are counted against a memory_tag_, and must only ever
+// be released with sk_free_tag, since the size and tag are stored just in
+// front of the memory. For memory that comes from elsewhere, like a file
+// loaded by the platform, sk_mem_tag_track can adjust a tag's count
+// directly instead.
+void *sk_malloc_tag   (memory_tag_ tag, size_t bytes);
+void *sk_calloc_tag   (memory_tag_ tag, size_t bytes);
+void *sk_realloc_tag  (memory_tag_ tag, void *memory, size_t bytes);
+void  _sk_free_tag    (void *memory);
+void  sk_mem_tag_track(memory_tag_ tag, int64_t bytes);
+
+#define sk_free_tag(memory) { _sk_free_tag(memory); memory = nullptr; };
+
+#define sk_malloc_tag_t(tag, T, count) ((T*)sk_malloc_tag(tag, (count) * sizeof(T)))
+#define sk_calloc_tag_t(tag, T, count) ((T*)sk_calloc_tag(tag, (count) * sizeof(T)))
+#define sk_realloc_tag_t(tag, T, memory, count) ((T*)sk_realloc_tag(tag, memory, (count) * sizeof(T)))
+
 #pragma warning(disable : 6255) // _alloca` indicates failure by raising a stack overflow exception. Consider using _malloca instead.
 #define sk_stack_alloc(bytes) (alloca(bytes))
 #define sk_stack_alloc_t(T, count) ((T*)sk_stack_alloc ((count) * sizeof(T)))
@@ -1,6 +1,12 @@
 #include "spherical_harmonics.h"
 #include "sk_math.h"
+#include "sk_math_dx.h"
+#include "sk_memory.h"
 #include "asset_types/texture_.h"
+#include "libraries/array.h"
+#include "libraries/ferr_thread.h"
+
+using namespace DirectX;
 
 namespace sk {
 
@@ -9,9 +15,44 @@ void sh_windowing(spherical_harmonics_t &harmonics, float window_width);
 
 ///////////////////////////////////////////
 
-vec3 to_color_128(uint8_t *color) { return *(vec3 *)color; }
-vec3 to_color_32 (uint8_t *color) { return vec3{color[0]/255.f,color[1]/255.f,color[2]/255.f}; }
-vec3 to_color_32_linear(uint8_t *color) { return vec3{ powf(color[0] / 255.f,2.2f),powf(color[1] / 255.f,2.2f),powf(color[2] / 255.f,2.2f) }; }
+// Per-texel SH basis values for every texel of a cubemap of a particular
+// face size. Texel direction and the averaging weight are both folded in,
+// so projecting a cubemap is just a multiply-add of each color against 9
+// weights.
+struct sh_basis_table_t {
+	int32_t face_size;
+	float  *basis;
+};
+
+// Tables get big quickly, 9 floats per texel, so we only keep the smaller
+// ones around. SH lighting is calculated from a 32x32 or smaller mip anyhow.
+array_t<sh_basis_table_t> sh_tables                = {};
+ft_mutex_t                sh_tables_mtx            = {};
+float                     sh_srgb_to_linear[256];
+
+///////////////////////////////////////////
+
+void sh_init() {
+	sh_tables_mtx = ft_mutex_create();
+	for (int32_t i = 0; i < 256; i++)
+		sh_srgb_to_linear[i] = powf(i / 255.f, 2.2f);
+}
+
+///////////////////////////////////////////
+
+void sh_shutdown() {
+	for (int32_t i = 0; i < sh_tables.count; i++)
+		sk_free(sh_tables[i].basis);
+	sh_tables.free();
+	ft_mutex_destroy(&sh_tables_mtx);
+}
+
+///////////////////////////////////////////
+
+template <tex_format_ format> inline XMVECTOR sh_load_color(const uint8_t *texel);
+template <> inline XMVECTOR sh_load_color<tex_format_rgba128      >(const uint8_t *texel) { return XMLoadFloat4((const XMFLOAT4 *)texel); }
+template <> inline XMVECTOR sh_load_color<tex_format_rgba32       >(const uint8_t *texel) { return XMVectorSet(sh_srgb_to_linear[texel[0]], sh_srgb_to_linear[texel[1]], sh_srgb_to_linear[texel[2]], 0); }
+template <> inline XMVECTOR sh_load_color<tex_format_rgba32_linear>(const uint8_t *texel) { return XMVectorSet(texel[0] / 255.f, texel[1] / 255.f, texel[2] / 255.f, 0); }
 
 ///////////////////////////////////////////
 
@@ -53,8 +94,10 @@ void sh_brightness(spherical_harmonics_t &harmonics, float scale) {
 
 ///////////////////////////////////////////
 
-void sh_add(spherical_harmonics_t &to, vec3 light_dir, vec3 light_color) {
-	light_dir = { -light_dir.x, -light_dir.y, light_dir.z };
+// Evaluates the 9 SH basis functions for a direction, in the same order and
+// orientation as sh_add uses, with the cosine lobe convolution included.
+inline void sh_eval_basis(vec3 dir, float *out_basis_9) {
+	dir = { -dir.x, -dir.y, dir.z };
 
 	// From DirectXMath's XMSHEvalDirectionalLight. See:
 	// https://github.com/microsoft/DirectXMath/blob/master/SHMath/DirectXSH.cpp#L4476
@@ -63,78 +106,174 @@ void sh_add(spherical_harmonics_t &to, vec3 light_dir, vec3 light_color) {
 	const float fCW0 = 0.25f;
 	const float fCW1 = 0.5f;
 	const float fRet = MATH_PI / (fCW0 + fCW1);
-	light_color = light_color * fRet;
 
 	// The rest is a mix of XMSHEvalDirectionalLight, XMSHEvalDirection, and
 	// sh_eval_basis_2
-	const float z2 = light_dir.z*light_dir.z;
-	const float s1 = light_dir.y;
-	const float c1 = light_dir.x;
-	const float s2 = light_dir.x*s1 + light_dir.y*c1;
-	const float c2 = light_dir.x*c1 - light_dir.y*s1;
+	const float z2 = dir.z*dir.z;
+	const float s1 = dir.y;
+	const float c1 = dir.x;
+	const float s2 = dir.x*s1 + dir.y*c1;
+	const float c2 = dir.x*c1 - dir.y*s1;
+	const float p_2_1 = -1.092548430592079200f*dir.z;
+
+	out_basis_9[0] = fRet *  0.282094791773878140f;
+	out_basis_9[1] = fRet * -0.488602511902919920f*s1;
+	out_basis_9[2] = fRet *  0.488602511902919920f*dir.z;
+	out_basis_9[3] = fRet * -0.488602511902919920f*c1;
+	out_basis_9[4] = fRet *  0.546274215296039590f*s2;
+	out_basis_9[5] = fRet *  p_2_1*s1;
+	out_basis_9[6] = fRet * (0.946174695757560080f*z2 + -0.315391565252520050f);
+	out_basis_9[7] = fRet *  p_2_1*c1;
+	out_basis_9[8] = fRet *  0.546274215296039590f*c2;
+}
+
+///////////////////////////////////////////
 
-	to.coefficients[0] += light_color * 0.282094791773878140f;
-	to.coefficients[2] += light_color * 0.488602511902919920f*light_dir.z;
-	to.coefficients[6] += light_color * (0.946174695757560080f*z2 + -0.315391565252520050f);
-	to.coefficients[1] += light_color * -0.488602511902919920f*s1;
-	to.coefficients[3] += light_color * -0.488602511902919920f*c1;
-	const float p_2_1 = -1.092548430592079200f*light_dir.z;
-	to.coefficients[5] += light_color * p_2_1*s1;
-	to.coefficients[7] += light_color * p_2_1*c1;
-	to.coefficients[4] += light_color * 0.546274215296039590f*s2;
-	to.coefficients[8] += light_color * 0.546274215296039590f*c2;
+void sh_add(spherical_harmonics_t &to, vec3 light_dir, vec3 light_color) {
+	float basis[9];
+	sh_eval_basis(light_dir, basis);
+	for (int32_t i = 0; i < 9; i++)
+		to.coefficients[i] += light_color * basis[i];
 }
 
 ///////////////////////////////////////////
 
-spherical_harmonics_t sh_calculate(void **env_map_data, tex_format_ format, int32_t face_size) {
-	spherical_harmonics_t result   = {};
-	size_t                col_size = 0;
-	vec3     (*convert)(uint8_t *) = nullptr;
-	switch (format) {
-	case tex_format_rgba128:       convert = to_color_128;       col_size = sizeof(float) * 4; break;
-	case tex_format_rgba32:        convert = to_color_32_linear; col_size = sizeof(color32); break;
-	case tex_format_rgba32_linear: convert = to_color_32;        col_size = sizeof(color32); break;
-	default: return {};
+// Basis values for a single cubemap texel, pre-divided so that summing
+// every texel of the cubemap averages them all together.
+void sh_texel_basis(int32_t face, int32_t x, int32_t y, int32_t face_size, float *out_basis_9) {
+	float half_px = 0.5f / face_size;
+	float weight  = 1.0f / (face_size * face_size * 6.0f);
+	float py      = 1 - (y / (float)face_size + half_px);
+	float px      =      x / (float)face_size + half_px;
+
+	// Top face is flipped on both axes
+	if (face == 2) {
+		py = 1 - py;
+		px = 1 - px;
 	}
 
-	float half_px = 0.5f / face_size;
-	for (int32_t i = 0; i < 6; i++) {
-		uint8_t *data = (uint8_t*)env_map_data[i];
-		vec3 p1 = math_cubemap_corner(i * 4);
-		vec3 p2 = math_cubemap_corner(i * 4+1);
-		vec3 p3 = math_cubemap_corner(i * 4+2);
-		vec3 p4 = math_cubemap_corner(i * 4+3); 
+	vec3 pl = vec3_lerp(math_cubemap_corner(face * 4  ), math_cubemap_corner(face * 4+3), py);
+	vec3 pr = vec3_lerp(math_cubemap_corner(face * 4+1), math_cubemap_corner(face * 4+2), py);
+	vec3 pt = vec3_normalize(vec3_lerp(pl, pr, px));
 
-		for (int32_t y = 0; y < face_size; y++) {
-			float py = 1 - (y / (float)face_size + half_px);
+	sh_eval_basis(pt, out_basis_9);
+	for (int32_t b = 0; b < 9; b++)
+		out_basis_9[b] *= weight;
+}
 
-			// Top face is flipped on both axes
-			if (i == 2) {
-				py = 1 - py;
-			}
-			for (int32_t x = 0; x < face_size; x++) {
-				float px = x / (float)face_size + half_px;
+///////////////////////////////////////////
 
-				// Top face is flipped on both axes
-				if (i == 2) {
-					px = 1 - px;
-				}
+float *sh_build_basis(int32_t face_size) {
+	float *result = sk_malloc_t(float, face_size * face_size * 6 * 9);
+	for (int32_t f = 0; f < 6; f++) {
+		for (int32_t y = 0; y < face_size; y++) {
+			for (int32_t x = 0; x < face_size; x++) {
+				sh_texel_basis(f, x, y, face_size, &result[((f * face_size + y) * face_size + x) * 9]);
+			}
+		}
+	}
+	return result;
+}
 
-				vec3 pl = vec3_lerp(p1, p4, py);
-				vec3 pr = vec3_lerp(p2, p3, py);
-				vec3 pt = vec3_lerp(pl, pr, px);
-				pt = vec3_normalize(pt);
+///////////////////////////////////////////
 
-				vec3 color = convert(&data[(x + y * face_size) * col_size]);
-				sh_add(result, pt, color);
-			}
+// Tables are cached for the life of the app. tex_get_cubemap_lighting only
+// ever asks for a 32px or smaller mip, so there's only ever a few small ones.
+const float *sh_get_basis(int32_t face_size) {
+	ft_mutex_lock(sh_tables_mtx);
+	const float *result = nullptr;
+	for (int32_t i = 0; i < sh_tables.count; i++) {
+		if (sh_tables[i].face_size == face_size) {
+			result = sh_tables[i].basis;
+			break;
 		}
 	}
+	if (result == nullptr) {
+		sh_basis_table_t table = {};
+		table.face_size = face_size;
+		table.basis     = sh_build_basis(face_size);
+		sh_tables.add(table);
+		result = table.basis;
+	}
+	ft_mutex_unlock(sh_tables_mtx);
+	return result;
+}
 
-	float count = face_size * face_size * 6.f;
-	for (int32_t i = 0; i < 9; i++)
-		result.coefficients[i] /= count;
+///////////////////////////////////////////
+
+struct sh_project_t {
+	void       **faces;
+	tex_format_  format;
+	int32_t      face_size;
+	const float *basis;
+	XMFLOAT4     face_sums[6][9];
+};
+
+template <tex_format_ format, size_t texel_size>
+void sh_project_texels(const uint8_t *texels, const float *basis, int32_t count, XMFLOAT4 *out_sums_9) {
+	XMVECTOR sum[9];
+	for (int32_t b = 0; b < 9; b++)
+		sum[b] = XMVectorZero();
+
+	for (int32_t t = 0; t < count; t++) {
+		XMVECTOR     color   = sh_load_color<format>(texels + t * texel_size);
+		const float *weights = basis + t * 9;
+		sum[0] = XMVectorMultiplyAdd(color, XMVectorReplicatePtr(&weights[0]), sum[0]);
+		sum[1] = XMVectorMultiplyAdd(color, XMVectorReplicatePtr(&weights[1]), sum[1]);
+		sum[2] = XMVectorMultiplyAdd(color, XMVectorReplicatePtr(&weights[2]), sum[2]);
+		sum[3] = XMVectorMultiplyAdd(color, XMVectorReplicatePtr(&weights[3]), sum[3]);
+		sum[4] = XMVectorMultiplyAdd(color, XMVectorReplicatePtr(&weights[4]), sum[4]);
+		sum[5] = XMVectorMultiplyAdd(color, XMVectorReplicatePtr(&weights[5]), sum[5]);
+		sum[6] = XMVectorMultiplyAdd(color, XMVectorReplicatePtr(&weights[6]), sum[6]);
+		sum[7] = XMVectorMultiplyAdd(color, XMVectorReplicatePtr(&weights[7]), sum[7]);
+		sum[8] = XMVectorMultiplyAdd(color, XMVectorReplicatePtr(&weights[8]), sum[8]);
+	}
+
+	for (int32_t b = 0; b < 9; b++)
+		XMStoreFloat4(&out_sums_9[b], sum[b]);
+}
+
+///////////////////////////////////////////
+
+void sh_project_face(int32_t face, void *context) {
+	sh_project_t  *project = (sh_project_t *)context;
+	const uint8_t *texels  = (const uint8_t *)project->faces[face];
+	int32_t        size    = project->face_size;
+	const float   *basis   = project->basis + face * size * size * 9;
+	XMFLOAT4      *sums    = project->face_sums[face];
+
+	switch (project->format) {
+	case tex_format_rgba128:       sh_project_texels<tex_format_rgba128,       sizeof(float) * 4>(texels, basis, size * size, sums); break;
+	case tex_format_rgba32:        sh_project_texels<tex_format_rgba32,        sizeof(color32)  >(texels, basis, size * size, sums); break;
+	case tex_format_rgba32_linear: sh_project_texels<tex_format_rgba32_linear, sizeof(color32)  >(texels, basis, size * size, sums); break;
+	default: break;
+	}
+}
+
+///////////////////////////////////////////
+
+spherical_harmonics_t sh_calculate(void **env_map_data, tex_format_ format, int32_t face_size) {
+	if (format != tex_format_rgba128 && format != tex_format_rgba32 && format != tex_format_rgba32_linear)
+		return {};
+
+	sh_project_t project = {};
+	project.faces     = env_map_data;
+	project.format    = format;
+	project.face_size = face_size;
+	project.basis     = sh_get_basis(face_size);
+
+	// tex_get_cubemap_lighting only ever hands us a 32px or smaller mip,
+	// which is done well before worker threads could even wake up.
+	for (int32_t i = 0; i < 6; i++)
+		sh_project_face(i, &project);
+
+	spherical_harmonics_t result = {};
+	for (int32_t f = 0; f < 6; f++) {
+		for (int32_t i = 0; i < 9; i++) {
+			const XMFLOAT4 &sum = project.face_sums[f][i];
+			result.coefficients[i] += vec3{ sum.x, sum.y, sum.z };
+		}
+	}
 
 	// Apply windowing to prevent overshooting
 	sh_windowing(result, .01f);
@@ -11,11 +11,13 @@
 #include "libraries/sokol_time.h"
 #include "libraries/ferr_thread.h"
 #include "utils/random.h"
+#include "utils/jobs.h"
 
 #include "systems/render.h"
 #include "systems/input.h"
 #include "systems/physics.h"
 #include "systems/system.h"
+#include "systems/profiler.h"
 #include "systems/text.h"
 #include "systems/audio.h"
 #include "systems/sprite_drawer.h"
@@ -144,9 +146,19 @@ bool32_t sk_init(sk_settings_t settings) {
 	log_diagf("Initializing StereoKit v%s...", sk_version_name());
 
 	stm_setup();
+	log_init();
 	sk_step_timer();
 	local.frame = 0;
 	rand_set_seed((uint32_t)stm_now());
+	profiler_init();
+	jobs_init();
+
+	// Systems step in waves based on their step dependencies, and anything
+	// in the same wave may run on a worker thread at the same time. Systems
+	// that touch the GPU, the render list, or UI/hierarchy state need to be
+	// flagged as main_thread. Initialization works the same way with the
+	// init dependencies, and anything that creates GPU resources directly
+	// or talks to the platform is flagged as main_thread_init.
 
 	// Platform related systems
 	system_t sys_platform         = { "Platform"    };
@@ -155,10 +167,13 @@ bool32_t sk_init(sk_settings_t settings) {
 
 	system_set_step_deps(sys_platform_render, "App", "Text", "Sprites", "Lines", "World", "UILate", "Animation");
 
-	sys_platform       .func_initialize = platform_init;
-	sys_platform       .func_shutdown   = platform_shutdown;
-	sys_platform_begin .func_step       = platform_step_begin;
-	sys_platform_render.func_step       = platform_step_end;
+	sys_platform       .func_initialize  = platform_init;
+	sys_platform       .func_shutdown    = platform_shutdown;
+	sys_platform_begin .func_step        = platform_step_begin;
+	sys_platform_render.func_step        = platform_step_end;
+	sys_platform       .main_thread_init = true;
+	sys_platform_begin .main_thread      = true;
+	sys_platform_render.main_thread      = true;
 
 	systems_add(&sys_platform);
 	systems_add(&sys_platform_begin);
@@ -167,21 +182,25 @@ bool32_t sk_init(sk_settings_t settings) {
 	// Rest of the systems
 	system_t sys_defaults = { "Defaults" };
 	system_set_initialize_deps(sys_defaults, "Platform", "Assets");
-	sys_defaults.func_initialize = defaults_init;
-	sys_defaults.func_shutdown   = defaults_shutdown;
+	sys_defaults.func_initialize  = defaults_init;
+	sys_defaults.func_shutdown    = defaults_shutdown;
+	sys_defaults.main_thread_init = true;
 	systems_add(&sys_defaults);
 
 	system_t sys_ui = { "UI" };
 	system_set_initialize_deps(sys_ui, "Defaults");
 	system_set_step_deps      (sys_ui, "Input", "FrameBegin");
-	sys_ui.func_initialize = ui_init;
-	sys_ui.func_step       = ui_step;
-	sys_ui.func_shutdown   = ui_shutdown;
+	sys_ui.func_initialize  = ui_init;
+	sys_ui.func_step        = ui_step;
+	sys_ui.func_shutdown    = ui_shutdown;
+	sys_ui.main_thread      = true;
+	sys_ui.main_thread_init = true;
 	systems_add(&sys_ui);
 
 	system_t sys_ui_late = { "UILate" };
 	system_set_step_deps(sys_ui_late, "App", "Tools");
-	sys_ui_late.func_step = ui_step_late;
+	sys_ui_late.func_step   = ui_step_late;
+	sys_ui_late.main_thread = true;
 	systems_add(&sys_ui_late);
 
 	system_t sys_physics = { "Physics" };
@@ -195,9 +214,11 @@ bool32_t sk_init(sk_settings_t settings) {
 	system_t sys_renderer = { "Renderer" };
 	system_set_initialize_deps(sys_renderer, "Platform", "Defaults");
 	system_set_step_deps      (sys_renderer, "Physics", "FrameBegin");
-	sys_renderer.func_initialize = render_init;
-	sys_renderer.func_step       = render_step;
-	sys_renderer.func_shutdown   = render_shutdown;
+	sys_renderer.func_initialize  = render_init;
+	sys_renderer.func_step        = render_step;
+	sys_renderer.func_shutdown    = render_shutdown;
+	sys_renderer.main_thread      = true;
+	sys_renderer.main_thread_init = true;
 	systems_add(&sys_renderer);
 
 	system_t sys_assets = { "Assets" };
@@ -206,6 +227,7 @@ bool32_t sk_init(sk_settings_t settings) {
 	sys_assets.func_initialize       = assets_init;
 	sys_assets.func_step             = assets_step;
 	sys_assets.func_shutdown         = assets_shutdown;
+	sys_assets.main_thread           = true;
 	systems_add(&sys_assets);
 
 	system_t sys_audio = { "Audio" };
@@ -219,9 +241,10 @@ bool32_t sk_init(sk_settings_t settings) {
 	system_t sys_input = { "Input" };
 	system_set_initialize_deps(sys_input, "Platform", "Defaults");
 	system_set_step_deps      (sys_input, "FrameBegin");
-	sys_input.func_initialize = input_init;
-	//sys_input.func_step       = input_step; // Handled by the platform, not my fav solution
-	sys_input.func_shutdown   = input_shutdown;
+	sys_input.func_initialize  = input_init;
+	//sys_input.func_step        = input_step; // Handled by the platform, not my fav solution
+	sys_input.func_shutdown    = input_shutdown;
+	sys_input.main_thread_init = true;
 	systems_add(&sys_input);
 
 	system_t sys_text = { "Text" };
@@ -229,49 +252,65 @@ bool32_t sk_init(sk_settings_t settings) {
 	system_set_step_deps      (sys_text, "App");
 	sys_text.func_step     = text_step;
 	sys_text.func_shutdown = text_shutdown;
+	sys_text.main_thread   = true;
 	systems_add(&sys_text);
 
 	system_t sys_sprite = { "Sprites" };
 	system_set_initialize_deps(sys_sprite, "Defaults");
 	system_set_step_deps      (sys_sprite, "App", "Tools");
-	sys_sprite.func_initialize = sprite_drawer_init;
-	sys_sprite.func_step       = sprite_drawer_step;
-	sys_sprite.func_shutdown   = sprite_drawer_shutdown;
+	sys_sprite.func_initialize  = sprite_drawer_init;
+	sys_sprite.func_step        = sprite_drawer_step;
+	sys_sprite.func_shutdown    = sprite_drawer_shutdown;
+	sys_sprite.main_thread      = true;
+	sys_sprite.main_thread_init = true;
 	systems_add(&sys_sprite);
 
 	system_t sys_lines = { "Lines" };
 	system_set_initialize_deps(sys_lines, "Defaults");
 	system_set_step_deps      (sys_lines, "App");
-	sys_lines.func_initialize = line_drawer_init;
-	sys_lines.func_step       = line_drawer_step;
-	sys_lines.func_shutdown   = line_drawer_shutdown;
+	sys_lines.func_initialize  = line_drawer_init;
+	sys_lines.func_step        = line_drawer_step;
+	sys_lines.func_shutdown    = line_drawer_shutdown;
+	sys_lines.main_thread      = true;
+	sys_lines.main_thread_init = true;
 	systems_add(&sys_lines);
 
 	system_t sys_world = { "World" };
 	system_set_initialize_deps(sys_world, "Platform", "Defaults", "Renderer");
 	system_set_step_deps      (sys_world, "Platform", "App");
-	sys_world.func_initialize = world_init;
-	sys_world.func_step       = world_step;
-	sys_world.func_shutdown   = world_shutdown;
+	sys_world.func_initialize  = world_init;
+	sys_world.func_step        = world_step;
+	sys_world.func_shutdown    = world_shutdown;
+	sys_world.main_thread      = true;
+	sys_world.main_thread_init = true;
 	systems_add(&sys_world);
 
 	system_t sys_tools = { "Tools" };
 	system_set_initialize_deps(sys_tools, "Platform", "Defaults", "UI");
 	system_set_step_deps      (sys_tools, "App");
-	sys_tools.func_initialize = tools_init;
-	sys_tools.func_step       = tools_step;
-	sys_tools.func_shutdown   = tools_shutdown;
+	sys_tools.func_initialize  = tools_init;
+	sys_tools.func_step        = tools_step;
+	sys_tools.func_shutdown    = tools_shutdown;
+	sys_tools.main_thread      = true;
+	sys_tools.main_thread_init = true;
 	systems_add(&sys_tools);
 
+	system_t sys_anim_begin = { "AnimationBegin" };
+	system_set_step_deps(sys_anim_begin, "FrameBegin");
+	sys_anim_begin.func_step = anim_step_begin;
+	systems_add(&sys_anim_begin);
+
 	system_t sys_anim = { "Animation" };
 	system_set_step_deps(sys_anim, "App");
 	sys_anim.func_step     = anim_step;
 	sys_anim.func_shutdown = anim_shutdown;
+	sys_anim.main_thread   = true;
 	systems_add(&sys_anim);
 
 	system_t sys_app = { "App" };
-	system_set_step_deps(sys_app, "Input", "Defaults", "FrameBegin", "Platform", "Physics", "Renderer", "UI");
-	sys_app.func_step = sk_app_step;
+	system_set_step_deps(sys_app, "Input", "Defaults", "FrameBegin", "Platform", "Physics", "Renderer", "UI", "AnimationBegin");
+	sys_app.func_step   = sk_app_step;
+	sys_app.main_thread = true;
 	systems_add(&sys_app);
 
 	local.initialized = systems_initialize();
@@ -311,7 +350,16 @@ void sk_shutdown_unsafe(void) {
 	log_show_any_fail_reason();
 
 	systems_shutdown      ();
+	jobs_shutdown         ();
+	profiler_shutdown     ();
+
+	size_t  frame_high_water = 0;
+	int32_t frame_overflows  = 0;
+	sk_frame_stats(nullptr, &frame_high_water, &frame_overflows);
+	log_diagf("Frame arena peaked at %.1fkb, with %d overflows", frame_high_water / 1024.0f, frame_overflows);
+	sk_frame_shutdown     ();
 	sk_mem_log_allocations();
+	log_shutdown          ();
 	log_clear_subscribers ();
 
 	// Persist the quit reason after everything has been shut down and cleared.
@@ -335,6 +383,8 @@ void sk_first_step() {
 void sk_step_begin() {
 	local.in_step = true;
 	sk_step_timer();
+	profiler_frame_mark();
+	log_step();
 	systems_step_partial(system_run_before, local.app_system_idx);
 	local.app_system->profile_frame_start = stm_now();
 }
@@ -342,11 +392,16 @@ void sk_step_begin() {
 ///////////////////////////////////////////
 
 bool32_t sk_step_end() {
-	local.app_system->profile_step_duration += stm_since(local.app_system->profile_frame_start);
-	local.app_system->profile_step_count += 1;
+	uint64_t app_duration = stm_since(local.app_system->profile_frame_start);
+	local.app_system->profile_step_duration += app_duration;
+	local.app_system->profile_step_count    += 1;
+	profiler_system_time(local.app_system_idx, local.app_system->name, local.app_system->profile_frame_start, app_duration);
 
 	systems_step_partial(system_run_from, local.app_system_idx+1);
 
+	// Everything allocated for this frame is done with now
+	sk_frame_reset();
+
 	if (device_display_get_type() == display_type_flatscreen && local.focus != app_focus_active && local.settings.standby_mode != standby_mode_none)
 		platform_sleep(100);
 	local.in_step = false;
@@ -795,6 +795,7 @@ SK_DeclarePrivateType(sound_t);
 SK_DeclarePrivateType(solid_t);
 SK_DeclarePrivateType(anchor_t);
 SK_DeclarePrivateType(render_list_t);
+SK_DeclarePrivateType(render_view_t);
 
 ///////////////////////////////////////////
 
@@ -872,6 +873,8 @@ SK_API void        mesh_release         (mesh_t mesh);
 SK_API void        mesh_draw            (mesh_t mesh, material_t material, matrix transform, color128 color_linear sk_default({1,1,1,1}), render_layer_ layer sk_default(render_layer_0));
 SK_API void        mesh_set_keep_data   (mesh_t mesh, bool32_t keep_data);
 SK_API bool32_t    mesh_get_keep_data   (mesh_t mesh);
+SK_API void        mesh_set_occluder    (mesh_t mesh, bool32_t occluder);
+SK_API bool32_t    mesh_get_occluder    (mesh_t mesh);
 SK_API void        mesh_set_data        (mesh_t mesh, const vert_t *in_arr_vertices, int32_t vertex_count, const vind_t *in_arr_indices, int32_t index_count, bool32_t calculate_bounds sk_default(true));
 SK_API void        mesh_set_verts       (mesh_t mesh, const vert_t *in_arr_vertices, int32_t vertex_count, bool32_t calculate_bounds sk_default(true));
 SK_API void        mesh_get_verts       (mesh_t mesh, sk_ref_arr(vert_t) out_arr_vertices, sk_ref(int32_t) out_vertex_count, memory_ reference_mode);
@@ -880,6 +883,10 @@ SK_API void        mesh_set_inds        (mesh_t mesh, const vind_t *in_arr_indic
 SK_API void        mesh_get_inds        (mesh_t mesh, sk_ref_arr(vind_t) out_arr_indices,  sk_ref(int32_t) out_index_count, memory_ reference_mode);
 SK_API int32_t     mesh_get_ind_count   (mesh_t mesh);
 SK_API void        mesh_set_draw_inds   (mesh_t mesh, int32_t index_count);
+SK_API void        mesh_generate_lods   (mesh_t mesh, int32_t level_count sk_default(3), float level_reduction sk_default(0.5f));
+SK_API int32_t     mesh_get_lod_count   (mesh_t mesh);
+SK_API void        mesh_build_clusters  (mesh_t mesh);
+SK_API int32_t     mesh_get_cluster_count(mesh_t mesh);
 SK_API void        mesh_set_bounds      (mesh_t mesh, const sk_ref(bounds_t) bounds);
 SK_API bounds_t    mesh_get_bounds      (mesh_t mesh);
 SK_API bool32_t    mesh_has_skin        (mesh_t mesh);
@@ -889,6 +896,8 @@ SK_API void        mesh_update_skin     (mesh_t mesh, const matrix *in_arr_bone_
 SK_API bool32_t    mesh_ray_intersect   (mesh_t mesh, ray_t model_space_ray, ray_t* out_pt, uint32_t* out_start_inds sk_default(nullptr), cull_ cull_mode sk_default(cull_back));
 SK_API bool32_t    mesh_ray_intersect_bvh(mesh_t mesh, ray_t model_space_ray, ray_t* out_pt, uint32_t* out_start_inds sk_default(nullptr), cull_ cull_mode sk_default(cull_back));
 SK_API bool32_t    mesh_get_triangle    (mesh_t mesh, uint32_t triangle_index, vert_t* out_a, vert_t* out_b, vert_t* out_c);
+SK_API void        mesh_set_collision_cache(const char *folder_utf8);
+SK_API const char* mesh_get_collision_cache(void);
 
 SK_API mesh_t      mesh_gen_plane       (vec2 dimensions, vec3 plane_normal, vec3 plane_top_direction, int32_t subdivisions sk_default(0), bool32_t double_sided sk_default(false));
 SK_API mesh_t      mesh_gen_circle      (float diameter,  vec3 plane_normal, vec3 plane_top_direction, int32_t spokes sk_default(16), bool32_t double_sided sk_default(false));
@@ -1306,6 +1315,19 @@ typedef enum material_param_ {
 	material_param_uint4 = 15,
 } material_param_;
 
+/*A material parameter name that's been resolved ahead of time, so setting
+  it skips the name lookup. Make one with material_param_handle, and then
+  always pass the same instance in. It remembers where the parameter lives
+  for the last shader it was used with, and resolves itself again if used
+  with a material that has a different shader. The fields are internal.*/
+typedef struct material_param_handle_t {
+	uint64_t name_hash;
+	uint32_t shader_generation;
+	int32_t  offset;
+	int32_t  size;
+	int32_t  texture_index;
+} material_param_handle_t;
+
 SK_API material_t        material_find            (const char *id);
 SK_API material_t        material_create          (shader_t shader);
 SK_API material_t        material_copy            (material_t material);
@@ -1363,6 +1385,13 @@ SK_API bool32_t          material_get_param       (material_t material, const ch
 SK_API bool32_t          material_get_param_id    (material_t material, uint64_t    id,   material_param_ type, void *out_value);
 SK_API void              material_get_param_info  (material_t material, int32_t index, char **out_name, material_param_ *out_type);
 SK_API int32_t           material_get_param_count (material_t material);
+SK_API material_param_handle_t material_param_handle(const char *name);
+SK_API bool32_t          material_set_param_handle  (material_t material, material_param_handle_t *handle, material_param_ type, const void *value);
+SK_API bool32_t          material_get_param_handle  (material_t material, material_param_handle_t *handle, material_param_ type, void *out_value);
+SK_API void              material_set_float_handle  (material_t material, material_param_handle_t *handle, float    value);
+SK_API void              material_set_vector4_handle(material_t material, material_param_handle_t *handle, vec4     value);
+SK_API void              material_set_color_handle  (material_t material, material_param_handle_t *handle, color128 color_gamma);
+SK_API void              material_set_matrix_handle (material_t material, material_param_handle_t *handle, matrix   value);
 SK_API void              material_set_shader      (material_t material, shader_t shader);
 SK_API shader_t          material_get_shader      (material_t material);
 
@@ -1502,6 +1531,46 @@ SK_API void          solid_set_velocity            (solid_t solid, const sk_ref(
 SK_API void          solid_set_velocity_ang        (solid_t solid, const sk_ref(vec3) radians_per_second);
 SK_API void          solid_get_pose                (const solid_t solid, sk_ref(pose_t) out_pose);
 
+/*The kinds of shapes that can be used for physics overlap and sweep
+  queries.*/
+typedef enum physics_shape_ {
+	/*A sphere, `dimensions.x` is its diameter.*/
+	physics_shape_sphere,
+	/*A box, `dimensions` is its full size on each axis.*/
+	physics_shape_box,
+	/*A capsule along the Y axis, `dimensions.x` is its diameter, and
+	  `dimensions.y` is the height of its cylinder section.*/
+	physics_shape_capsule,
+} physics_shape_;
+
+/*Describes a shape in world space for querying the physics world
+  with.*/
+typedef struct physics_shape_t {
+	physics_shape_ type;
+	pose_t         pose;
+	vec3           dimensions;
+} physics_shape_t;
+
+/*Where a physics query first touched a Solid.*/
+typedef struct physics_hit_t {
+	/*The Solid that was hit, or null if the query hit nothing.*/
+	solid_t solid;
+	/*The world space point of contact on the Solid's surface.*/
+	vec3    point;
+	/*The world space surface normal of the Solid at the point of
+	  contact.*/
+	vec3    normal;
+	/*How far along the ray or sweep the hit happened, in meters.*/
+	float   distance;
+} physics_hit_t;
+
+SK_API bool32_t      physics_raycast               (ray_t ray, float max_distance, physics_hit_t *out_hit);
+SK_API int32_t       physics_raycast_batch         (const ray_t *in_arr_rays, int32_t ray_count, float max_distance, physics_hit_t *out_arr_hits);
+SK_API int32_t       physics_overlap               (const sk_ref(physics_shape_t) shape, solid_t *out_arr_solids, int32_t solid_capacity);
+SK_API void          physics_overlap_batch         (const physics_shape_t *in_arr_shapes, int32_t shape_count, solid_t *out_arr_solids, int32_t solids_per_shape, int32_t *out_arr_solid_counts);
+SK_API bool32_t      physics_sweep                 (const sk_ref(physics_shape_t) shape, vec3 motion, physics_hit_t *out_hit);
+SK_API int32_t       physics_sweep_batch           (const physics_shape_t *in_arr_shapes, const vec3 *in_arr_motions, int32_t shape_count, physics_hit_t *out_arr_hits);
+
 ///////////////////////////////////////////
 
 typedef int32_t model_node_id;
@@ -1521,12 +1590,48 @@ typedef enum anim_mode_ {
 	anim_mode_manual,
 } anim_mode_;
 
+/*Describes how an animation layer combines with the layers beneath
+  it.*/
+typedef enum anim_blend_ {
+	/*The layer replaces the pose of the layers beneath it, by the
+	  layer's weight.*/
+	anim_blend_override,
+	/*The layer's difference from the Model's rest pose is added on top
+	  of the layers beneath it, scaled by the layer's weight.*/
+	anim_blend_additive,
+} anim_blend_;
+
+/*Extra processing that can be done on Mesh data while a Model is
+  being loaded from file. This work happens once at load time, and
+  can make the resulting Meshes cheaper to draw.*/
+typedef enum model_import_ {
+	/*Use the Mesh data exactly as the file provided it.*/
+	model_import_none     = 0,
+	/*Merge duplicate vertices, and reorder indices and vertices so the
+	  GPU's vertex cache is used well, overdraw is reduced, and vertex
+	  data is fetched in order. Skinned Meshes are left as they are.*/
+	model_import_optimize = 1 << 0,
+	/*Generate a level of detail chain for each Mesh, see
+	  mesh_generate_lods. Skinned Meshes are left as they are.*/
+	model_import_lods     = 1 << 1,
+	/*Split large Meshes into small clusters of triangles, so the parts
+	  facing away from or outside of the view can be skipped when
+	  drawing, see mesh_build_clusters. Small and skinned Meshes are
+	  left as they are.*/
+	model_import_clusters = 1 << 2,
+} model_import_;
+SK_MakeFlag(model_import_);
+
 SK_API model_t       model_find                    (const char *id);
 SK_API model_t       model_copy                    (model_t model);
 SK_API model_t       model_create                  (void);
 SK_API model_t       model_create_mesh             (mesh_t mesh, material_t material);
 SK_API model_t       model_create_mem              (const char *filename_utf8, const void *data, size_t data_size, shader_t shader sk_default(nullptr));
 SK_API model_t       model_create_file             (const char *filename_utf8, shader_t shader sk_default(nullptr));
+SK_API model_t       model_create_mem_flags        (const char *filename_utf8, const void *data, size_t data_size, model_import_ import_flags, shader_t shader sk_default(nullptr));
+SK_API model_t       model_create_file_flags       (const char *filename_utf8, model_import_ import_flags, shader_t shader sk_default(nullptr));
+SK_API void          model_set_import_flags        (model_import_ import_flags);
+SK_API model_import_ model_get_import_flags        (void);
 SK_API void          model_set_id                  (model_t model, const char *id);
 SK_API const char*   model_get_id                  (const model_t model);
 SK_API void          model_addref                  (model_t model);
@@ -1545,6 +1650,11 @@ SK_API bool32_t      model_ray_intersect_bvh_detailed(model_t model, ray_t model
 SK_API void          model_step_anim               (model_t model);
 SK_API bool32_t      model_play_anim               (model_t model, const char *animation_name, anim_mode_ mode);
 SK_API void          model_play_anim_idx           (model_t model, int32_t index,              anim_mode_ mode);
+SK_API void          model_play_anim_crossfade     (model_t model, int32_t index, anim_mode_ mode, float fade_seconds, int32_t layer sk_default(0));
+SK_API void          model_play_anim_blend         (model_t model, int32_t index, anim_mode_ mode, float weight, float fade_seconds, int32_t layer sk_default(0));
+SK_API void          model_stop_anim               (model_t model, float fade_seconds, int32_t layer sk_default(0));
+SK_API void          model_anim_layer_set          (model_t model, int32_t layer, anim_blend_ blend, float weight);
+SK_API void          model_anim_layer_set_mask     (model_t model, int32_t layer, model_node_id node, float weight, bool32_t include_children);
 SK_API void          model_set_anim_time           (model_t model, float time);
 SK_API void          model_set_anim_completion     (model_t model, float percent);
 SK_API int32_t       model_anim_find               (model_t model, const char *animation_name);
@@ -1703,6 +1813,10 @@ SK_API void                  render_set_skylight   (const sk_ref(spherical_harmo
 SK_API spherical_harmonics_t render_get_skylight   (void);
 SK_API void                  render_set_filter     (render_layer_ layer_filter);
 SK_API render_layer_         render_get_filter     (void);
+SK_API void                  render_set_occlusion  (bool32_t enabled);
+SK_API bool32_t              render_get_occlusion  (void);
+SK_API void                  render_set_view_budget(int32_t max_views_per_frame);
+SK_API int32_t               render_get_view_budget(void);
 SK_API void                  render_set_scaling    (float display_tex_scale);
 SK_API float                 render_get_scaling    (void);
 SK_API void                  render_set_viewport_scaling(float viewport_rect_scale);
@@ -1712,6 +1826,7 @@ SK_API int32_t               render_get_multisample(void);
 SK_API void                  render_override_capture_filter(bool32_t use_override_filter, render_layer_ layer_filter sk_default(render_layer_all));
 SK_API render_layer_         render_get_capture_filter     (void);
 SK_API bool32_t              render_has_capture_filter     (void);
+SK_API void                  render_set_lod        (float max_pixel_error sk_default(1.0f), float hysteresis sk_default(0.25f));
 SK_API void                  render_set_clear_color(color128 color_gamma);
 SK_API color128              render_get_clear_color(void);
 SK_API void                  render_enable_skytex  (bool32_t show_sky);
@@ -1754,6 +1869,39 @@ SK_API void                  render_list_pop          (void);
 
 ///////////////////////////////////////////
 
+/*A render view is a persistent secondary camera that draws the primary
+  render list into a rendertarget texture, like a mirror or security camera.
+  Views are only redrawn when their camera, target size, or the contents of
+  the layers they can see change, and no more often than their rate allows.
+  Content changes are detected from each visible item's transform, color,
+  mesh data, and material parameters, textures and render state. What a
+  texture itself holds isn't tracked, so views that can see render targets,
+  video, or edited textures need render_view_set_dirty.*/
+SK_API render_view_t         render_view_find         (const char* id);
+/*Creates a view that draws into to_rendertarget. It starts with an identity
+  camera and projection, so set those with render_view_set_camera.*/
+SK_API render_view_t         render_view_create       (tex_t to_rendertarget, render_layer_ layer_filter sk_default(render_layer_all), render_clear_ clear sk_default(render_clear_all), rect_t viewport sk_default({}));
+SK_API void                  render_view_set_id       (      render_view_t view, const char* id);
+SK_API const char*           render_view_get_id       (const render_view_t view);
+SK_API void                  render_view_addref       (      render_view_t view);
+SK_API void                  render_view_release      (      render_view_t view);
+/*Sets where the view looks from, and how it projects onto its texture. The
+  camera matrix is inverted internally, like render_to.*/
+SK_API void                  render_view_set_camera   (      render_view_t view, const sk_ref(matrix) camera, const sk_ref(matrix) projection);
+/*The most times per second the view will redraw, even when its contents
+  change every frame. 0 means no limit, which is the default.*/
+SK_API void                  render_view_set_rate     (      render_view_t view, float updates_per_second);
+SK_API float                 render_view_get_rate     (const render_view_t view);
+/*Disabled views are never drawn, and keep whatever their texture last held.
+  Views are enabled by default.*/
+SK_API void                  render_view_set_enabled  (      render_view_t view, bool32_t enabled);
+SK_API bool32_t              render_view_get_enabled  (const render_view_t view);
+/*Forces the view to redraw the next time its rate and the view budget allow
+  it, for changes StereoKit can't detect on its own.*/
+SK_API void                  render_view_set_dirty    (      render_view_t view);
+
+///////////////////////////////////////////
+
 /*When used with a hierarchy modifying function that will push/pop items onto a
   stack, this can be used to change the behavior of how parent hierarchy items
   will affect the item being added to the top of the stack.*/
@@ -2498,6 +2646,16 @@ SK_API void log_writef     (log_ level, const char *text, ...);
 SK_API void log_write      (log_ level, const char* text);
 SK_API void log_set_filter (log_ level);
 SK_API void log_set_colors (log_colors_ colors);
+SK_API void log_set_rate_limit(int32_t messages_per_second);
+/*When enabled, runs of the same message are collapsed into a single count,
+  which is reported once a different message is logged, or after about a
+  second. This applies to listeners too. Off by default.*/
+SK_API void log_set_dedup     (bool32_t collapse_repeats);
+/*While StereoKit is initialized, messages are written on a log thread, and
+  listeners receive them on the main thread at the start of each step. When
+  called from the main thread, this delivers everything logged so far to
+  listeners before returning.*/
+SK_API void log_flush         (void);
 // TODO: v0.4, replace these with the _data versions
 SK_API void log_subscribe       (void (*log_callback)(log_ level, const char *text));
 SK_API void log_unsubscribe     (void (*log_callback)(log_ level, const char *text));
@@ -2506,6 +2664,66 @@ SK_API void log_unsubscribe_data(void (*log_callback)(void* context, log_ level,
 
 ///////////////////////////////////////////
 
+/*Timing information about a single completed frame, as recorded by the
+  profiler.*/
+typedef struct profiler_frame_t {
+	/*A running count of the frames the profiler has recorded.*/
+	uint64_t frame;
+	/*How long the whole frame took, in milliseconds.*/
+	float    duration_ms;
+} profiler_frame_t;
+
+/*The profiler is disabled by default, and zones cost very little until
+  this is called with true.*/
+SK_API void     profiler_set_enabled  (bool32_t enabled);
+/*Is the profiler currently recording? Default is false.*/
+SK_API bool32_t profiler_get_enabled  (void);
+/*Starts a named timing zone on the current thread. The name is kept by
+  pointer, so it must stay valid for the life of the app. Zones can be
+  nested, and each must be paired with a profiler_zone_end on the same
+  thread.*/
+SK_API void     profiler_zone_begin   (const char *name_static);
+/*Ends the most recent zone started on this thread.*/
+SK_API void     profiler_zone_end     (void);
+/*How many completed frames of history are available to query? The frame
+  currently being recorded is not included.*/
+SK_API int32_t  profiler_frame_count  (void);
+/*Gets the timing of a completed frame, 0 frames_ago is the most recently
+  completed one. Returns false if the frame isn't in the history.*/
+SK_API bool32_t profiler_get_frame    (int32_t frames_ago, profiler_frame_t *out_frame);
+/*How long one of StereoKit's systems, like "Renderer", took during a
+  completed frame. Returns milliseconds, or 0 if it wasn't found.*/
+SK_API float    profiler_get_system_ms(const char *system_name, int32_t frames_ago);
+/*How long all zones with this name took in total during a completed
+  frame. Returns milliseconds, or 0 if it wasn't found.*/
+SK_API float    profiler_get_zone_ms  (const char *zone_name, int32_t frames_ago);
+/*Writes the recorded history to a Chrome trace event JSON file, which can
+  be opened in chrome://tracing or Perfetto. Returns true on success.*/
+SK_API bool32_t profiler_export_trace (const char *filename_utf8);
+
+///////////////////////////////////////////
+
+/*Categories that StereoKit's memory accounting sorts its CPU side
+  allocations into. GPU memory isn't counted here.*/
+typedef enum memory_tag_ {
+	memory_tag_mesh = 0,
+	memory_tag_texture,
+	memory_tag_audio,
+	memory_tag_animation,
+	memory_tag_font,
+	memory_tag_ui,
+	memory_tag_physics,
+	memory_tag_max,
+} memory_tag_;
+
+SK_API int64_t memory_get_current       (memory_tag_ tag);
+SK_API int64_t memory_get_peak          (memory_tag_ tag);
+SK_API void    memory_set_budget        (memory_tag_ tag, int64_t budget_bytes);
+SK_API int64_t memory_get_budget        (memory_tag_ tag);
+SK_API void    memory_on_budget_exceeded(void (*on_exceeded)(void *context, memory_tag_ tag, int64_t current_bytes, int64_t budget_bytes), void *context);
+
+///////////////////////////////////////////
+
 /*A flag for what 'type' an Asset may store.*/
 typedef enum asset_type_ {
 	/*No type, this may come from some kind of invalid Asset id.*/
@@ -2532,6 +2750,8 @@ typedef enum asset_type_ {
 	asset_type_anchor,
 	/*A RenderList*/
 	asset_type_render_list,
+	/*A RenderView*/
+	asset_type_render_view,
 } asset_type_;
 
 typedef void* asset_t;
@@ -455,6 +455,7 @@ mesh_bvh_create(const mesh_t mesh, int acc_leaf_size, bool show_stats)
 
     mesh_bvh_build_recursive(0, nodes, &next_node_index, sorted_triangles,
         acc_leaf_size, triangle_vertices, triangle_centroids, bvh->collision_data);
+    bvh->node_count = next_node_index;
 
 #if defined(VERBOSE_STATS)
     const double t1 = time_get_raw();
@@ -485,6 +486,133 @@ mesh_bvh_create(const mesh_t mesh, int acc_leaf_size, bool show_stats)
     return bvh;
 }
 
+// Header for a serialized BVH, followed by the nodes and then the sorted
+// triangle indices.
+struct bvh_file_header_t
+{
+    char        tag[4];
+    uint32_t    version;
+    uint64_t    key;
+    uint64_t    checksum;
+    uint32_t    triangle_count;
+    uint32_t    node_count;
+};
+// Bump this whenever bvh_node_t, the header, or the construction changes
+const uint32_t BVH_FILE_VERSION = 2;
+
+// Fletcher-64 over the raw position bits. The key is an FNV hash of the same
+// data, so this uses a different algorithm, and a file has to collide on
+// both before it gets used for the wrong mesh.
+static uint64_t
+bvh_points_checksum(const mesh_collision_t *collision_data, uint32_t triangle_count)
+{
+    const uint32_t *words = (const uint32_t *)collision_data->pts;
+    size_t          count = (size_t)triangle_count * 3 * (sizeof(vec3) / sizeof(uint32_t));
+    uint64_t        a     = 0;
+    uint64_t        b     = 0;
+    for (size_t i = 0; i < count; i++)
+    {
+        a = (a + words[i]) % 0xFFFFFFFF;
+        b = (b + a)        % 0xFFFFFFFF;
+    }
+    return (b << 32) | a;
+}
+
+void*
+mesh_bvh_serialize(const mesh_bvh_t *bvh, uint64_t key, const mesh_collision_t *collision_data, uint32_t triangle_count, size_t *out_size)
+{
+    bvh_file_header_t header = {};
+    memcpy(header.tag, "SKBV", sizeof(header.tag));
+    header.version        = BVH_FILE_VERSION;
+    header.key            = key;
+    header.checksum       = bvh_points_checksum(collision_data, triangle_count);
+    header.triangle_count = triangle_count;
+    header.node_count     = bvh->node_count;
+
+    size_t nodes_size = sizeof(bvh_node_t) * bvh->node_count;
+    size_t tris_size  = sizeof(uint32_t)   * triangle_count;
+    *out_size = sizeof(header) + nodes_size + tris_size;
+
+    uint8_t *data = sk_malloc_t(uint8_t, *out_size);
+    memcpy(data,                               &header,               sizeof(header));
+    memcpy(data + sizeof(header),              bvh->nodes,            nodes_size);
+    memcpy(data + sizeof(header) + nodes_size, bvh->sorted_triangles, tris_size);
+    return data;
+}
+
+mesh_bvh_t*
+mesh_bvh_deserialize(const void *data, size_t size, uint64_t key, const mesh_collision_t *collision_data, uint32_t triangle_count)
+{
+    bvh_file_header_t header;
+    if (size < sizeof(header))
+        return nullptr;
+    memcpy(&header, data, sizeof(header));
+
+    if (memcmp(header.tag, "SKBV", sizeof(header.tag)) != 0 ||
+        header.version        != BVH_FILE_VERSION ||
+        header.key            != key              ||
+        header.triangle_count != triangle_count   ||
+        header.node_count     == 0                ||
+        header.node_count     >  triangle_count*2)
+        return nullptr;
+
+    // Only worth the pass over the positions once everything cheap matches
+    if (header.checksum != bvh_points_checksum(collision_data, triangle_count))
+        return nullptr;
+
+    size_t nodes_size = sizeof(bvh_node_t) * header.node_count;
+    size_t tris_size  = sizeof(uint32_t)   * triangle_count;
+    if (size != sizeof(header) + nodes_size + tris_size)
+        return nullptr;
+
+    const uint8_t    *bytes = (const uint8_t *)data;
+    const bvh_node_t *nodes = (const bvh_node_t *)(bytes + sizeof(header));
+    const uint32_t   *tris  = (const uint32_t   *)(bytes + sizeof(header) + nodes_size);
+
+    // This came from disk, so make sure traversal can't wander outside of
+    // the arrays, even if the file is damaged. Children always come after
+    // their parent, which rules out loops, and the depth has to fit in the
+    // traversal stack.
+    uint32_t *depth = sk_malloc_zero_t(uint32_t, header.node_count);
+    bool      valid = true;
+    for (uint32_t n = 0; valid && n < header.node_count; n++)
+    {
+        const bvh_node_t &node = nodes[n];
+        if (node.is_leaf())
+        {
+            valid = (uint64_t)node.leaf_first + node.num_triangles <= triangle_count;
+        }
+        else
+        {
+            valid = node.leaf_first > n &&
+                    (uint64_t)node.leaf_first + 1 < header.node_count &&
+                    depth[n] + 1 < (uint32_t)TRAVERSAL_STACK_SIZE;
+            if (valid)
+            {
+                depth[node.leaf_first  ] = maxi(depth[node.leaf_first  ], depth[n] + 1);
+                depth[node.leaf_first+1] = maxi(depth[node.leaf_first+1], depth[n] + 1);
+            }
+        }
+    }
+    sk_free(depth);
+    if (!valid)
+        return nullptr;
+    for (uint32_t t = 0; t < triangle_count; t++)
+    {
+        if (tris[t] >= triangle_count)
+            return nullptr;
+    }
+
+    mesh_bvh_t *bvh = sk_malloc_zero_t(mesh_bvh_t, 1);
+    bvh->collision_data   = collision_data;
+    bvh->node_count       = header.node_count;
+    bvh->nodes            = sk_malloc_t(bvh_node_t, header.node_count);
+    bvh->sorted_triangles = sk_malloc_t(uint32_t,   triangle_count);
+    memcpy(bvh->nodes,            nodes, nodes_size);
+    memcpy(bvh->sorted_triangles, tris,  tris_size);
+    return bvh;
+}
+
 void
 mesh_bvh_destroy(mesh_bvh_t *bvh)
 {
@@ -21,6 +21,7 @@ struct mesh_bvh_t
     const mesh_collision_t *collision_data;
 
     bvh_node_t          *nodes;
+    uint32_t            node_count;
     uint32_t            *sorted_triangles;    
 };
 
@@ -29,4 +30,11 @@ void        mesh_bvh_destroy(mesh_bvh_t* bvh);
 bool        mesh_bvh_intersect(const mesh_bvh_t *bvh, ray_t model_space_ray, ray_t *out_pt, uint32_t* out_start_inds, cull_ cull_mode);
 void        mesh_bvh_statistics(const mesh_bvh_t *bvh, bvh_stats_t *stats, int acc_leaf_size=16);
 
+// Flattens a built BVH into a single block of memory, and back again, so it
+// can be cached on disk. The key is stored in the block along with a second,
+// independent checksum of the triangle positions, and loading fails if
+// either doesn't match, or if the block doesn't fit the given triangle count.
+void*       mesh_bvh_serialize  (const mesh_bvh_t *bvh, uint64_t key, const mesh_collision_t *collision_data, uint32_t triangle_count, size_t *out_size);
+mesh_bvh_t* mesh_bvh_deserialize(const void *data, size_t size, uint64_t key, const mesh_collision_t *collision_data, uint32_t triangle_count);
+
 } // namespace sk
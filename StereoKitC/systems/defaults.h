@@ -27,6 +27,7 @@ extern shader_t     sk_default_shader_font;
 extern shader_t     sk_default_shader_equirect;
 extern shader_t     sk_default_shader_ui;
 extern shader_t     sk_default_shader_ui_aura;
+extern shader_t     sk_default_shader_ui_quadrant;
 extern shader_t     sk_default_shader_sky;
 extern shader_t     sk_default_shader_lines;
 extern material_t   sk_default_material;
@@ -1,7 +1,9 @@
 #include "physics.h"
 #include "../stereokit.h"
 #include "../_stereokit.h"
+#include "../sk_memory.h"
 #include "../libraries/array.h"
+#include "profiler.h"
 
 #if !defined(SK_PHYSICS_PASSTHROUGH)
 #pragma warning(push)
@@ -28,9 +30,37 @@ double physics_sim_time  = 0;
 double physics_step_time = 1 / 90.0;
 
 #if !defined(SK_PHYSICS_PASSTHROUGH)
-PhysicsCommon physics_common;
+// Wraps ReactPhysics' own allocator so everything the physics engine holds
+// shows up under memory_tag_physics. ReactPhysics tells us the size on
+// release, so there's no need for a header on each allocation.
+class physics_allocator_t : public DefaultAllocator {
+public:
+	virtual void* allocate(size_t size) override {
+		sk_mem_tag_track(memory_tag_physics, (int64_t)size);
+		return DefaultAllocator::allocate(size);
+	}
+	virtual void release(void* pointer, size_t size) override {
+		sk_mem_tag_track(memory_tag_physics, -(int64_t)size);
+		DefaultAllocator::release(pointer, size);
+	}
+};
+
+physics_allocator_t physics_allocator;
+PhysicsCommon       physics_common(&physics_allocator);
 PhysicsWorld *physics_world;
 
+// Bodies used for overlap and sweep queries, one per shape type. They stay
+// inactive outside of a query, so the simulation never sees them.
+struct physics_query_t {
+	CollisionBody *body;
+	Collider      *collider;
+	CollisionShape*shape;
+};
+physics_query_t physics_queries[3] = {};
+// A box around the whole path of a sweep, used to find which colliders the
+// sweep could possibly touch before doing any narrow phase work.
+physics_query_t physics_sweep_bounds = {};
+
 inline vec3       vec3_rp_to_sk(Vector3    v) { return {v.x, v.y, v.z     }; }
 inline Vector3    vec3_sk_to_rp(vec3       v) { return {v.x, v.y, v.z     }; }
 inline quat       quat_rp_to_sk(Quaternion q) { return {q.x, q.y, q.z, q.w}; }
@@ -52,6 +82,21 @@ void physics_shutdown() {
 	solid_moves.free();
 
 #if !defined(SK_PHYSICS_PASSTHROUGH)
+	for (int32_t i = 0; i < (int32_t)(sizeof(physics_queries)/sizeof(physics_queries[0])); i++) {
+		if (physics_queries[i].body == nullptr) continue;
+		physics_world->destroyCollisionBody(physics_queries[i].body);
+		switch (i) {
+		case physics_shape_sphere:  physics_common.destroySphereShape ((SphereShape  *)physics_queries[i].shape); break;
+		case physics_shape_box:     physics_common.destroyBoxShape    ((BoxShape     *)physics_queries[i].shape); break;
+		case physics_shape_capsule: physics_common.destroyCapsuleShape((CapsuleShape *)physics_queries[i].shape); break;
+		}
+	}
+	memset(physics_queries, 0, sizeof(physics_queries));
+	if (physics_sweep_bounds.body != nullptr) {
+		physics_world->destroyCollisionBody(physics_sweep_bounds.body);
+		physics_common.destroyBoxShape((BoxShape *)physics_sweep_bounds.shape);
+	}
+	physics_sweep_bounds = {};
 	physics_common.destroyPhysicsWorld(physics_world);
 #endif
 }
@@ -92,10 +137,12 @@ void physics_step() {
 	}
 
 	// Sim physics!
+	profiler_zone_begin("Physics Simulate");
 	while (physics_sim_time < time_total()) {
 		physics_world->update((reactphysics3d::decimal)physics_step_time);
 		physics_sim_time += physics_step_time;
 	}
+	profiler_zone_end();
 
 	// Reset moved objects back to their original values, and clear out our list
 	for (int32_t i = 0; i < solid_moves.count; i++) {
@@ -117,7 +164,9 @@ void physics_step() {
 solid_t solid_create(const vec3 &position, const quat &rotation, solid_type_ type) {
 	solid_t result = (_solid_t*)assets_allocate(asset_type_solid);
 #if !defined(SK_PHYSICS_PASSTHROUGH)
-	result->data = physics_world->createRigidBody(Transform((Vector3 &)position, (Quaternion &)rotation));
+	RigidBody *body = physics_world->createRigidBody(Transform((Vector3 &)position, (Quaternion &)rotation));
+	body->setUserData(result);
+	result->data = body;
 #endif
 	solid_set_type(result, type);
 	return result;
@@ -270,4 +319,399 @@ void solid_get_pose(const solid_t solid, pose_t &out_pose) {
 #endif
 }
 
-} // namespace sk
\ No newline at end of file
+///////////////////////////////////////////
+// Scene queries                         //
+///////////////////////////////////////////
+
+#if !defined(SK_PHYSICS_PASSTHROUGH)
+struct physics_raycast_callback_t : public RaycastCallback {
+	physics_hit_t hit;
+	float         max_distance;
+
+	virtual decimal notifyRaycastHit(const RaycastInfo &info) override {
+		solid_t solid = (solid_t)info.body->getUserData();
+		if (solid == nullptr) return -1; // Not a Solid, skip it
+
+		hit.solid    = solid;
+		hit.point    = vec3_rp_to_sk(info.worldPoint);
+		hit.normal   = vec3_rp_to_sk(info.worldNormal);
+		hit.distance = info.hitFraction * max_distance;
+		// Clip the ray here, so we only hear about closer hits from now on
+		return info.hitFraction;
+	}
+};
+
+struct physics_overlap_callback_t : public OverlapCallback {
+	CollisionBody *query;
+	solid_t       *solids;
+	int32_t        capacity;
+	int32_t        count;
+
+	virtual void onOverlap(CallbackData &data) override {
+		for (uint32 i = 0; i < data.getNbOverlappingPairs(); i++) {
+			OverlapPair    pair  = data.getOverlappingPair(i);
+			CollisionBody *other = pair.getBody1() == query ? pair.getBody2() : pair.getBody1();
+			solid_t        solid = (solid_t)other->getUserData();
+			if (solid == nullptr) continue;
+
+			// Solids with multiple colliders can show up more than once
+			bool found = false;
+			for (int32_t s = 0; s < count && !found; s++) found = solids[s] == solid;
+			if (found) continue;
+
+			if (count < capacity) solids[count] = solid;
+			count += 1;
+		}
+	}
+};
+
+struct physics_any_overlap_callback_t : public OverlapCallback {
+	bool overlapped;
+
+	virtual void onOverlap(CallbackData &data) override {
+		for (uint32 i = 0; i < data.getNbOverlappingPairs() && !overlapped; i++) {
+			OverlapPair pair = data.getOverlappingPair(i);
+			overlapped = pair.getBody1()->getUserData() != nullptr || pair.getBody2()->getUserData() != nullptr;
+		}
+	}
+};
+
+struct physics_candidate_callback_t : public OverlapCallback {
+	CollisionBody      *query;
+	array_t<Collider *> colliders;
+
+	virtual void onOverlap(CallbackData &data) override {
+		for (uint32 i = 0; i < data.getNbOverlappingPairs(); i++) {
+			OverlapPair pair  = data.getOverlappingPair(i);
+			Collider   *other = pair.getBody1() == query ? pair.getCollider2() : pair.getCollider1();
+			if (other->getBody()->getUserData() != nullptr)
+				colliders.add(other);
+		}
+	}
+};
+
+struct physics_contact_callback_t : public CollisionCallback {
+	CollisionBody *query;
+	physics_hit_t  hit;
+	float          depth;
+
+	virtual void onContact(const CallbackData &data) override {
+		for (uint32 p = 0; p < data.getNbContactPairs(); p++) {
+			ContactPair pair       = data.getContactPair(p);
+			bool        query_is_1 = pair.getBody1() == query;
+			Collider   *other      = query_is_1 ? pair.getCollider2() : pair.getCollider1();
+			solid_t     solid      = (solid_t)other->getBody()->getUserData();
+			if (solid == nullptr) continue;
+
+			for (uint32 c = 0; c < pair.getNbContactPoints(); c++) {
+				ContactPoint pt = pair.getContactPoint(c);
+				if (hit.solid != nullptr && pt.getPenetrationDepth() >= depth) continue;
+
+				// Contact normals point from the first body to the second, we
+				// want the one facing out of the Solid's surface.
+				Vector3 local_pt = query_is_1 ? pt.getLocalPointOnCollider2() : pt.getLocalPointOnCollider1();
+				hit.solid  = solid;
+				hit.point  = vec3_rp_to_sk(other->getLocalToWorldTransform() * local_pt);
+				hit.normal = vec3_rp_to_sk(query_is_1 ? -pt.getWorldNormal() : pt.getWorldNormal());
+				depth      = pt.getPenetrationDepth();
+			}
+		}
+	}
+};
+
+///////////////////////////////////////////
+
+CollisionBody *physics_query_begin(const physics_shape_t &shape) {
+	if (shape.type < physics_shape_sphere || shape.type > physics_shape_capsule) {
+		log_err("Invalid physics query shape.");
+		return nullptr;
+	}
+
+	physics_query_t *query = &physics_queries[shape.type];
+	if (query->body == nullptr) {
+		switch (shape.type) {
+		case physics_shape_sphere:  query->shape = physics_common.createSphereShape (0.5f);                    break;
+		case physics_shape_box:     query->shape = physics_common.createBoxShape    (Vector3(0.5f,0.5f,0.5f)); break;
+		case physics_shape_capsule: query->shape = physics_common.createCapsuleShape(0.5f, 1);                 break;
+		}
+		query->body     = physics_world->createCollisionBody(Transform::identity());
+		query->collider = query->body->addCollider(query->shape, Transform::identity());
+		query->body->setIsActive(false);
+	}
+
+	switch (shape.type) {
+	case physics_shape_sphere:  ((SphereShape  *)query->shape)->setRadius     (fmaxf(shape.dimensions.x / 2, 0.0001f)); break;
+	case physics_shape_box:     ((BoxShape     *)query->shape)->setHalfExtents(Vector3(
+		fmaxf(shape.dimensions.x / 2, 0.0001f),
+		fmaxf(shape.dimensions.y / 2, 0.0001f),
+		fmaxf(shape.dimensions.z / 2, 0.0001f))); break;
+	case physics_shape_capsule: {
+		((CapsuleShape *)query->shape)->setRadius(fmaxf(shape.dimensions.x / 2, 0.0001f));
+		((CapsuleShape *)query->shape)->setHeight(fmaxf(shape.dimensions.y,     0.0001f));
+	} break;
+	}
+	query->body->setTransform(Transform(vec3_sk_to_rp(shape.pose.position), quat_sk_to_rp(shape.pose.orientation)));
+	query->body->setIsActive(true);
+	return query->body;
+}
+
+///////////////////////////////////////////
+
+void physics_query_end(CollisionBody *body) {
+	if (body != nullptr) body->setIsActive(false);
+}
+
+///////////////////////////////////////////
+
+float physics_shape_min_extent(const physics_shape_t &shape) {
+	switch (shape.type) {
+	case physics_shape_box: return fminf(shape.dimensions.x, fminf(shape.dimensions.y, shape.dimensions.z)) / 2;
+	default:                return shape.dimensions.x / 2;
+	}
+}
+
+///////////////////////////////////////////
+
+bool physics_query_overlaps(CollisionBody *body, vec3 position, const quat &orientation) {
+	body->setTransform(Transform(vec3_sk_to_rp(position), quat_sk_to_rp(orientation)));
+	physics_any_overlap_callback_t callback;
+	callback.overlapped = false;
+	physics_world->testOverlap(body, callback);
+	return callback.overlapped;
+}
+
+///////////////////////////////////////////
+
+// Finds the range of t where an AABB moving along motion overlaps another
+// AABB, returns false if it never does within 0-1.
+bool physics_aabb_sweep(const AABB &moving, vec3 motion, const AABB &other, float *out_t0, float *out_t1) {
+	float t0 = 0;
+	float t1 = 1;
+	const float mv_min[3] = { moving.getMin().x, moving.getMin().y, moving.getMin().z };
+	const float mv_max[3] = { moving.getMax().x, moving.getMax().y, moving.getMax().z };
+	const float ot_min[3] = { other .getMin().x, other .getMin().y, other .getMin().z };
+	const float ot_max[3] = { other .getMax().x, other .getMax().y, other .getMax().z };
+	const float m     [3] = { motion.x, motion.y, motion.z };
+	for (int32_t a = 0; a < 3; a++) {
+		if (fabsf(m[a]) < 0.000001f) {
+			if (mv_max[a] < ot_min[a] || mv_min[a] > ot_max[a]) return false;
+			continue;
+		}
+		float enter = (ot_min[a] - mv_max[a]) / m[a];
+		float exit  = (ot_max[a] - mv_min[a]) / m[a];
+		if (enter > exit) { float t = enter; enter = exit; exit = t; }
+		t0 = fmaxf(t0, enter);
+		t1 = fminf(t1, exit);
+		if (t0 > t1) return false;
+	}
+	*out_t0 = t0;
+	*out_t1 = t1;
+	return true;
+}
+
+///////////////////////////////////////////
+
+// ReactPhysics3D doesn't have shape casts, so this works in a few stages.
+// One overlap test with a box around the whole path finds every collider
+// the sweep could touch, and usually ends things right there. Their AABBs
+// then narrow the path down to the stretch where contact is possible, and
+// only that stretch is stepped through in increments no larger than the
+// shape's smallest extent. Finally, it bisects between the last free step
+// and the first touching one.
+bool physics_sweep_body(CollisionBody *body, const physics_shape_t &shape, vec3 motion, physics_hit_t *out_hit) {
+	const int32_t max_steps     = 64;
+	const int32_t refine_steps  = 10;
+	vec3          start         = shape.pose.position;
+	quat          orientation   = shape.pose.orientation;
+	float         length        = vec3_magnitude(motion);
+
+	body->setTransform(Transform(vec3_sk_to_rp(start), quat_sk_to_rp(orientation)));
+	AABB start_aabb = physics_queries[shape.type].collider->getWorldAABB();
+	vec3 path_min   = vec3_min(vec3_rp_to_sk(start_aabb.getMin()), vec3_rp_to_sk(start_aabb.getMin()) + motion);
+	vec3 end_max    = vec3_rp_to_sk(start_aabb.getMax()) + motion;
+	vec3 path_max   = vec3_rp_to_sk(start_aabb.getMax());
+	path_max = { fmaxf(path_max.x, end_max.x), fmaxf(path_max.y, end_max.y), fmaxf(path_max.z, end_max.z) };
+
+	if (physics_sweep_bounds.body == nullptr) {
+		physics_sweep_bounds.shape    = physics_common.createBoxShape(Vector3(0.5f, 0.5f, 0.5f));
+		physics_sweep_bounds.body     = physics_world->createCollisionBody(Transform::identity());
+		physics_sweep_bounds.collider = physics_sweep_bounds.body->addCollider(physics_sweep_bounds.shape, Transform::identity());
+	}
+	vec3 half = (path_max - path_min) * 0.5f;
+	((BoxShape *)physics_sweep_bounds.shape)->setHalfExtents(Vector3(fmaxf(half.x, 0.0001f), fmaxf(half.y, 0.0001f), fmaxf(half.z, 0.0001f)));
+	physics_sweep_bounds.body->setTransform(Transform(vec3_sk_to_rp((path_min + path_max) * 0.5f), quat_sk_to_rp(quat_identity)));
+	physics_sweep_bounds.body->setIsActive(true);
+	physics_candidate_callback_t candidates;
+	candidates.query = physics_sweep_bounds.body;
+	physics_world->testOverlap(physics_sweep_bounds.body, candidates);
+	physics_sweep_bounds.body->setIsActive(false);
+
+	// Contact is only possible where the shape's bounds overlap one of the
+	// candidates' bounds.
+	float t_first = 2;
+	float t_last  = -1;
+	for (int32_t i = 0; i < candidates.colliders.count; i++) {
+		float t0, t1;
+		if (!physics_aabb_sweep(start_aabb, motion, candidates.colliders[i]->getWorldAABB(), &t0, &t1)) continue;
+		t_first = fminf(t_first, t0);
+		t_last  = fmaxf(t_last,  t1);
+	}
+	candidates.colliders.free();
+	if (t_first > t_last) return false;
+
+	float   t_step     = length > 0 ? fmaxf(physics_shape_min_extent(shape), 0.001f) / length : 1;
+	int32_t step_count = (int32_t)ceilf((t_last - t_first) / t_step);
+	if (step_count < 1        ) step_count = 1;
+	if (step_count > max_steps) step_count = max_steps;
+
+	float t_free = t_first;
+	float t_hit  = -1;
+	if (physics_query_overlaps(body, start + motion * t_first, orientation)) {
+		t_hit  = t_first;
+		t_free = 0;
+	} else {
+		for (int32_t i = 1; i <= step_count; i++) {
+			float t = t_first + (t_last - t_first) * ((float)i / step_count);
+			if (physics_query_overlaps(body, start + motion * t, orientation)) { t_hit = t; break; }
+			t_free = t;
+		}
+	}
+	if (t_hit < 0) return false;
+
+	// t_first came from bounds, so overlapping there doesn't mean the shape
+	// was touching any earlier. Only a hit right at the start skips this.
+	for (int32_t i = 0; t_hit > 0 && i < refine_steps; i++) {
+		float t = (t_free + t_hit) / 2;
+		if (physics_query_overlaps(body, start + motion * t, orientation)) t_hit  = t;
+		else                                                                   t_free = t;
+	}
+
+	// Get surface details from the contacts at the touching position
+	vec3 hit_pos = start + motion * t_hit;
+	body->setTransform(Transform(vec3_sk_to_rp(hit_pos), quat_sk_to_rp(orientation)));
+	physics_contact_callback_t callback;
+	callback.query = body;
+	callback.hit   = {};
+	callback.depth = 0;
+	physics_world->testCollision(body, callback);
+
+	*out_hit = callback.hit;
+	if (out_hit->solid == nullptr) {
+		// Grazing contacts can overlap without producing contact points, the
+		// shapes are still touching though, so find what we touched and
+		// face back along the motion.
+		solid_t                    solid = nullptr;
+		physics_overlap_callback_t touching;
+		touching.query    = body;
+		touching.solids   = &solid;
+		touching.capacity = 1;
+		touching.count    = 0;
+		physics_world->testOverlap(body, touching);
+		if (solid == nullptr) return false;
+
+		out_hit->solid  = solid;
+		out_hit->point  = hit_pos;
+		out_hit->normal = length > 0 ? -(motion / length) : vec3_up;
+	}
+	out_hit->distance = t_hit * length;
+	return true;
+}
+#endif
+
+///////////////////////////////////////////
+
+bool32_t physics_raycast(ray_t ray, float max_distance, physics_hit_t *out_hit) {
+	return physics_raycast_batch(&ray, 1, max_distance, out_hit) > 0;
+}
+
+///////////////////////////////////////////
+
+int32_t physics_raycast_batch(const ray_t *rays, int32_t ray_count, float max_distance, physics_hit_t *out_hits) {
+	int32_t result = 0;
+#if !defined(SK_PHYSICS_PASSTHROUGH)
+	physics_raycast_callback_t callback;
+	for (int32_t i = 0; i < ray_count; i++) {
+		vec3 dir = vec3_normalize(rays[i].dir);
+		callback.hit          = {};
+		callback.max_distance = max_distance;
+		physics_world->raycast(Ray(vec3_sk_to_rp(rays[i].pos), vec3_sk_to_rp(rays[i].pos + dir * max_distance)), &callback);
+
+		out_hits[i] = callback.hit;
+		if (callback.hit.solid != nullptr) result += 1;
+	}
+#else
+	memset(out_hits, 0, sizeof(physics_hit_t) * ray_count);
+#endif
+	return result;
+}
+
+///////////////////////////////////////////
+
+int32_t physics_overlap(const physics_shape_t &shape, solid_t *out_solids, int32_t solid_capacity) {
+	int32_t count = 0;
+	physics_overlap_batch(&shape, 1, out_solids, solid_capacity, &count);
+	return count;
+}
+
+///////////////////////////////////////////
+
+void physics_overlap_batch(const physics_shape_t *shapes, int32_t shape_count, solid_t *out_solids, int32_t solids_per_shape, int32_t *out_solid_counts) {
+#if !defined(SK_PHYSICS_PASSTHROUGH)
+	// Consecutive queries of the same shape type share a query body, so it
+	// only goes in and out of the broadphase once per run.
+	CollisionBody *body = nullptr;
+	for (int32_t i = 0; i < shape_count; i++) {
+		if (i == 0 || shapes[i].type != shapes[i-1].type) {
+			physics_query_end(body);
+			body = physics_query_begin(shapes[i]);
+		} else if (body != nullptr) {
+			physics_query_begin(shapes[i]);
+		}
+		if (body == nullptr) { out_solid_counts[i] = 0; continue; }
+
+		physics_overlap_callback_t callback;
+		callback.query    = body;
+		callback.solids   = &out_solids[i * solids_per_shape];
+		callback.capacity = solids_per_shape;
+		callback.count    = 0;
+		physics_world->testOverlap(body, callback);
+		out_solid_counts[i] = callback.count;
+	}
+	physics_query_end(body);
+#else
+	memset(out_solid_counts, 0, sizeof(int32_t) * shape_count);
+#endif
+}
+
+///////////////////////////////////////////
+
+bool32_t physics_sweep(const physics_shape_t &shape, vec3 motion, physics_hit_t *out_hit) {
+	return physics_sweep_batch(&shape, &motion, 1, out_hit) > 0;
+}
+
+///////////////////////////////////////////
+
+int32_t physics_sweep_batch(const physics_shape_t *shapes, const vec3 *motions, int32_t shape_count, physics_hit_t *out_hits) {
+	int32_t result = 0;
+#if !defined(SK_PHYSICS_PASSTHROUGH)
+	CollisionBody *body = nullptr;
+	for (int32_t i = 0; i < shape_count; i++) {
+		if (i == 0 || shapes[i].type != shapes[i-1].type) {
+			physics_query_end(body);
+			body = physics_query_begin(shapes[i]);
+		} else if (body != nullptr) {
+			physics_query_begin(shapes[i]);
+		}
+
+		out_hits[i] = {};
+		if (body != nullptr && physics_sweep_body(body, shapes[i], motions[i], &out_hits[i]))
+			result += 1;
+	}
+	physics_query_end(body);
+#else
+	memset(out_hits, 0, sizeof(physics_hit_t) * shape_count);
+#endif
+	return result;
+}
+
+} // namespace sk
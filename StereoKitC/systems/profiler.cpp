@@ -0,0 +1,393 @@
+#include "profiler.h"
+#include "system.h"
+#include "../_stereokit.h"
+#include "../sk_memory.h"
+#include "../libraries/array.h"
+#include "../libraries/stref.h"
+#include "../libraries/atomic_util.h"
+#include "../libraries/ferr_thread.h"
+#include "../libraries/sokol_time.h"
+
+#include <stdio.h>
+#include <stdarg.h>
+#include <string.h>
+
+namespace sk {
+
+///////////////////////////////////////////
+
+#define PROFILER_HISTORY       120
+#define PROFILER_MAX_SYSTEMS   48
+#define PROFILER_MAX_DEPTH     32
+// Must be a power of two, since the event ring wraps with a mask
+#define PROFILER_THREAD_EVENTS 4096
+
+// sequence is 0 while the slot is being written, and otherwise holds the
+// event's position in the ring plus one. Readers check it before and after
+// copying the event out, so they never use a slot that was overwritten
+// partway through.
+struct profiler_event_t {
+	volatile uint32_t sequence;
+	const char       *name;
+	uint64_t          start;
+	uint64_t          end;
+	int32_t           depth;
+};
+
+struct profiler_open_t {
+	const char *name;
+	uint64_t    start;
+};
+
+// Each thread records into its own ring, so zones never contend with each
+// other. Only registering a new thread takes a lock.
+struct profiler_thread_t {
+	const char        *name;
+	int32_t            id;
+	volatile uint32_t  event_count;
+	profiler_event_t   events[PROFILER_THREAD_EVENTS];
+	profiler_open_t    stack [PROFILER_MAX_DEPTH];
+	int32_t            depth;
+};
+
+struct profiler_frame_rec_t {
+	uint64_t frame;
+	uint64_t start;
+	uint64_t end;
+	uint64_t system_ticks[PROFILER_MAX_SYSTEMS];
+};
+
+struct profiler_state_t {
+	bool32_t                     initialized;
+	bool32_t                     enabled;
+	uint32_t                     generation;
+	ft_mutex_t                   thread_mtx;
+	array_t<profiler_thread_t *> threads;
+	profiler_frame_rec_t         frames[PROFILER_HISTORY];
+	int32_t                      frame_curr;
+	uint64_t                     frame_count;
+};
+static profiler_state_t local = {};
+static uint32_t         profiler_generation = 0;
+
+// The generation lets threads notice that the profiler was shut down and
+// started again, and that their old buffer is gone.
+static thread_local profiler_thread_t *profiler_tls     = nullptr;
+static thread_local uint32_t           profiler_tls_gen = 0;
+
+///////////////////////////////////////////
+
+bool profiler_init() {
+	// The profiler is off until asked for, and may be asked for before
+	// StereoKit initializes.
+	bool32_t enabled = local.enabled;
+	local = {};
+	local.thread_mtx  = ft_mutex_create();
+	local.enabled     = enabled;
+	local.generation  = ++profiler_generation;
+	local.initialized = true;
+	return true;
+}
+
+///////////////////////////////////////////
+
+void profiler_shutdown() {
+	ft_mutex_lock(local.thread_mtx);
+	local.initialized = false;
+	for (int32_t i = 0; i < local.threads.count; i++)
+		sk_free(local.threads[i]);
+	local.threads.free();
+	ft_mutex_unlock(local.thread_mtx);
+
+	ft_mutex_destroy(&local.thread_mtx);
+	local = {};
+}
+
+///////////////////////////////////////////
+
+static profiler_thread_t *profiler_thread_get() {
+	if (profiler_tls_gen == local.generation && profiler_tls != nullptr)
+		return profiler_tls;
+	if (local.initialized == false)
+		return nullptr;
+
+	profiler_thread_t *thread = sk_malloc_zero_t(profiler_thread_t, 1);
+	ft_mutex_lock(local.thread_mtx);
+	thread->id   = local.threads.count + 1;
+	thread->name = ft_id_matches(sk_main_thread()) ? "Main" : "Thread";
+	local.threads.add(thread);
+	ft_mutex_unlock(local.thread_mtx);
+
+	profiler_tls     = thread;
+	profiler_tls_gen = local.generation;
+	return thread;
+}
+
+///////////////////////////////////////////
+
+static void profiler_record(profiler_thread_t *thread, const char *name, uint64_t start, uint64_t end, int32_t depth) {
+	uint32_t          index = thread->event_count;
+	profiler_event_t *ev    = &thread->events[index & (PROFILER_THREAD_EVENTS - 1)];
+	ev->sequence = 0;
+	atomic_fence();
+	ev->name  = name;
+	ev->start = start;
+	ev->end   = end;
+	ev->depth = depth;
+	atomic_fence();
+	ev->sequence       = index + 1;
+	thread->event_count = index + 1;
+}
+
+///////////////////////////////////////////
+
+void profiler_thread_name(const char *name_static) {
+	profiler_thread_t *thread = profiler_thread_get();
+	if (thread) thread->name = name_static;
+}
+
+///////////////////////////////////////////
+
+void profiler_zone_begin(const char *name_static) {
+	profiler_thread_t *thread = profiler_thread_get();
+	if (thread == nullptr) return;
+
+	// Zones opened while disabled still take a stack slot, so begin/end
+	// pairs stay balanced if the profiler is toggled mid-zone.
+	if (thread->depth < PROFILER_MAX_DEPTH) {
+		thread->stack[thread->depth].name  = name_static;
+		thread->stack[thread->depth].start = local.enabled ? stm_now() : 0;
+	}
+	thread->depth += 1;
+}
+
+///////////////////////////////////////////
+
+void profiler_zone_end() {
+	profiler_thread_t *thread = profiler_thread_get();
+	if (thread == nullptr || thread->depth <= 0) return;
+
+	thread->depth -= 1;
+	if (thread->depth >= PROFILER_MAX_DEPTH) return;
+
+	const profiler_open_t *open = &thread->stack[thread->depth];
+	if (open->start == 0 || local.enabled == false) return;
+	profiler_record(thread, open->name, open->start, stm_now(), thread->depth);
+}
+
+///////////////////////////////////////////
+
+void profiler_system_time(int32_t system_idx, const char *name, uint64_t start, uint64_t duration) {
+	if (local.enabled == false) return;
+	profiler_thread_t *thread = profiler_thread_get();
+	if (thread == nullptr) return;
+
+	profiler_record(thread, name, start, start + duration, thread->depth);
+	if (system_idx >= 0 && system_idx < PROFILER_MAX_SYSTEMS && local.frame_count > 0)
+		local.frames[local.frame_curr].system_ticks[system_idx] += duration;
+}
+
+///////////////////////////////////////////
+
+void profiler_frame_mark() {
+	uint64_t now = stm_now();
+	if (local.frame_count > 0) {
+		local.frames[local.frame_curr].end = now;
+		local.frame_curr = (local.frame_curr + 1) % PROFILER_HISTORY;
+	}
+
+	profiler_frame_rec_t *rec = &local.frames[local.frame_curr];
+	memset(rec, 0, sizeof(*rec));
+	rec->frame  = local.frame_count;
+	rec->start  = now;
+	local.frame_count += 1;
+}
+
+///////////////////////////////////////////
+
+// The frame currently being recorded isn't complete, so it's never
+// returned here, frames_ago 0 is the most recently finished frame.
+static const profiler_frame_rec_t *profiler_frame_at(int32_t frames_ago) {
+	int64_t completed = (int64_t)local.frame_count - 1;
+	if (completed > PROFILER_HISTORY - 1) completed = PROFILER_HISTORY - 1;
+	if (frames_ago < 0 || frames_ago >= completed) return nullptr;
+
+	int32_t slot = (local.frame_curr - 1 - frames_ago + PROFILER_HISTORY * 2) % PROFILER_HISTORY;
+	return &local.frames[slot];
+}
+
+///////////////////////////////////////////
+
+// Visits recorded events that are still in each thread's ring. Threads can
+// keep writing while we read, so each event is copied out, and only used if
+// its slot's sequence says it's the event we expected both before and after
+// the copy.
+static void profiler_each_event(void *context, void (*on_event)(void *context, const profiler_thread_t *thread, const profiler_event_t *ev)) {
+	ft_mutex_lock(local.thread_mtx);
+	for (int32_t t = 0; t < local.threads.count; t++) {
+		const profiler_thread_t *thread = local.threads[t];
+		uint32_t end   = thread->event_count;
+		uint32_t count = end < PROFILER_THREAD_EVENTS ? end : PROFILER_THREAD_EVENTS;
+		for (uint32_t i = end - count; i != end; i++) {
+			const profiler_event_t *slot = &thread->events[i & (PROFILER_THREAD_EVENTS - 1)];
+			if (slot->sequence != i + 1) continue;
+			atomic_fence();
+			profiler_event_t ev = {};
+			ev.name  = slot->name;
+			ev.start = slot->start;
+			ev.end   = slot->end;
+			ev.depth = slot->depth;
+			atomic_fence();
+			if (slot->sequence != i + 1) continue;
+
+			on_event(context, thread, &ev);
+		}
+	}
+	ft_mutex_unlock(local.thread_mtx);
+}
+
+///////////////////////////////////////////
+
+void profiler_set_enabled(bool32_t enabled) {
+	local.enabled = enabled;
+}
+
+///////////////////////////////////////////
+
+bool32_t profiler_get_enabled() {
+	return local.enabled;
+}
+
+///////////////////////////////////////////
+
+int32_t profiler_frame_count() {
+	int64_t completed = (int64_t)local.frame_count - 1;
+	if (completed < 0) return 0;
+	return completed > PROFILER_HISTORY - 1 ? PROFILER_HISTORY - 1 : (int32_t)completed;
+}
+
+///////////////////////////////////////////
+
+bool32_t profiler_get_frame(int32_t frames_ago, profiler_frame_t *out_frame) {
+	const profiler_frame_rec_t *rec = profiler_frame_at(frames_ago);
+	if (rec == nullptr) return false;
+
+	out_frame->frame       = rec->frame;
+	out_frame->duration_ms = (float)stm_ms(rec->end - rec->start);
+	return true;
+}
+
+///////////////////////////////////////////
+
+float profiler_get_system_ms(const char *system_name, int32_t frames_ago) {
+	const profiler_frame_rec_t *rec = profiler_frame_at(frames_ago);
+	int32_t                     idx = systems_find_idx(system_name);
+	if (rec == nullptr || idx < 0 || idx >= PROFILER_MAX_SYSTEMS) return 0;
+
+	return (float)stm_ms(rec->system_ticks[idx]);
+}
+
+///////////////////////////////////////////
+
+float profiler_get_zone_ms(const char *zone_name, int32_t frames_ago) {
+	const profiler_frame_rec_t *rec = profiler_frame_at(frames_ago);
+	if (rec == nullptr) return 0;
+
+	struct zone_sum_t {
+		const char                 *name;
+		const profiler_frame_rec_t *frame;
+		uint64_t                    ticks;
+	} sum = { zone_name, rec, 0 };
+
+	profiler_each_event(&sum, [](void *context, const profiler_thread_t *, const profiler_event_t *ev) {
+		zone_sum_t *sum = (zone_sum_t *)context;
+		if (ev->start >= sum->frame->start && ev->start < sum->frame->end && string_eq(ev->name, sum->name))
+			sum->ticks += ev->end - ev->start;
+	});
+	return (float)stm_ms(sum.ticks);
+}
+
+///////////////////////////////////////////
+
+static void profiler_json_append(array_t<char> *json, const char *format, ...) {
+	va_list args, args_copy;
+	va_start(args, format);
+	va_copy (args_copy, args);
+	int32_t length = vsnprintf(nullptr, 0, format, args);
+	va_end  (args);
+	if (length <= 0) { va_end(args_copy); return; }
+
+	if (json->count + length + 1 > json->capacity)
+		json->resize(json->capacity * 2 > json->count + length + 1 ? json->capacity * 2 : json->count + length + 1);
+	vsnprintf(&json->data[json->count], length + 1, format, args_copy);
+	va_end(args_copy);
+	json->count += length;
+}
+
+///////////////////////////////////////////
+
+static void profiler_json_name(array_t<char> *json, const char *name) {
+	profiler_json_append(json, "\"");
+	for (const char *c = name ? name : "(null)"; *c; c++) {
+		if      (*c == '"' || *c == '\\') profiler_json_append(json, "\\%c", *c);
+		else if ((unsigned char)*c < 0x20) profiler_json_append(json, "\\u%04x", (unsigned char)*c);
+		else                              profiler_json_append(json, "%c", *c);
+	}
+	profiler_json_append(json, "\"");
+}
+
+///////////////////////////////////////////
+
+bool32_t profiler_export_trace(const char *filename_utf8) {
+	int32_t count = profiler_frame_count();
+	if (count == 0) {
+		log_warn("profiler_export_trace: no completed frames to export yet.");
+		return false;
+	}
+
+	struct trace_ctx_t {
+		array_t<char> json;
+		uint64_t      origin;
+		uint64_t      end;
+		bool          first;
+	} ctx = {};
+	ctx.origin = profiler_frame_at(count - 1)->start;
+	ctx.end    = profiler_frame_at(0)->end;
+	ctx.first  = true;
+	ctx.json.resize(64 * 1024);
+
+	// Chrome's trace event format, loadable in chrome://tracing or Perfetto
+	profiler_json_append(&ctx.json, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+	profiler_json_append(&ctx.json, "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":0,\"args\":{\"name\":\"Frames\"}}");
+	for (int32_t i = count - 1; i >= 0; i--) {
+		const profiler_frame_rec_t *rec = profiler_frame_at(i);
+		profiler_json_append(&ctx.json, ",\n{\"name\":\"Frame %llu\",\"ph\":\"X\",\"pid\":0,\"tid\":0,\"ts\":%.3f,\"dur\":%.3f}",
+			(unsigned long long)rec->frame, stm_us(rec->start - ctx.origin), stm_us(rec->end - rec->start));
+	}
+
+	ft_mutex_lock(local.thread_mtx);
+	for (int32_t t = 0; t < local.threads.count; t++) {
+		profiler_json_append(&ctx.json, ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":%d,\"args\":{\"name\":", local.threads[t]->id);
+		profiler_json_name  (&ctx.json, local.threads[t]->name);
+		profiler_json_append(&ctx.json, "}}");
+	}
+	ft_mutex_unlock(local.thread_mtx);
+
+	profiler_each_event(&ctx, [](void *context, const profiler_thread_t *thread, const profiler_event_t *ev) {
+		trace_ctx_t *ctx = (trace_ctx_t *)context;
+		if (ev->start < ctx->origin || ev->start >= ctx->end) return;
+
+		profiler_json_append(&ctx->json, ",\n{\"name\":");
+		profiler_json_name  (&ctx->json, ev->name);
+		profiler_json_append(&ctx->json, ",\"ph\":\"X\",\"pid\":0,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f}",
+			thread->id, stm_us(ev->start - ctx->origin), stm_us(ev->end - ev->start));
+	});
+	profiler_json_append(&ctx.json, "\n]}\n");
+
+	bool32_t result = platform_write_file_text(filename_utf8, ctx.json.data);
+	if (!result) log_warnf("profiler_export_trace: couldn't write to %s", filename_utf8);
+	ctx.json.free();
+	return result;
+}
+
+} // namespace sk
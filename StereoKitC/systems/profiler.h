@@ -0,0 +1,22 @@
+#pragma once
+
+#include "../stereokit.h"
+
+namespace sk {
+
+bool profiler_init       ();
+void profiler_shutdown   ();
+void profiler_frame_mark ();
+void profiler_thread_name(const char *name_static);
+void profiler_system_time(int32_t system_idx, const char *name, uint64_t start, uint64_t duration);
+
+// Opens a zone for the rest of the enclosing scope. Zone names are stored
+// by pointer, so they need to outlive the profiler, string literals are
+// ideal.
+struct profiler_scope_t {
+	profiler_scope_t(const char *name_static) { profiler_zone_begin(name_static); }
+	~profiler_scope_t()                       { profiler_zone_end(); }
+};
+#define profiler_scope(name_static) sk::profiler_scope_t _profiler_scope(name_static)
+
+} // namespace sk
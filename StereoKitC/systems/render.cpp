@@ -6,11 +6,13 @@
 
 #include "render.h"
 #include "render_.h"
+#include "render_occlusion.h"
 #include "world.h"
 #include "defaults.h"
 #include "../_stereokit.h"
 #include "../device.h"
 #include "../libraries/stref.h"
+#include "../libraries/ferr_hash.h"
 #include "../sk_math_dx.h"
 #include "../sk_memory.h"
 #include "../spherical_harmonics.h"
@@ -23,6 +25,7 @@
 #include "../asset_types/model.h"
 #include "../asset_types/animation.h"
 #include "../systems/input.h"
+#include "../systems/profiler.h"
 #include "../platforms/platform.h"
 
 #include <sk_gpu.h>
@@ -79,6 +82,21 @@ struct render_screenshot_t {
 	render_clear_ clear;
 	tex_format_   tex_format;
 };
+struct render_capture_target_t {
+	tex_t         surface;
+	tex_t         resolve;
+	color32      *buffer;
+	int32_t       width;
+	int32_t       height;
+	tex_format_   format;
+	bool32_t      in_use;
+	uint64_t      last_frame;
+};
+struct render_capture_pending_t {
+	render_screenshot_t request;
+	int32_t             target;
+	uint64_t            read_frame;
+};
 struct render_viewpoint_t {
 	tex_t         rendertarget;
 	matrix        camera;
@@ -137,10 +155,26 @@ struct render_state_t {
 	render_layer_           primary_filter;
 	render_layer_           capture_filter;
 	bool                    use_capture_filter;
+	float                   lod_pixel_error;
+	float                   lod_hysteresis;
+	vec3                    lod_view_pos;
+	float                   lod_pixel_scale;
+	bool                    lod_perspective;
+	XMMATRIX                cull_viewproj[2];
+	XMVECTOR                cull_cam_pos [2];
+	int32_t                 cull_view_count;
+	bool32_t                occlusion_enabled;
+	bool32_t                occlusion_active;
 	tex_t                   global_textures[16];
 
-	array_t<render_screenshot_t> screenshot_list;
-	array_t<render_viewpoint_t>  viewpoint_list;
+	array_t<render_screenshot_t>      screenshot_list;
+	array_t<render_viewpoint_t>       viewpoint_list;
+	array_t<render_view_t>            view_list;
+	int32_t                           view_next;
+	int32_t                           view_budget;
+	array_t<render_capture_target_t>  capture_targets;
+	array_t<render_capture_pending_t> capture_pending;
+	array_t<uint8_t>                  capture_scratch;
 
 	mesh_t                  sky_mesh;
 	material_t              sky_mat;
@@ -149,6 +183,7 @@ struct render_state_t {
 	tex_t                   sky_pending_tex;
 
 	material_t              last_material;
+	material_pipeline_t    *last_pipeline;
 	shader_t                last_shader;
 	mesh_t                  last_mesh;
 
@@ -163,20 +198,25 @@ const skg_bind_t render_list_global_bind = { 1,  skg_stage_vertex | skg_stage_pi
 const skg_bind_t render_list_inst_bind   = { 2,  skg_stage_vertex | skg_stage_pixel, skg_register_constant };
 const skg_bind_t render_list_blit_bind   = { 3,  skg_stage_vertex | skg_stage_pixel, skg_register_constant };
 
+// How many frames a capture waits before it's read back, and how long an
+// idle capture target sticks around for re-use.
+const uint64_t   render_capture_delay       = 2;
+const uint64_t   render_capture_keep_frames = 60;
+
 ///////////////////////////////////////////
 
 void          render_set_material     (material_t material);
 skg_buffer_t *render_fill_inst_buffer (const array_t<render_transform_buffer_t>* list, int32_t* ref_offset, int32_t* out_count);
 void          render_reset_buffer_pool();
 void          render_save_to_file     (color32* color_buffer, int width, int height, void* context);
+void          render_capture_flush    ();
+void          render_capture_target_release(int32_t index);
 
 void          render_list_prep        (render_list_t list);
 void          render_list_add         (const render_item_t *item);
 void          render_list_add_to      (render_list_t list, const render_item_t *item);
 
 void          radix_sort7             (render_item_t *a, size_t count);
-void          radix_sort_clean        ();
-void          radix_sort_init         ();
 
 ///////////////////////////////////////////
 
@@ -201,6 +241,8 @@ bool render_init() {
 	local.primary_filter        = render_layer_all_first_person;
 	local.capture_filter        = render_layer_all_first_person;
 	local.list_active           = nullptr;
+	local.lod_pixel_error       = 1.0f;
+	local.lod_hysteresis        = 0.25f;
 
 	local.shader_globals  = material_buffer_create(1, sizeof(local.global_buffer));
 	local.shader_blit     = skg_buffer_create(nullptr, 1, sizeof(render_blit_data_t), skg_buffer_type_constant, skg_use_dynamic);
@@ -248,7 +290,6 @@ bool render_init() {
 	render_list_set_id(local.list_primary, "sk/render/primary_renderlist");
 	render_list_push  (local.list_primary);
 
-	radix_sort_init();
 	hierarchy_init();
 
 	render_update_projection();
@@ -259,12 +300,22 @@ bool render_init() {
 ///////////////////////////////////////////
 
 void render_shutdown() {
+	// Anything still waiting on a readback gets delivered now
+	render_capture_flush();
+	for (int32_t i = local.capture_targets.count - 1; i >= 0; i--)
+		render_capture_target_release(i);
+	local.capture_targets.free();
+	local.capture_pending.free();
+	local.capture_scratch.free();
+	render_occlusion_shutdown();
+
 	render_list_pop();
 	render_list_release(local.list_active);
 	render_list_release(local.list_primary);
 	local.list_stack     .free();
 	local.screenshot_list.free();
 	local.viewpoint_list .free();
+	local.view_list      .free();
 	local.instance_list  .free();
 
 	for (int32_t i = 0; i < _countof(local.global_textures); i++) {
@@ -290,7 +341,6 @@ void render_shutdown() {
 
 	local = {};
 
-	radix_sort_clean();
 	hierarchy_shutdown();
 }
 
@@ -317,6 +367,61 @@ inline uint64_t render_sort_id_from_queue(int32_t queue_position) {
 
 ///////////////////////////////////////////
 
+// Picks the coarsest LOD whose error still projects to less than the
+// allowed number of pixels, as seen from the view currently being drawn.
+// Switching to a coarser level than the mesh's last pick needs some extra
+// margin, so objects sitting right at a threshold don't flicker. Instances
+// of one mesh share that state, which only shifts where the band sits for
+// them, every pick is still within the band of its own threshold.
+inline mesh_t render_lod_select(mesh_t mesh, const XMMATRIX &transform) {
+	// Occluders are rasterized from their own CPU data, which LODs don't
+	// keep.
+	int32_t lod_count = mesh->lod_count;
+	if (lod_count == 0 || mesh->occluder) return mesh;
+
+	XMVECTOR center   = XMVector3Transform(math_vec3_to_fast(mesh->bounds.center), transform);
+	float    scale    = fmaxf(XMVectorGetX(XMVector3LengthSq(transform.r[0])), fmaxf(
+	                          XMVectorGetX(XMVector3LengthSq(transform.r[1])),
+	                          XMVectorGetX(XMVector3LengthSq(transform.r[2]))));
+	scale = sqrtf(scale);
+	float radius   = vec3_magnitude(mesh->bounds.dimensions) * 0.5f * scale;
+	float pixels_per_unit = local.lod_pixel_scale * scale;
+	if (local.lod_perspective) {
+		float distance = XMVectorGetX(XMVector3Length(XMVectorSubtract(center, math_vec3_to_fast(local.lod_view_pos)))) - radius;
+		if (distance <= 0.001f) {
+			mesh->lod_last = 0;
+			return mesh;
+		}
+		pixels_per_unit /= distance;
+	}
+
+	int32_t lod = lod_count;
+	for (; lod > 0; lod--) {
+		float limit = lod > mesh->lod_last
+			? local.lod_pixel_error * (1 - local.lod_hysteresis)
+			: local.lod_pixel_error;
+		if (mesh->lods[lod - 1].error * pixels_per_unit <= limit) break;
+	}
+	mesh->lod_last = lod;
+	return lod == 0 ? mesh : mesh->lods[lod - 1].mesh;
+}
+
+///////////////////////////////////////////
+
+// The mesh and index count an item actually draws with from the current
+// view. Items that only draw part of their mesh can't swap in a LOD.
+inline mesh_t render_item_mesh(const render_item_t *item, int32_t *out_mesh_inds) {
+	if (item->mesh->lod_count == 0 || item->mesh_inds != (int32_t)item->mesh->ind_count) {
+		*out_mesh_inds = item->mesh_inds;
+		return item->mesh;
+	}
+	mesh_t mesh = render_lod_select(item->mesh, item->transform);
+	*out_mesh_inds = (int32_t)mesh->ind_count;
+	return mesh;
+}
+
+///////////////////////////////////////////
+
 void render_set_clip(float near_plane, float far_plane) {
 	// near_plane will throw divide by zero errors if it's zero! So we'll
 	// clamp it :) Anything this low will probably look bad due to depth
@@ -627,6 +732,30 @@ render_layer_ render_get_filter() {
 
 ///////////////////////////////////////////
 
+void render_set_occlusion(bool32_t enabled) {
+	local.occlusion_enabled = enabled;
+}
+
+///////////////////////////////////////////
+
+bool32_t render_get_occlusion() {
+	return local.occlusion_enabled;
+}
+
+///////////////////////////////////////////
+
+void render_set_view_budget(int32_t max_views_per_frame) {
+	local.view_budget = max_views_per_frame < 0 ? 0 : max_views_per_frame;
+}
+
+///////////////////////////////////////////
+
+int32_t render_get_view_budget() {
+	return local.view_budget;
+}
+
+///////////////////////////////////////////
+
 void render_set_filter(render_layer_ layer_filter) {
 	local.primary_filter = layer_filter;
 }
@@ -724,6 +853,13 @@ void render_global_texture(int32_t register_slot, tex_t texture) {
 
 ///////////////////////////////////////////
 
+void render_set_lod(float max_pixel_error, float hysteresis) {
+	local.lod_pixel_error = fmaxf(0, max_pixel_error);
+	local.lod_hysteresis  = fminf(fmaxf(0, hysteresis), 1);
+}
+
+///////////////////////////////////////////
+
 void render_set_clear_color(color128 color) {
 	local.clear_col = color_to_linear(color);
 }
@@ -791,6 +927,37 @@ void render_draw_queue(render_list_t list, const matrix *views, const matrix *pr
 		local.global_buffer.proj    [i] = XMMatrixTranspose(projection_f);
 		local.global_buffer.proj_inv[i] = XMMatrixTranspose(proj_inv);
 		local.global_buffer.viewproj[i] = XMMatrixTranspose(view_f * projection_f);
+
+		local.cull_viewproj[i] = view_f * projection_f;
+		local.cull_cam_pos [i] = cam_pos;
+	}
+	local.cull_view_count = view_count;
+
+	// LODs are picked for the first view, both eyes are close enough that it
+	// doesn't matter which. This needs how many pixels a unit covers at 1m,
+	// which comes from the projection's vertical scale and the target height.
+	{
+		XMMATRIX   projection_f;
+		math_matrix_to_fast(projections[eye_offset], &projection_f);
+		skg_tex_t *target = skg_tex_target_get();
+		float      height = target != nullptr ? (float)target->height : (float)device_display_get_height();
+		XMStoreFloat3((XMFLOAT3*)&local.lod_view_pos, local.cull_cam_pos[0]);
+		local.lod_perspective = XMVectorGetW(projection_f.r[3]) == 0;
+		local.lod_pixel_scale = height * 0.5f * fabsf(XMVectorGetY(projection_f.r[1]));
+	}
+
+	// Occluders in this list are rasterized for these views, and then
+	// everything else gets checked against them as the list executes.
+	if (local.occlusion_enabled) {
+		profiler_zone_begin("Occlusion");
+		render_occlusion_begin(local.cull_viewproj, view_count);
+		for (int32_t i = 0; i < list->queue.count; i++) {
+			const render_item_t *item = &list->queue[i];
+			if (item->mesh->occluder && (item->layer & filter) != 0)
+				render_occlusion_add(item->mesh, item->transform);
+		}
+		local.occlusion_active = render_occlusion_end();
+		profiler_zone_end();
 	}
 
 	// Copy in the other global shader variables
@@ -836,15 +1003,116 @@ void render_draw_queue(render_list_t list, const matrix *views, const matrix *pr
 	skg_event_begin("Execute Render List");
 
 	render_list_execute(list, filter, view_count, 0, INT_MAX);
+	local.occlusion_active = false;
 
 	skg_event_end();
 }
 
 ///////////////////////////////////////////
 
+// Captures are drawn into pooled render targets, so something like a video
+// recorder asking for a capture every frame doesn't create and destroy
+// textures every frame. They're read back a few frames later, but note that
+// sk_gpu has no asynchronous readback, so tex_get_data still copies to a
+// staging texture and waits on it here. That's a GPU sync, same as before.
+void render_capture_readback(render_capture_pending_t *pending) {
+	render_capture_target_t *target = &local.capture_targets[pending->target];
+	int32_t w    = target->width;
+	int32_t h    = target->height;
+	size_t  size = sizeof(color32) * w * h;
+
+#if defined(SKG_OPENGL)
+	// GL textures are stored bottom-up, so the rows get flipped as part of
+	// the one copy out of the scratch memory.
+	local.capture_scratch.clear();
+	local.capture_scratch.resize((int32_t)size);
+	tex_get_data(target->resolve, local.capture_scratch.data, size);
+	size_t line_size = skg_tex_fmt_pitch(target->resolve->tex.format, w);
+	for (int32_t y = 0; y < h; y++) {
+		memcpy(((uint8_t*)target->buffer)             + line_size * y,
+		       local.capture_scratch.data + line_size * ((h - 1) - y), line_size);
+	}
+#else
+	tex_get_data(target->resolve, target->buffer, size);
+#endif
+
+	// Notify that the color data is ready!
+	pending->request.render_on_screenshot_callback(target->buffer, w, h, pending->request.context);
+	target->in_use = false;
+}
+
+///////////////////////////////////////////
+
+int32_t render_capture_target_get(int32_t width, int32_t height, tex_format_ format) {
+	uint64_t frame = time_frame();
+	for (int32_t i = 0; i < local.capture_targets.count; i++) {
+		render_capture_target_t *target = &local.capture_targets[i];
+		if (target->in_use == false && target->width == width && target->height == height && target->format == format) {
+			target->in_use     = true;
+			target->last_frame = frame;
+			return i;
+		}
+	}
+
+	render_capture_target_t target = {};
+	target.width      = width;
+	target.height     = height;
+	target.format     = format;
+	target.in_use     = true;
+	target.last_frame = frame;
+	target.surface    = tex_create_rendertarget(width, height, 8, format, tex_format_depthstencil);
+	target.resolve    = tex_create_rendertarget(width, height, 1, format, tex_format_none);
+	target.buffer     = sk_malloc_t(color32, width * height);
+	return local.capture_targets.add(target);
+}
+
+///////////////////////////////////////////
+
+void render_capture_target_release(int32_t index) {
+	render_capture_target_t *target = &local.capture_targets[index];
+	tex_release(target->surface);
+	tex_release(target->resolve);
+	sk_free    (target->buffer);
+	local.capture_targets.remove(index);
+}
+
+///////////////////////////////////////////
+
+void render_capture_flush() {
+	for (int32_t i = 0; i < local.capture_pending.count; i++)
+		render_capture_readback(&local.capture_pending[i]);
+	local.capture_pending.clear();
+}
+
+///////////////////////////////////////////
+
 // The screenshots are produced in FIFO order, meaning the
 // order of screenshot requests by users is preserved.
 void render_check_screenshots() {
+	if (local.screenshot_list.count == 0 && local.capture_pending.count == 0 && local.capture_targets.count == 0) return;
+
+	// Deliver captures that have had enough time to finish on the GPU
+	uint64_t frame = time_frame();
+	int32_t  ready = 0;
+	while (ready < local.capture_pending.count && local.capture_pending[ready].read_frame <= frame) {
+		render_capture_readback(&local.capture_pending[ready]);
+		ready += 1;
+	}
+	for (int32_t i = 0; i < ready; i++)
+		local.capture_pending.remove(0);
+
+	// Drop targets that haven't been asked for in a while, like after a
+	// recording has stopped.
+	for (int32_t i = local.capture_targets.count - 1; i >= 0; i--) {
+		if (local.capture_targets[i].in_use == false && frame - local.capture_targets[i].last_frame > render_capture_keep_frames) {
+			render_capture_target_release(i);
+			for (int32_t p = 0; p < local.capture_pending.count; p++) {
+				if (local.capture_pending[p].target > i)
+					local.capture_pending[p].target -= 1;
+			}
+		}
+	}
+
 	if (local.screenshot_list.count == 0) return;
 
 	skg_tex_t *old_target = skg_tex_target_get();
@@ -853,13 +1121,10 @@ void render_check_screenshots() {
 		int32_t  w = local.screenshot_list[i].width;
 		int32_t  h = local.screenshot_list[i].height;
 
-		// Create the screenshot surface
-		size_t   size   = sizeof(color32) * w * h;
-		color32 *buffer = (color32*)sk_malloc(size);
-		
 		// Setup to render the screenshot
-		tex_t render_capture_surface = tex_create_rendertarget(w, h, 8, local.screenshot_list[i].tex_format, tex_format_depthstencil);
-		skg_tex_target_bind(&render_capture_surface->tex, -1, 0);
+		int32_t                  target_id = render_capture_target_get(w, h, local.screenshot_list[i].tex_format);
+		render_capture_target_t *target    = &local.capture_targets[target_id];
+		skg_tex_target_bind(&target->surface->tex, -1, 0);
 
 		// Set up the viewport if we've got one!
 		if (local.screenshot_list[i].viewport.w != 0) {
@@ -887,27 +1152,14 @@ void render_check_screenshots() {
 		render_draw_queue(local.list_primary, &local.screenshot_list[i].camera, &local.screenshot_list[i].projection, 0, 1, local.screenshot_list[i].layer_filter);
 		skg_tex_target_bind(nullptr, -1, 0);
 
-		tex_t resolve_tex = tex_create_rendertarget(w, h, 1, local.screenshot_list[i].tex_format, tex_format_none);
-		skg_tex_copy_to(&render_capture_surface->tex, -1, &resolve_tex->tex, -1);
-		tex_get_data(resolve_tex, buffer, size);
-#if defined(SKG_OPENGL)
-		int32_t line_size = skg_tex_fmt_pitch(resolve_tex->tex.format, resolve_tex->tex.width);
-		void* tmp = sk_malloc(line_size);
-		for (int32_t y = 0; y < resolve_tex->tex.height / 2; y++) {
-			void* top_line = ((uint8_t*)buffer) + line_size * y;
-			void* bot_line = ((uint8_t*)buffer) + line_size * ((resolve_tex->tex.height - 1) - y);
-			memcpy(tmp,      top_line, line_size);
-			memcpy(top_line, bot_line, line_size);
-			memcpy(bot_line, tmp,      line_size);
-		}
-		sk_free(tmp);
-#endif
-		tex_release(resolve_tex);
-		tex_release(render_capture_surface);
+		// Resolve now, but don't read it back until a later frame
+		skg_tex_copy_to(&target->surface->tex, -1, &target->resolve->tex, -1);
 
-		// Notify that the color data is ready!
-		local.screenshot_list[i].render_on_screenshot_callback(buffer, w, h, local.screenshot_list[i].context);
-		sk_free(buffer);
+		render_capture_pending_t pending = {};
+		pending.request    = local.screenshot_list[i];
+		pending.target     = target_id;
+		pending.read_frame = frame + render_capture_delay;
+		local.capture_pending.add(pending);
 		skg_event_end();
 	}
 	local.screenshot_list.clear();
@@ -916,39 +1168,135 @@ void render_check_screenshots() {
 
 ///////////////////////////////////////////
 
-void render_check_viewpoints() {
-	if (local.viewpoint_list.count == 0) return;
+void render_draw_viewpoint(tex_t target, const matrix &camera, const matrix &projection, rect_t viewport, render_clear_ clear, render_layer_ layer_filter) {
+	skg_event_begin("Viewpoint");
+	// Setup to render the viewpoint
+	skg_tex_target_bind(&target->tex, -1, 0);
 
-	skg_tex_t *old_target = skg_tex_target_get();
-	for (int32_t i = 0; i < local.viewpoint_list.count; i++) {
-		skg_event_begin("Viewpoint");
-		// Setup to render the screenshot
-		skg_tex_target_bind(&local.viewpoint_list[i].rendertarget->tex, -1, 0);
+	// Clear the viewport
+	if (clear != render_clear_none) {
+		skg_target_clear(
+			(clear & render_clear_depth),
+			(clear & render_clear_color) ? &local.clear_col.r : (float *)nullptr);
+	}
 
-		// Clear the viewport
-		if (local.viewpoint_list[i].clear != render_clear_none) {
-			skg_target_clear(
-				(local.viewpoint_list[i].clear & render_clear_depth),
-				(local.viewpoint_list[i].clear & render_clear_color) ? &local.clear_col.r : (float *)nullptr);
+	// Set up the viewport if we've got one!
+	if (viewport.w != 0) {
+		int32_t viewport_px[4] = {
+			(int32_t)(viewport.x * target->width ),
+			(int32_t)(viewport.y * target->height),
+			(int32_t)(viewport.w * target->width ),
+			(int32_t)(viewport.h * target->height) };
+		skg_viewport(viewport_px);
+	}
+
+	// Render!
+	render_draw_queue(local.list_primary, &camera, &projection, 0, 1, layer_filter);
+	skg_tex_target_bind(nullptr, -1, 0);
+	skg_event_end();
+}
+
+///////////////////////////////////////////
+
+void render_list_layer_hashes(render_list_t list, uint64_t *out_layer_hashes) {
+	for (int32_t l = 0; l < 16; l++)
+		out_layer_hashes[l] = HASH_FNV64_START;
+
+	// Fields are hashed one at a time, so struct padding can't make two
+	// identical frames look different. Text, lines and UI batches refill the
+	// same dynamic meshes every frame at the same transform, so the mesh's
+	// data version is what tells us their contents changed. Materials keep a
+	// version the same way, covering parameters, texture assignments, and
+	// render state for the whole chain. What a texture holds isn't tracked,
+	// so render targets, video, or texture edits need render_view_set_dirty.
+	for (int32_t i = 0; i < list->queue.count; i++) {
+		const render_item_t *item = &list->queue[i];
+		uint64_t hash = hash_fnv64_data(&item->transform, sizeof(item->transform));
+		hash = hash_fnv64_data(&item->color,     sizeof(item->color    ), hash);
+		hash = hash_fnv64_data(&item->mesh,      sizeof(item->mesh     ), hash);
+		hash = hash_fnv64_data(&item->material,  sizeof(item->material ), hash);
+		hash = hash_fnv64_data(&item->mesh_inds, sizeof(item->mesh_inds), hash);
+		hash = hash_fnv64_data(&item->mesh->data_version, sizeof(item->mesh->data_version), hash);
+		for (material_t mat = item->material; mat != nullptr; mat = mat->chain)
+			hash = hash_fnv64_data(&mat->data_version, sizeof(mat->data_version), hash);
+		for (int32_t l = 0; l < 16; l++) {
+			if (item->layer & (1 << l))
+				out_layer_hashes[l] = hash_fnv64_data(&hash, sizeof(hash), out_layer_hashes[l]);
 		}
+	}
+}
 
-		// Set up the viewport if we've got one!
-		if (local.viewpoint_list[i].viewport.w != 0) {
-			int32_t viewport[4] = {
-				(int32_t)(local.viewpoint_list[i].viewport.x * local.viewpoint_list[i].rendertarget->width ),
-				(int32_t)(local.viewpoint_list[i].viewport.y * local.viewpoint_list[i].rendertarget->height),
-				(int32_t)(local.viewpoint_list[i].viewport.w * local.viewpoint_list[i].rendertarget->width ),
-				(int32_t)(local.viewpoint_list[i].viewport.h * local.viewpoint_list[i].rendertarget->height) };
-			skg_viewport(viewport);
+///////////////////////////////////////////
+
+void render_check_views() {
+	if (local.view_list.count == 0) return;
+
+	double   now            = time_total_unscaled();
+	int32_t  count          = local.view_list.count;
+	int32_t  budget         = local.view_budget > 0 ? local.view_budget : count;
+	int32_t  start          = local.view_next % count;
+	int32_t  drawn          = 0;
+	bool     hashes_ready   = false;
+	uint64_t layer_hashes[16];
+
+	// Round-robin from wherever the last frame left off, so a tight budget
+	// still gets around to every view eventually.
+	for (int32_t n = 0; n < count && drawn < budget; n++) {
+		int32_t       idx  = (start + n) % count;
+		render_view_t view = local.view_list[idx];
+		if (!view->enabled) continue;
+		if (view->drawn && view->rate > 0 && now - view->drawn_time < 1.0 / view->rate) continue;
+
+		// Only pay for hashing the list if a view is actually due
+		if (!hashes_ready) {
+			render_list_layer_hashes(local.list_primary, layer_hashes);
+			hashes_ready = true;
+		}
+		uint64_t contents = HASH_FNV64_START;
+		for (int32_t l = 0; l < 16; l++) {
+			if (view->layer_filter & (1 << l))
+				contents = hash_fnv64_data(&layer_hashes[l], sizeof(uint64_t), contents);
 		}
 
-		// Render!
-		render_draw_queue(local.list_primary, &local.viewpoint_list[i].camera, &local.viewpoint_list[i].projection, 0, 1, local.viewpoint_list[i].layer_filter);
-		skg_tex_target_bind(nullptr, -1, 0);
+		bool changed = !view->drawn || view->dirty
+			|| view->drawn_contents != contents
+			|| view->drawn_width    != view->target->width
+			|| view->drawn_height   != view->target->height
+			|| memcmp(&view->drawn_camera,     &view->camera,     sizeof(matrix)) != 0
+			|| memcmp(&view->drawn_projection, &view->projection, sizeof(matrix)) != 0;
+		if (!changed) continue;
+
+		render_draw_viewpoint(view->target, view->camera, view->projection, view->viewport, view->clear, view->layer_filter);
+		view->dirty            = false;
+		view->drawn            = true;
+		view->drawn_time       = now;
+		view->drawn_camera     = view->camera;
+		view->drawn_projection = view->projection;
+		view->drawn_width      = view->target->width;
+		view->drawn_height     = view->target->height;
+		view->drawn_contents   = contents;
+		local.view_next        = idx + 1;
+		drawn++;
+	}
+}
+
+///////////////////////////////////////////
+
+void render_check_viewpoints() {
+	if (local.viewpoint_list.count == 0 && local.view_list.count == 0) return;
+
+	skg_tex_t *old_target = skg_tex_target_get();
+
+	// Persistent views go first, since they hash the list in the order it
+	// was submitted, before anything has had a chance to sort it.
+	render_check_views();
+
+	for (int32_t i = 0; i < local.viewpoint_list.count; i++) {
+		render_viewpoint_t *viewpoint = &local.viewpoint_list[i];
+		render_draw_viewpoint(viewpoint->rendertarget, viewpoint->camera, viewpoint->projection, viewpoint->viewport, viewpoint->clear, viewpoint->layer_filter);
 
 		// Release the reference we added, the user should have their own ref
-		tex_release(local.viewpoint_list[i].rendertarget);
-		skg_event_end();
+		tex_release(viewpoint->rendertarget);
 	}
 	local.viewpoint_list.clear();
 	skg_tex_target_bind(old_target, -1, 0);
@@ -961,6 +1309,7 @@ void render_clear() {
 	render_list_clear(local.list_primary);
 
 	local.last_material = nullptr;
+	local.last_pipeline = nullptr;
 	local.last_shader   = nullptr;
 	local.last_mesh     = nullptr;
 }
@@ -993,6 +1342,7 @@ void render_blit_to_bound(material_t material) {
 	skg_draw(0, 0, local.blit_quad->ind_count, 1);
 
 	local.last_material = nullptr;
+	local.last_pipeline = nullptr;
 	local.last_mesh     = nullptr;
 	local.last_shader   = nullptr;
 }
@@ -1112,8 +1462,13 @@ void render_set_material(material_t material) {
 		}
 	}
 
-	// And bind the pipeline
-	skg_pipeline_bind(&material->pipeline);
+	// And bind the pipeline, materials with matching state share one, so
+	// this is often already bound.
+	if (material->pipeline != local.last_pipeline) {
+		local.last_pipeline = material->pipeline;
+		local.list_active->stats.swaps_pipeline++;
+		skg_pipeline_bind(&material->pipeline->pipeline);
+	}
 }
 
 ///////////////////////////////////////////
@@ -1325,7 +1680,87 @@ inline void render_list_execute_run(_render_list_t *list, material_t material, c
 
 ///////////////////////////////////////////
 
+// Draws a single clustered mesh instance, culling its clusters against each
+// view's frustum and skipping clusters whose triangles all face away from
+// every camera. Visible clusters that sit next to each other in the index
+// buffer are merged into a single draw.
+void render_list_execute_clusters(_render_list_t *list, material_t material, const render_item_t *item, uint32_t view_count) {
+	mesh_t                mesh          = item->mesh;
+	int32_t               cluster_count = mesh->cluster_count;
+	const mesh_cluster_t *clusters      = mesh->clusters;
+
+	// Culling happens in the mesh's own space, so clusters don't need to be
+	// transformed. Only the side planes are used, the near and far planes
+	// differ between depth conventions.
+	int32_t  views = local.cull_view_count;
+	XMVECTOR planes [2][4];
+	XMVECTOR cam_pos[2];
+	XMVECTOR det;
+	XMMATRIX to_local = XMMatrixInverse(&det, item->transform);
+	for (int32_t v = 0; v < views; v++) {
+		XMMATRIX clip = XMMatrixTranspose(item->transform * local.cull_viewproj[v]);
+		planes[v][0] = XMVectorAdd     (clip.r[3], clip.r[0]);
+		planes[v][1] = XMVectorSubtract(clip.r[3], clip.r[0]);
+		planes[v][2] = XMVectorAdd     (clip.r[3], clip.r[1]);
+		planes[v][3] = XMVectorSubtract(clip.r[3], clip.r[1]);
+		for (int32_t p = 0; p < 4; p++)
+			planes[v][p] = XMVectorDivide(planes[v][p], XMVector3Length(planes[v][p]));
+		cam_pos[v] = XMVector3Transform(local.cull_cam_pos[v], to_local);
+	}
+	// Mirrored transforms flip the winding, and double sided materials
+	// don't cull backfaces at all.
+	bool cull_backfaces = material->cull == cull_back && XMVectorGetX(det) > 0;
+
+	render_set_material(material);
+	skg_mesh_bind      (&mesh->gpu_mesh);
+	list->stats.swaps_mesh++;
+
+	int32_t offsets = 0, inst_count = 0;
+	local.instance_list.add(render_transform_buffer_t{ XMMatrixTranspose(item->transform), item->color });
+	skg_buffer_t *instances = render_fill_inst_buffer(&local.instance_list, &offsets, &inst_count);
+	skg_buffer_bind(instances, render_list_inst_bind);
+	local.instance_list.clear();
+
+	uint32_t run_start = 0;
+	uint32_t run_count = 0;
+	for (int32_t c = 0; c < cluster_count; c++) {
+		const mesh_cluster_t *cluster = &clusters[c];
+		XMVECTOR center  = math_vec3_to_fast(cluster->center);
+		XMVECTOR apex    = math_vec3_to_fast(cluster->cone_apex);
+		XMVECTOR axis    = math_vec3_to_fast(cluster->cone_axis);
+		bool     visible = false;
+		for (int32_t v = 0; v < views && !visible; v++) {
+			bool inside = true;
+			for (int32_t p = 0; p < 4 && inside; p++)
+				inside = XMVectorGetX(XMPlaneDotCoord(planes[v][p], center)) >= -cluster->radius;
+			if (!inside) continue;
+
+			visible = !cull_backfaces || XMVectorGetX(XMVector3Dot(XMVector3Normalize(XMVectorSubtract(apex, cam_pos[v])), axis)) < cluster->cone_cutoff;
+		}
+		if (!visible) continue;
+
+		if (run_count > 0 && run_start + run_count == cluster->ind_start) {
+			run_count += cluster->ind_count;
+			continue;
+		}
+		if (run_count > 0) {
+			skg_draw(run_start, 0, run_count, view_count);
+			list->stats.draw_calls += 1;
+		}
+		run_start = cluster->ind_start;
+		run_count = cluster->ind_count;
+	}
+	if (run_count > 0) {
+		skg_draw(run_start, 0, run_count, view_count);
+		list->stats.draw_calls += 1;
+	}
+	list->stats.draw_instances += 1;
+}
+
+///////////////////////////////////////////
+
 void render_list_execute(render_list_t list, render_layer_ filter, uint32_t view_count, int32_t queue_start, int32_t queue_end) {
+	profiler_scope("Render List");
 	list->state = render_list_state_rendering;
 
 	if (list->queue.count == 0) {
@@ -1337,6 +1772,8 @@ void render_list_execute(render_list_t list, render_layer_ filter, uint32_t view
 	uint64_t sort_id_end   = render_sort_id_from_queue(queue_end);
 
 	render_item_t *run_start = nullptr;
+	mesh_t         run_mesh  = nullptr;
+	int32_t        run_inds  = 0;
 	for (int32_t i = 0; i < list->queue.count; i++) {
 		render_item_t *item = &list->queue[i];
 		
@@ -1344,19 +1781,40 @@ void render_list_execute(render_list_t list, render_layer_ filter, uint32_t view
 		if ((item->layer & filter) == 0 || item->sort_id < sort_id_start) continue;
 		// End early if we're past the end of the desired queue range
 		if (item->sort_id >= sort_id_end) break;
+		// Skip anything completely hidden behind occluders
+		if (local.occlusion_active && !item->mesh->occluder && render_occlusion_test(item->mesh->bounds, item->transform)) {
+			list->stats.occluded++;
+			continue;
+		}
+
+		int32_t mesh_inds;
+		mesh_t  mesh = render_item_mesh(item, &mesh_inds);
+
+		// Clustered meshes are culled per instance, so they can't join a run
+		if (mesh->cluster_count > 0 && mesh_inds == (int32_t)mesh->ind_count) {
+			if (local.instance_list.count > 0) {
+				render_list_execute_run(list, run_start->material, &run_mesh->gpu_mesh, run_inds, view_count);
+				local.instance_list.clear();
+			}
+			run_start = nullptr;
+			render_list_execute_clusters(list, item->material, item, view_count);
+			continue;
+		}
 
 		// If it's the first in the run, record the material/mesh
 		if (run_start == nullptr) {
 			run_start = item;
 		}
 		// If the material/mesh changed
-		else if (run_start->material != item->material || run_start->mesh != item->mesh) {
+		else if (run_start->material != item->material || run_mesh != mesh || run_inds != mesh_inds) {
 			// Render the run that just ended
-			render_list_execute_run(list, run_start->material, &run_start->mesh->gpu_mesh, run_start->mesh_inds, view_count);
+			render_list_execute_run(list, run_start->material, &run_mesh->gpu_mesh, run_inds, view_count);
 			local.instance_list.clear();
 			// Start the next run
 			run_start = item;
 		}
+		run_mesh = mesh;
+		run_inds = mesh_inds;
 
 		// Add the current item to the run of instances
 		XMMATRIX transpose = XMMatrixTranspose(item->transform);
@@ -1365,13 +1823,14 @@ void render_list_execute(render_list_t list, render_layer_ filter, uint32_t view
 	// Render the last remaining run, which won't be triggered by the loop's
 	// conditions
 	if (local.instance_list.count > 0) {
-		render_list_execute_run(list, run_start->material, &run_start->mesh->gpu_mesh, run_start->mesh_inds, view_count);
+		render_list_execute_run(list, run_start->material, &run_mesh->gpu_mesh, run_inds, view_count);
 		local.instance_list.clear();
 	}
 
 	list->state = render_list_state_rendered;
 
 	local.last_material = nullptr;
+	local.last_pipeline = nullptr;
 	local.last_shader   = nullptr;
 	local.last_mesh     = nullptr;
 }
@@ -1393,6 +1852,8 @@ void render_list_execute_material(render_list_t list, render_layer_ filter, uint
 	uint64_t sort_id_end   = render_sort_id_from_queue(queue_end);
 
 	render_item_t *run_start = nullptr;
+	mesh_t         run_mesh  = nullptr;
+	int32_t        run_inds  = 0;
 	for (int32_t i = 0; i < list->queue.count; i++) {
 		render_item_t *item = &list->queue[i];
 
@@ -1400,19 +1861,40 @@ void render_list_execute_material(render_list_t list, render_layer_ filter, uint
 		if ((item->layer & filter) == 0 || item->sort_id < sort_id_start) continue;
 		// End early if we're past the end of the desired queue range
 		if (item->sort_id >= sort_id_end) break;
+		// Skip anything completely hidden behind occluders
+		if (local.occlusion_active && !item->mesh->occluder && render_occlusion_test(item->mesh->bounds, item->transform)) {
+			list->stats.occluded++;
+			continue;
+		}
+
+		int32_t mesh_inds;
+		mesh_t  mesh = render_item_mesh(item, &mesh_inds);
+
+		// Clustered meshes are culled per instance, so they can't join a run
+		if (mesh->cluster_count > 0 && mesh_inds == (int32_t)mesh->ind_count) {
+			if (local.instance_list.count > 0) {
+				render_list_execute_run(list, override_material, &run_mesh->gpu_mesh, run_inds, view_count);
+				local.instance_list.clear();
+			}
+			run_start = nullptr;
+			render_list_execute_clusters(list, override_material, item, view_count);
+			continue;
+		}
 
 		// If it's the first in the run, record the material/mesh
 		if (run_start == nullptr) {
 			run_start = item;
 		}
 		// If the mesh changed
-		else if (run_start->mesh != item->mesh) {
+		else if (run_mesh != mesh || run_inds != mesh_inds) {
 			// Render the run that just ended
-			render_list_execute_run(list, override_material, &run_start->mesh->gpu_mesh, run_start->mesh_inds, view_count);
+			render_list_execute_run(list, override_material, &run_mesh->gpu_mesh, run_inds, view_count);
 			local.instance_list.clear();
 			// Start the next run
 			run_start = item;
 		}
+		run_mesh = mesh;
+		run_inds = mesh_inds;
 
 		// Add the current item to the run of instances
 		XMMATRIX transpose = XMMatrixTranspose(item->transform);
@@ -1421,7 +1903,7 @@ void render_list_execute_material(render_list_t list, render_layer_ filter, uint
 	// Render the last remaining run, which won't be triggered by the loop's
 	// conditions
 	if (local.instance_list.count > 0) {
-		render_list_execute_run(list, override_material, &run_start->mesh->gpu_mesh, run_start->mesh_inds, view_count);
+		render_list_execute_run(list, override_material, &run_mesh->gpu_mesh, run_inds, view_count);
 		local.instance_list.clear();
 	}
 
@@ -1477,12 +1959,12 @@ int32_t render_list_prev_count(render_list_t list) {
 
 void render_list_add_mesh(render_list_t list, mesh_t mesh, material_t material, matrix transform, color128 color_linear, render_layer_ layer) {
 	render_item_t item;
-	item.mesh      = mesh;
-	item.mesh_inds = mesh->ind_draw;
 	item.color     = color_linear;
 	item.layer     = (uint16_t)layer;
 	if (hierarchy_use_top()) matrix_mul         (transform, hierarchy_top(), item.transform);
 	else                     math_matrix_to_fast(transform, &item.transform);
+	item.mesh      = mesh;
+	item.mesh_inds = mesh->ind_draw;
 
 	material_t curr = material;
 	while (curr != nullptr) {
@@ -1508,26 +1990,26 @@ void render_list_add_model_mat(render_list_t list, model_t model, material_t mat
 
 	anim_update_model(model);
 	for (int32_t i = 0; i < model->visuals.count; i++) {
-		const model_visual_t *vis = &model->visuals[i];
+		model_visual_t *vis = &model->visuals[i];
 		if (vis->visible == false || vis->mesh == nullptr || vis->material == nullptr) continue;
 		
 		render_item_t item;
-		item.mesh      = vis->mesh;
-		item.mesh_inds = vis->mesh->ind_count;
 		item.color     = color_linear;
 		item.layer     = (uint16_t)layer;
 		matrix_mul(vis->transform_model, root, item.transform);
+		item.mesh      = vis->mesh;
+		item.mesh_inds = item.mesh->ind_count;
 
 		material_t curr = material_override == nullptr ? vis->material : material_override;
 		while (curr != nullptr) {
 			item.material = curr;
-			item.sort_id  = render_sort_id(curr, vis->mesh);
+			item.sort_id  = render_sort_id(curr, item.mesh);
 			render_list_add_to(list, &item);
 			curr = curr->chain;
 		}
 	}
 
-	if (model->transforms_changed && model->anim_data.skeletons.count > 0) {
+	if (model->transforms_changed && model->proto->anim_data.skeletons.count > 0) {
 		model->transforms_changed = false;
 		anim_update_skin(model);
 	}
@@ -1560,6 +2042,114 @@ void render_list_draw_now(render_list_t list, tex_t to_rendertarget, matrix came
 	skg_tex_target_bind(old_target, -1, 0);
 }
 
+///////////////////////////////////////////
+// Render View                           //
+///////////////////////////////////////////
+
+render_view_t render_view_find(const char* id) {
+	render_view_t result = (render_view_t)assets_find(id, asset_type_render_view);
+	if (result != nullptr) {
+		render_view_addref(result);
+		return result;
+	}
+	return nullptr;
+}
+
+///////////////////////////////////////////
+
+render_view_t render_view_create(tex_t to_rendertarget, render_layer_ layer_filter, render_clear_ clear, rect_t viewport) {
+	if (to_rendertarget == nullptr || (to_rendertarget->type & tex_type_rendertarget) == 0) {
+		log_err("render_view_create texture must be a render target texture type!");
+		return nullptr;
+	}
+
+	render_view_t result = (render_view_t)assets_allocate(asset_type_render_view);
+	tex_addref(to_rendertarget);
+	result->target       = to_rendertarget;
+	result->camera       = matrix_identity;
+	result->projection   = matrix_identity;
+	result->viewport     = viewport;
+	result->layer_filter = layer_filter;
+	result->clear        = clear;
+	result->enabled      = true;
+	result->dirty        = true;
+	local.view_list.add(result);
+	return result;
+}
+
+///////////////////////////////////////////
+
+void render_view_set_id(render_view_t view, const char* id) {
+	assets_set_id(&view->header, id);
+}
+
+///////////////////////////////////////////
+
+const char* render_view_get_id(const render_view_t view) {
+	return view->header.id_text;
+}
+
+///////////////////////////////////////////
+
+void render_view_addref(render_view_t view) {
+	assets_addref(&view->header);
+}
+
+///////////////////////////////////////////
+
+void render_view_release(render_view_t view) {
+	if (view == nullptr)
+		return;
+	assets_releaseref(&view->header);
+}
+
+///////////////////////////////////////////
+
+void render_view_destroy(render_view_t view) {
+	if (view == nullptr) return;
+	int32_t idx = local.view_list.index_of(view);
+	if (idx >= 0) local.view_list.remove(idx);
+	tex_release(view->target);
+	*view = {};
+}
+
+///////////////////////////////////////////
+
+void render_view_set_camera(render_view_t view, const matrix &camera, const matrix &projection) {
+	matrix_inverse(camera, view->camera);
+	view->projection = projection;
+}
+
+///////////////////////////////////////////
+
+void render_view_set_rate(render_view_t view, float updates_per_second) {
+	view->rate = updates_per_second < 0 ? 0 : updates_per_second;
+}
+
+///////////////////////////////////////////
+
+float render_view_get_rate(const render_view_t view) {
+	return view->rate;
+}
+
+///////////////////////////////////////////
+
+void render_view_set_enabled(render_view_t view, bool32_t enabled) {
+	view->enabled = enabled;
+}
+
+///////////////////////////////////////////
+
+bool32_t render_view_get_enabled(const render_view_t view) {
+	return view->enabled;
+}
+
+///////////////////////////////////////////
+
+void render_view_set_dirty(render_view_t view) {
+	view->dirty = true;
+}
+
 ///////////////////////////////////////////
 // Radix render sorting!                 //
 ///////////////////////////////////////////
@@ -1577,22 +2167,6 @@ const uint64_t RADIX_MASK   = RADIX_SIZE - 1;
 
 using freq_array_type = size_t [RADIX_LEVELS][RADIX_SIZE];
 
-// Since this sort is specifically for the render queue, we'll reserve a
-// chunk of memory that sticks around, and resizes if it's too small.
-render_item_t *radix_queue_area = nullptr;
-size_t         radix_queue_size = 0;
-
-void radix_sort_init() {
-	radix_queue_area = nullptr;
-	radix_queue_size = 0;
-}
-
-void radix_sort_clean() {
-	sk_free(radix_queue_area);
-	radix_queue_area = nullptr;
-	radix_queue_size = 0;
-}
-
 // never inline just to make it show up easily in profiles (inlining this lengthly function doesn't
 // really help anyways)
 static void count_frequency(render_item_t *a, size_t count, freq_array_type freqs) {
@@ -1624,16 +2198,14 @@ static bool is_trivial(size_t freqs[RADIX_SIZE], size_t count) {
 }
 
 void radix_sort7(render_item_t *a, size_t count) {
-	// Resize up if needed
-	if (radix_queue_size < count) {
-		sk_free(radix_queue_area);
-		radix_queue_area = sk_malloc_t(render_item_t, count);
-		radix_queue_size = count;
-	}
+	// Sorting is always done with and forgotten about within a frame, so the
+	// scratch space comes from the frame arena.
+	render_item_t *scratch = sk_frame_alloc_t(render_item_t, count);
+
 	freq_array_type freqs = {};
 	count_frequency(a, count, freqs);
 
-	render_item_t *from = a, *to = radix_queue_area;
+	render_item_t *from = a, *to = scratch;
 
 	for (size_t pass = 0; pass < RADIX_LEVELS; pass++) {
 
@@ -14,8 +14,10 @@ struct render_stats_t {
 	int swaps_mesh;
 	int swaps_texture;
 	int swaps_material;
+	int swaps_pipeline;
 	int draw_calls;
 	int draw_instances;
+	int occluded;
 };
 
 bool          render_init                 ();
@@ -42,6 +44,7 @@ void          render_check_viewpoints     ();
 void          render_check_pending_skytex ();
 
 void          render_list_destroy         (      render_list_t list);
+void          render_view_destroy         (      render_view_t view);
 void          render_list_execute         (      render_list_t list, render_layer_ filter, uint32_t view_count, int32_t queue_start, int32_t queue_end);
 void          render_list_execute_material(      render_list_t list, render_layer_ filter, uint32_t view_count, int32_t queue_start, int32_t queue_end, material_t override_material);
 
@@ -43,5 +43,30 @@ struct _render_list_t {
 	int32_t                prev_count;
 };
 
+// A persistent render_to. It only redraws when its camera, its target, or
+// the contents of the layers it can see have changed, and no more often than
+// its rate allows.
+struct _render_view_t {
+	asset_header_t         header;
+	tex_t                  target;
+	matrix                 camera; // Inverted, like the one-off viewpoints
+	matrix                 projection;
+	rect_t                 viewport;
+	render_layer_          layer_filter;
+	render_clear_          clear;
+	float                  rate;
+	bool32_t               enabled;
+	bool32_t               dirty;
+
+	// What the target currently holds
+	bool32_t               drawn;
+	double                 drawn_time;
+	matrix                 drawn_camera;
+	matrix                 drawn_projection;
+	int32_t                drawn_width;
+	int32_t                drawn_height;
+	uint64_t               drawn_contents;
+};
+
 
 } // namespace sk
\ No newline at end of file
@@ -0,0 +1,299 @@
+#include "render_occlusion.h"
+#include "../sk_memory.h"
+#include "../libraries/array.h"
+#include "../asset_types/mesh.h"
+
+#include <float.h>
+#include <math.h>
+#include <string.h>
+
+using namespace DirectX;
+
+namespace sk {
+
+///////////////////////////////////////////
+
+// Occluders are meant to be simple stand-ins, so a small buffer is plenty.
+// The width must be a multiple of 4, since rows are filled 4 pixels at a
+// time.
+const int32_t occlusion_width     = 128;
+const int32_t occlusion_height    = 128;
+const int32_t occlusion_levels    = 6;
+const int32_t occlusion_max_views = 2;
+// Triangles that come this close to the camera plane are skipped instead of
+// clipped, which can only make occlusion less aggressive, never wrong.
+const float   occlusion_near_w    = 0.001f;
+
+struct occlusion_view_t {
+	XMMATRIX viewproj;
+	float   *levels[occlusion_levels];
+};
+
+struct occlusion_state_t {
+	occlusion_view_t  views[occlusion_max_views];
+	int32_t           view_count;
+	bool              has_occluders;
+	float            *memory;
+	float            *scratch;
+	array_t<XMFLOAT4> clip_verts;
+};
+static occlusion_state_t local = {};
+
+void occlusion_raster_tri(float *depth, const XMFLOAT4 &a, const XMFLOAT4 &b, const XMFLOAT4 &c);
+void occlusion_erode     (float *depth, float *scratch);
+
+///////////////////////////////////////////
+
+void render_occlusion_shutdown() {
+	sk_free(local.memory);
+	local.clip_verts.free();
+	local = {};
+}
+
+///////////////////////////////////////////
+
+void render_occlusion_begin(const XMMATRIX *viewproj, int32_t view_count) {
+	if (local.memory == nullptr) {
+		int32_t view_size = 0;
+		for (int32_t l = 0; l < occlusion_levels; l++)
+			view_size += (occlusion_width >> l) * (occlusion_height >> l);
+
+		local.memory = sk_malloc_t(float, view_size * occlusion_max_views + occlusion_width * occlusion_height);
+		float *curr  = local.memory;
+		for (int32_t v = 0; v < occlusion_max_views; v++) {
+			for (int32_t l = 0; l < occlusion_levels; l++) {
+				local.views[v].levels[l] = curr;
+				curr += (occlusion_width >> l) * (occlusion_height >> l);
+			}
+		}
+		local.scratch = curr;
+	}
+
+	local.view_count    = view_count > occlusion_max_views ? occlusion_max_views : view_count;
+	local.has_occluders = false;
+
+	// Depth here is 1/w, which is the same everywhere for an orthographic
+	// projection, so nothing could ever be found behind anything. Rather
+	// than cull incorrectly, occlusion just sits those views out.
+	for (int32_t v = 0; v < local.view_count; v++) {
+		XMFLOAT4X4 m;
+		XMStoreFloat4x4(&m, viewproj[v]);
+		if (m._14 == 0 && m._24 == 0 && m._34 == 0) {
+			local.view_count = 0;
+			return;
+		}
+	}
+
+	for (int32_t v = 0; v < local.view_count; v++) {
+		local.views[v].viewproj = viewproj[v];
+		memset(local.views[v].levels[0], 0, sizeof(float) * occlusion_width * occlusion_height);
+	}
+}
+
+///////////////////////////////////////////
+
+void render_occlusion_add(mesh_t occluder, const XMMATRIX &transform) {
+	if (occluder->verts == nullptr || occluder->inds == nullptr || local.view_count == 0) return;
+	local.has_occluders = true;
+
+	local.clip_verts.clear();
+	XMFLOAT4 *clip = local.clip_verts.add_empty_range((int32_t)occluder->vert_count);
+	for (int32_t v = 0; v < local.view_count; v++) {
+		XMMATRIX to_clip = transform * local.views[v].viewproj;
+		for (uint32_t i = 0; i < occluder->vert_count; i++)
+			XMStoreFloat4(&clip[i], XMVector3Transform(math_vec3_to_fast(occluder->verts[i].pos), to_clip));
+
+		const vind_t *inds = occluder->inds;
+		for (uint32_t i = 0; i < occluder->ind_count; i += 3)
+			occlusion_raster_tri(local.views[v].levels[0], clip[inds[i]], clip[inds[i+1]], clip[inds[i+2]]);
+	}
+}
+
+///////////////////////////////////////////
+
+bool render_occlusion_end() {
+	if (!local.has_occluders) return false;
+
+	// Each level keeps the farthest occluder depth of the 4 texels beneath
+	// it, so a single read can vouch for a whole region.
+	for (int32_t v = 0; v < local.view_count; v++) {
+		occlusion_erode(local.views[v].levels[0], local.scratch);
+		for (int32_t l = 1; l < occlusion_levels; l++) {
+			const float *src   = local.views[v].levels[l - 1];
+			float       *dst   = local.views[v].levels[l];
+			int32_t      w     = occlusion_width  >> l;
+			int32_t      h     = occlusion_height >> l;
+			int32_t      src_w = w * 2;
+			for (int32_t y = 0; y < h; y++) {
+				const float *row0 = &src[(y * 2    ) * src_w];
+				const float *row1 = &src[(y * 2 + 1) * src_w];
+				for (int32_t x = 0; x < w; x++) {
+					dst[y * w + x] = fminf(
+						fminf(row0[x * 2], row0[x * 2 + 1]),
+						fminf(row1[x * 2], row1[x * 2 + 1]));
+				}
+			}
+		}
+	}
+	return true;
+}
+
+///////////////////////////////////////////
+
+bool render_occlusion_test(const bounds_t &bounds, const XMMATRIX &transform) {
+	if (!local.has_occluders) return false;
+
+	XMVECTOR center = math_vec3_to_fast(bounds.center);
+	XMVECTOR half   = XMVectorScale(math_vec3_to_fast(bounds.dimensions), 0.5f);
+	for (int32_t v = 0; v < local.view_count; v++) {
+		XMMATRIX to_clip = transform * local.views[v].viewproj;
+
+		// Screen rect and closest depth of the bounds
+		float min_x = FLT_MAX, max_x = -FLT_MAX;
+		float min_y = FLT_MAX, max_y = -FLT_MAX;
+		float closest = 0;
+		for (int32_t i = 0; i < 8; i++) {
+			XMVECTOR sign = XMVectorSet(i & 1 ? 1.0f : -1.0f, i & 2 ? 1.0f : -1.0f, i & 4 ? 1.0f : -1.0f, 0);
+			XMVECTOR pt   = XMVector3Transform(XMVectorMultiplyAdd(half, sign, center), to_clip);
+			float    w    = XMVectorGetW(pt);
+			// Straddling the camera, there's no sensible rect for this
+			if (w < occlusion_near_w) return false;
+
+			float inv_w = 1.0f / w;
+			float x     = (XMVectorGetX(pt) * inv_w * 0.5f + 0.5f) * occlusion_width;
+			float y     = (XMVectorGetY(pt) * inv_w * 0.5f + 0.5f) * occlusion_height;
+			min_x   = fminf(min_x, x); max_x = fmaxf(max_x, x);
+			min_y   = fminf(min_y, y); max_y = fmaxf(max_y, y);
+			closest = fmaxf(closest, inv_w);
+		}
+
+		int32_t x0 = (int32_t)fmaxf(0, floorf(min_x));
+		int32_t y0 = (int32_t)fmaxf(0, floorf(min_y));
+		int32_t x1 = (int32_t)fminf(occlusion_width  - 1, floorf(max_x));
+		int32_t y1 = (int32_t)fminf(occlusion_height - 1, floorf(max_y));
+		// Entirely off screen for this view, so nothing here to draw
+		if (x0 > x1 || y0 > y1) continue;
+
+		// Find a level where the rect only touches a few texels
+		int32_t level = 0;
+		while (level < occlusion_levels - 1 &&
+			((x1 >> level) - (x0 >> level) > 2 || (y1 >> level) - (y0 >> level) > 2))
+			level++;
+
+		const float *depth    = local.views[v].levels[level];
+		int32_t      w        = occlusion_width >> level;
+		float        farthest = FLT_MAX;
+		for (int32_t y = y0 >> level; y <= (y1 >> level); y++) {
+			for (int32_t x = x0 >> level; x <= (x1 >> level); x++) {
+				farthest = fminf(farthest, depth[y * w + x]);
+			}
+		}
+		if (closest >= farthest) return false;
+	}
+	return true;
+}
+
+///////////////////////////////////////////
+
+// Triangles only write texels whose centers they cover, but the test treats
+// every texel a bounds touches as fully covered. Taking the farthest depth
+// of each texel's 3x3 neighborhood makes those agree: a texel only keeps its
+// depth if the occluders reach past all of its edges, and since depth is
+// planar across a triangle, the neighbors also bound the depth anywhere
+// inside it. Anything past the edge of the buffer counts as empty.
+void occlusion_erode(float *depth, float *scratch) {
+	const int32_t w = occlusion_width;
+	const int32_t h = occlusion_height;
+	for (int32_t y = 0; y < h; y++) {
+		const float *src = &depth  [y * w];
+		float       *dst = &scratch[y * w];
+		dst[0    ] = 0;
+		dst[w - 1] = 0;
+		for (int32_t x = 1; x < w - 1; x++)
+			dst[x] = fminf(src[x - 1], fminf(src[x], src[x + 1]));
+	}
+	memset(&depth[0        ], 0, sizeof(float) * w);
+	memset(&depth[(h-1) * w], 0, sizeof(float) * w);
+	for (int32_t y = 1; y < h - 1; y++) {
+		const float *above = &scratch[(y - 1) * w];
+		const float *row   = &scratch[(y    ) * w];
+		const float *below = &scratch[(y + 1) * w];
+		float       *dst   = &depth  [(y    ) * w];
+		for (int32_t x = 0; x < w; x++)
+			dst[x] = fminf(above[x], fminf(row[x], below[x]));
+	}
+}
+
+///////////////////////////////////////////
+
+void occlusion_raster_tri(float *depth, const XMFLOAT4 &a, const XMFLOAT4 &b, const XMFLOAT4 &c) {
+	if (a.w < occlusion_near_w || b.w < occlusion_near_w || c.w < occlusion_near_w) return;
+
+	// 1/w is linear in screen space, so that's what gets interpolated and
+	// stored. Larger values are closer, and 0 is infinitely far away.
+	const XMFLOAT4 *pts[3] = { &a, &b, &c };
+	float x[3], y[3], inv_w[3];
+	for (int32_t i = 0; i < 3; i++) {
+		inv_w[i] = 1.0f / pts[i]->w;
+		x[i] = (pts[i]->x * inv_w[i] * 0.5f + 0.5f) * occlusion_width;
+		y[i] = (pts[i]->y * inv_w[i] * 0.5f + 0.5f) * occlusion_height;
+	}
+
+	// Occluders aren't backface culled, so wind everything the same way
+	float area = (x[1] - x[0]) * (y[2] - y[0]) - (y[1] - y[0]) * (x[2] - x[0]);
+	if (fabsf(area) < 0.0001f) return;
+	if (area < 0) {
+		float t;
+		t = x    [1]; x    [1] = x    [2]; x    [2] = t;
+		t = y    [1]; y    [1] = y    [2]; y    [2] = t;
+		t = inv_w[1]; inv_w[1] = inv_w[2]; inv_w[2] = t;
+		area = -area;
+	}
+
+	int32_t min_x = (int32_t)fmaxf(0,                    floorf(fminf(x[0], fminf(x[1], x[2]))));
+	int32_t max_x = (int32_t)fminf(occlusion_width  - 1, floorf(fmaxf(x[0], fmaxf(x[1], x[2]))));
+	int32_t min_y = (int32_t)fmaxf(0,                    floorf(fminf(y[0], fminf(y[1], y[2]))));
+	int32_t max_y = (int32_t)fminf(occlusion_height - 1, floorf(fmaxf(y[0], fmaxf(y[1], y[2]))));
+	if (min_x > max_x || min_y > max_y) return;
+	min_x &= ~3;
+
+	// Edge functions as a*x + b*y + c, each one is the weight of the vertex
+	// opposite to it.
+	XMVECTOR edge_a[3], edge_b[3], edge_c[3];
+	for (int32_t e = 0; e < 3; e++) {
+		int32_t i = (e + 1) % 3;
+		int32_t j = (e + 2) % 3;
+		edge_a[e] = XMVectorReplicate(-(y[j] - y[i]));
+		edge_b[e] = XMVectorReplicate(  x[j] - x[i] );
+		edge_c[e] = XMVectorReplicate((y[j] - y[i]) * x[i] - (x[j] - x[i]) * y[i]);
+	}
+	XMVECTOR depth_0  = XMVectorReplicate(inv_w[0] / area);
+	XMVECTOR depth_1  = XMVectorReplicate(inv_w[1] / area);
+	XMVECTOR depth_2  = XMVectorReplicate(inv_w[2] / area);
+	XMVECTOR offsets  = XMVectorSet(0.5f, 1.5f, 2.5f, 3.5f);
+	XMVECTOR zero     = XMVectorZero();
+
+	for (int32_t py = min_y; py <= max_y; py++) {
+		float   *row = &depth[py * occlusion_width];
+		XMVECTOR fy  = XMVectorReplicate(py + 0.5f);
+		XMVECTOR row_c[3];
+		for (int32_t e = 0; e < 3; e++)
+			row_c[e] = XMVectorMultiplyAdd(edge_b[e], fy, edge_c[e]);
+
+		for (int32_t px = min_x; px <= max_x; px += 4) {
+			XMVECTOR fx = XMVectorAdd(XMVectorReplicate((float)px), offsets);
+			XMVECTOR w0 = XMVectorMultiplyAdd(edge_a[0], fx, row_c[0]);
+			XMVECTOR w1 = XMVectorMultiplyAdd(edge_a[1], fx, row_c[1]);
+			XMVECTOR w2 = XMVectorMultiplyAdd(edge_a[2], fx, row_c[2]);
+			XMVECTOR inside = XMVectorAndInt(
+				XMVectorAndInt(XMVectorGreaterOrEqual(w0, zero), XMVectorGreaterOrEqual(w1, zero)),
+				XMVectorGreaterOrEqual(w2, zero));
+
+			XMVECTOR tri_depth = XMVectorMultiplyAdd(w0, depth_0, XMVectorMultiplyAdd(w1, depth_1, XMVectorMultiply(w2, depth_2)));
+			XMVECTOR old_depth = XMLoadFloat4((XMFLOAT4 *)&row[px]);
+			XMStoreFloat4((XMFLOAT4 *)&row[px], XMVectorSelect(old_depth, XMVectorMax(old_depth, tri_depth), inside));
+		}
+	}
+}
+
+} // namespace sk
@@ -0,0 +1,22 @@
+#pragma once
+
+#include "../stereokit.h"
+#include "../sk_math_dx.h"
+
+namespace sk {
+
+// A coarse CPU depth buffer for occlusion culling. Meshes marked as
+// occluders get rasterized into a small buffer for each view, and a pyramid
+// of the farthest occluder depth is built from that, so bounds can be tested
+// against it with only a handful of reads. Nothing here touches the GPU, so
+// it works the same on every backend.
+
+void render_occlusion_shutdown();
+
+void render_occlusion_begin   (const DirectX::XMMATRIX *viewproj, int32_t view_count);
+void render_occlusion_add     (mesh_t occluder, const DirectX::XMMATRIX &transform);
+bool render_occlusion_end     ();
+// True if the bounds are completely hidden behind occluders in every view.
+bool render_occlusion_test    (const bounds_t &bounds, const DirectX::XMMATRIX &transform);
+
+} // namespace sk
@@ -37,7 +37,7 @@ void sprite_buffer_ensure_capacity(sprite_buffer_t &buffer) {
 
 	// regenerate indices
 	vind_t  quads = (vind_t)(buffer.vert_cap / 4);
-	vind_t *inds  = sk_malloc_t(vind_t, quads * 6);
+	vind_t *inds  = sk_frame_alloc_t(vind_t, quads * 6);
 	for (vind_t i = 0; i < quads; i++) {
 		vind_t q = i * 4;
 		vind_t c = i * 6;
@@ -50,7 +50,6 @@ void sprite_buffer_ensure_capacity(sprite_buffer_t &buffer) {
 		inds[c+5] = q;
 	}
 	mesh_set_inds(buffer.mesh, inds, quads * 6);
-	sk_free(inds);
 }
 
 ///////////////////////////////////////////
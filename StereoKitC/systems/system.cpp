@@ -1,4 +1,5 @@
 #include "system.h"
+#include "profiler.h"
 
 #include <stdlib.h>
 #include <string.h>
@@ -6,6 +7,9 @@
 #include "../libraries/stref.h"
 #include "../libraries/array.h"
 #include "../libraries/sokol_time.h"
+#include "../utils/jobs.h"
+#include "../libraries/ferr_thread.h"
+#include "../asset_types/assets.h"
 #include "../stereokit.h"
 #include "../sk_memory.h"
 
@@ -24,8 +28,10 @@ bool              systems_initialized = false;
 
 ///////////////////////////////////////////
 
-int32_t systems_find_id(const char *name);
-bool    systems_sort   ();
+int32_t systems_find_id     (const char *name);
+bool    systems_sort        ();
+void    systems_assign_waves(sort_dependency_t *dependencies);
+void    systems_execute_wave(int32_t start, int32_t end);
 
 int32_t topological_sort      (sort_dependency_t *dependencies, int32_t count, int32_t *ref_order);
 int32_t topological_sort_visit(sort_dependency_t *dependencies, int32_t count, int32_t index, uint8_t *marks, int32_t *sorted_curr, int32_t *out_order);
@@ -92,7 +98,25 @@ bool systems_sort() {
 
 		result = topological_sort(update_ids, systems.count, update_order);
 		if (result != 0) log_errf("Invalid update dependencies! Cyclic dependency detected at %s!", systems[result].name);
-		else systems.reorder(update_order);
+		else {
+			systems.reorder(update_order);
+
+			// Dependency ids still refer to the pre-sort order, so remap them
+			int32_t *remap = sk_malloc_t(int32_t, systems.count);
+			for (int32_t i = 0; i < systems.count; i++)
+				remap[update_order[i]] = i;
+			sort_dependency_t *sorted_ids = sk_malloc_t(sort_dependency_t, systems.count);
+			for (int32_t i = 0; i < systems.count; i++) {
+				sorted_ids[i] = update_ids[update_order[i]];
+				for (int32_t d = 0; d < sorted_ids[i].count; d++)
+					sorted_ids[i].ids[d] = remap[sorted_ids[i].ids[d]];
+			}
+			memcpy(update_ids, sorted_ids, sizeof(sort_dependency_t) * systems.count);
+			sk_free(sorted_ids);
+			sk_free(remap);
+
+			systems_assign_waves(update_ids);
+		}
 
 		sk_free(update_order);
 	}
@@ -132,26 +156,165 @@ bool systems_sort() {
 
 ///////////////////////////////////////////
 
+void systems_assign_waves(sort_dependency_t *dependencies) {
+	// Systems are already in dependency order here, so each one can be
+	// placed one wave past the latest of its dependencies.
+	int32_t max_wave = 0;
+	for (int32_t i = 0; i < systems.count; i++) {
+		int32_t wave = 0;
+		for (int32_t d = 0; d < dependencies[i].count; d++) {
+			int32_t dep_wave = systems[dependencies[i].ids[d]].step_wave + 1;
+			if (dep_wave > wave) wave = dep_wave;
+		}
+		systems[i].step_wave = wave;
+		if (wave > max_wave) max_wave = wave;
+	}
+
+	// Group each wave together, while keeping the existing order within
+	// the wave. Since waves only ever increase along a dependency, this is
+	// still a valid dependency order.
+	int32_t *wave_order = sk_malloc_t(int32_t, systems.count);
+	int32_t  curr       = 0;
+	for (int32_t w = 0; w <= max_wave; w++) {
+		for (int32_t i = 0; i < systems.count; i++) {
+			if (systems[i].step_wave == w)
+				wave_order[curr++] = i;
+		}
+	}
+	systems.reorder(wave_order);
+	sk_free(wave_order);
+}
+
+///////////////////////////////////////////
+
+struct system_init_t {
+	system_t    *system;
+	int32_t     *deps;
+	int32_t      dep_count;
+	job_batch_t *job;
+	int32_t      state;
+	bool         result;
+};
+enum {
+	system_init_pending,
+	system_init_running,
+	system_init_done,
+};
+
+///////////////////////////////////////////
+
+void system_init_execute(system_init_t *init) {
+	log_diagf("Initializing %s", init->system->name);
+
+	// start timing
+	uint64_t start = stm_now();
+
+	init->result = init->system->func_initialize();
+	if (!init->result)
+		log_errf("System %s failed to initialize!", init->system->name);
+
+	// end timing
+	init->system->profile_start_duration = stm_since(start);
+	profiler_system_time(-1, init->system->name, start, init->system->profile_start_duration);
+}
+
+///////////////////////////////////////////
+
 bool systems_initialize() {
 	if (!systems_sort())
 		return false;
 
+	// Systems initialize as soon as everything they depend on is done.
+	// Systems that aren't flagged main_thread_init are handed off to the
+	// job pool, while this thread takes care of the rest.
+	system_init_t *inits = sk_malloc_zero_t(system_init_t, systems.count);
 	for (int32_t i = 0; i < systems.count; i++) {
-		int32_t index = system_init_order[i];
-		if (systems[index].func_initialize == nullptr) continue;
-		log_diagf("Initializing %s", systems[index].name);
+		system_init_t *init = &inits[system_init_order[i]];
+		init->system    = &systems[system_init_order[i]];
+		init->deps      = sk_malloc_t(int32_t, init->system->init_dependency_count);
+		init->dep_count = init->system->init_dependency_count;
+		for (int32_t d = 0; d < init->dep_count; d++)
+			init->deps[d] = systems_find_idx(init->system->init_dependencies[d]);
+	}
 
-		// start timing
-		uint64_t start = stm_now();
+	bool    success   = true;
+	int32_t remaining = systems.count;
+	while (remaining > 0) {
+		bool           progress  = false;
+		system_init_t *main_next = nullptr;
+
+		for (int32_t i = 0; i < systems.count; i++) {
+			system_init_t *init = &inits[system_init_order[i]];
+
+			// Collect anything that's finished on a worker
+			if (init->state == system_init_running && jobs_done(init->job)) {
+				jobs_finish(init->job);
+				init->job   = nullptr;
+				init->state = system_init_done;
+				success     = success && init->result;
+				remaining  -= 1;
+				progress    = true;
+			}
+			if (init->state != system_init_pending) continue;
+
+			// Once something has failed, we stop starting new systems, but
+			// still let the running ones finish up.
+			bool ready = success;
+			for (int32_t d = 0; ready && d < init->dep_count; d++)
+				ready = inits[init->deps[d]].state == system_init_done;
+			if (!ready) continue;
+
+			// Workers get their systems first, so they're busy while this
+			// thread works through its own list.
+			if (init->system->func_initialize == nullptr) {
+				init->result = true;
+				init->state  = system_init_done;
+				remaining   -= 1;
+				progress     = true;
+			} else if (init->system->main_thread_init) {
+				if (main_next == nullptr) main_next = init;
+			} else {
+				init->state = system_init_running;
+				init->job   = jobs_start(1, [](int32_t, void *context) {
+					system_init_execute((system_init_t *)context);
+				}, init);
+			}
+		}
 
-		if (!systems[index].func_initialize()) {
-			log_errf("System %s failed to initialize!", systems[index].name);
-			return false;
+		if (main_next != nullptr) {
+			system_init_execute(main_next);
+			main_next->state = system_init_done;
+			success          = success && main_next->result;
+			remaining       -= 1;
+			progress         = true;
 		}
 
-		// end timing
-		systems[index].profile_start_duration = stm_since(start);
+		if (!success) {
+			bool running = false;
+			for (int32_t i = 0; i < systems.count; i++) {
+				if (inits[i].state == system_init_running) running = true;
+			}
+			if (!running) break;
+		}
+
+		// Nothing for this thread to do right now, so help out with any
+		// systems still waiting for a worker, and keep any GPU work the
+		// workers are waiting on flowing.
+		if (!progress) {
+			for (int32_t i = 0; i < systems.count; i++) {
+				if (inits[i].state == system_init_running) jobs_poll(inits[i].job);
+			}
+			assets_execute_gpu_jobs();
+			ft_yield();
+		}
 	}
+
+	for (int32_t i = 0; i < systems.count; i++)
+		sk_free(inits[i].deps);
+	sk_free(inits);
+
+	if (!success) return false;
+
 	systems_initialized = true;
 	log_info("Initialization successful");
 	return true;
@@ -172,6 +335,7 @@ void system_execute(system_t *sys) {
 		sys->profile_frame_duration = stm_since(sys->profile_frame_start);
 	sys->profile_step_duration += sys->profile_frame_duration;
 	sys->profile_step_count    += 1;
+	profiler_system_time((int32_t)(sys - systems.data), sys->name, sys->profile_frame_start, sys->profile_frame_duration);
 	sys->profile_frame_duration = 0;
 }
 
@@ -185,8 +349,52 @@ void systems_step_partial(system_run_ run_section, int32_t system_idx) {
 	default:                { start = 0;          end = systems.count; } break;
 	}
 
-	for (int32_t i=start; i<end; i++)
-		system_execute(&systems[i]);
+	while (start < end) {
+		int32_t wave_end = start + 1;
+		while (wave_end < end && systems[wave_end].step_wave == systems[start].step_wave)
+			wave_end++;
+
+		systems_execute_wave(start, wave_end);
+		start = wave_end;
+	}
+}
+
+///////////////////////////////////////////
+
+void systems_execute_wave(int32_t start, int32_t end) {
+	// Only systems that actually do something each step are worth sending
+	// off to another thread.
+	int32_t   worker_count = 0;
+	int32_t   step_count   = 0;
+	system_t *worker_systems[16];
+	for (int32_t i = start; i < end; i++) {
+		if (systems[i].func_step == nullptr) continue;
+		step_count += 1;
+		if (!systems[i].main_thread && worker_count < (int32_t)(sizeof(worker_systems)/sizeof(worker_systems[0])))
+			worker_systems[worker_count++] = &systems[i];
+	}
+
+	if (step_count <= 1 || worker_count == 0) {
+		for (int32_t i = start; i < end; i++)
+			system_execute(&systems[i]);
+		return;
+	}
+
+	// Workers pick up the thread-safe systems, while this thread runs the
+	// main thread ones, and then helps finish up whatever is left.
+	job_batch_t *batch = jobs_start(worker_count, [](int32_t index, void *context) {
+		system_execute(((system_t **)context)[index]);
+	}, worker_systems);
+
+	for (int32_t i = start; i < end; i++) {
+		bool queued = false;
+		for (int32_t w = 0; w < worker_count; w++) {
+			if (worker_systems[w] == &systems[i]) { queued = true; break; }
+		}
+		if (!queued) system_execute(&systems[i]);
+	}
+
+	jobs_finish(batch);
 }
 
 ///////////////////////////////////////////
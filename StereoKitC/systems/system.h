@@ -21,6 +21,16 @@ struct system_t {
 	const char **step_dependencies;
 	int32_t      step_dependency_count;
 
+	// Systems in the same step wave have no dependencies between them, and
+	// may step at the same time on different threads, unless they're
+	// flagged as main_thread.
+	bool         main_thread;
+	int32_t      step_wave;
+
+	// Initialization follows the init dependencies instead, and anything not
+	// flagged main_thread_init may initialize on a worker.
+	bool         main_thread_init;
+
 	uint64_t profile_frame_start;
 	uint64_t profile_frame_duration;
 
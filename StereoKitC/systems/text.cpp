@@ -2,6 +2,7 @@
 #include "../stereokit.h"
 #include "../asset_types/font.h"
 #include "../systems/defaults.h"
+#include "../systems/profiler.h"
 #include "../hierarchy.h"
 #include "../sk_math_dx.h"
 #include "../sk_math.h"
@@ -78,7 +79,7 @@ void text_buffer_check_dirty_inds(text_buffer_t& buffer) {
 
 	// regenerate indices
 	vind_t  quads = (vind_t)(buffer.vert_cap / 4);
-	vind_t *inds  = sk_malloc_t(vind_t, quads * 6);
+	vind_t *inds  = sk_frame_alloc_t(vind_t, quads * 6);
 	for (vind_t i = 0; i < quads; i++) {
 		vind_t q = i * 4;
 		vind_t c = i * 6;
@@ -91,7 +92,6 @@ void text_buffer_check_dirty_inds(text_buffer_t& buffer) {
 		inds[c+5] = q;
 	}
 	mesh_set_inds(buffer.mesh, inds, quads * 6);
-	sk_free(inds);
 }
 
 ///////////////////////////////////////////
@@ -529,6 +529,7 @@ template<typename C, bool (*char_decode_b_T)(const C *, const C **, char32_t *)>
 float text_add_in_g(const C* text, const matrix& transform, vec2 size, text_fit_ fit, text_style_t style_id, text_align_ position, text_align_ align, float off_x, float off_y, float off_z, color128 vertex_tint_linear) {
 	if (text == nullptr) return 0;
 	if (size.x <= 0) return 0; // Zero width text isn't visible, and causes issues when trying to determine text height.
+	profiler_scope("Text Layout");
 
 	XMMATRIX tr;
 	if (hierarchy_use_top()) {
@@ -10,6 +10,8 @@
 #include "../sk_memory.h"
 #include "../sk_math.h"
 #include "../libraries/array.h"
+#include "../libraries/atomic_util.h"
+#include "../libraries/ferr_thread.h"
 #include "../libraries/stref.h"
 #include "../platforms/platform.h"
 
@@ -60,6 +62,22 @@ struct fp_path_t {
 	array_t<char*> fragments;
 };
 
+// A single directory listing, filtered and filled in on its own thread so
+// slow file systems never stall a frame. Listings are shared between that
+// thread, the picker and the listing cache, so whoever lets go of one last
+// frees it.
+struct fp_listing_t {
+	char              *folder;
+	char              *filter_key;
+	file_filter_t     *filters;
+	int32_t            filter_count;
+	array_t<fp_item_t> items;
+	ft_mutex_t         mutex;
+	volatile int32_t   refs;
+	volatile int32_t   done;
+	volatile int32_t   cancelled;
+};
+
 enum fp_sort_by_ {
 	fp_sort_by_name,
 	fp_sort_by_size
@@ -104,10 +122,23 @@ sprite_t                     spr_down                 = nullptr;
 sprite_t                     spr_grid                 = nullptr;
 sprite_t                     spr_list                 = nullptr;
 
+fp_listing_t                *fp_listing               = nullptr;
+int32_t                      fp_listing_read          = 0;
+bool                         fp_listing_replace       = false;
+array_t<fp_listing_t*>       fp_listing_cache         = {};
+const int32_t                fp_listing_cache_max     = 8;
+
 ///////////////////////////////////////////
 
-void file_picker_finish     ();
-void file_picker_open_folder(const char *folder);
+void          file_picker_finish         ();
+void          file_picker_open_folder    (const char *folder);
+void          file_picker_sort           ();
+char         *file_picker_filter_key     ();
+fp_listing_t *file_picker_listing_start  (const char *folder, const char *filter_key);
+int32_t       file_picker_listing_thread (void *listing_inst);
+void          file_picker_listing_release(fp_listing_t *listing);
+void          file_picker_listing_update ();
+bool          file_picker_loading        ();
 #if defined(SK_OS_WINDOWS_UWP)
 void file_picker_uwp_picked (IAsyncOperation<StorageFile> result, AsyncStatus status);
 #endif
@@ -325,26 +356,36 @@ void file_picker_open_folder(const char *folder) {
 	fp_items.each([](fp_item_t &item) { sk_free(item.name); });
 	fp_items.clear();
 
-	platform_iterate_dir(folder, nullptr, [](void*, const char *name, const platform_file_attr_t file_attr) {
-		bool valid = fp_filter_count == 0;
-		// If the extension matches our filter, add it
-		if (file_attr.file) {
-			for (int32_t e = 0; e < fp_filter_count; e++) {
-				if (string_endswith(name, fp_filters[e].ext, false)) {
-					valid = true;
-					break;
-				}
-			}
-		} else valid = true;
+	// Whatever was still being listed isn't needed anymore
+	if (fp_listing != nullptr) {
+		fp_listing->cancelled = true;
+		file_picker_listing_release(fp_listing);
+		fp_listing = nullptr;
+	}
 
-		if (valid) {
-			fp_item_t item;
-			item.name = string_copy(name);
-			item.file_attr = file_attr;
+	// A recent listing of this folder can be shown right away, while a
+	// fresh one is made in the background to replace it.
+	char   *filter_key = file_picker_filter_key();
+	int32_t cached     = -1;
+	for (int32_t i = 0; i < fp_listing_cache.count; i++) {
+		if (string_eq(fp_listing_cache[i]->folder, folder) && string_eq(fp_listing_cache[i]->filter_key, filter_key)) {
+			cached = i;
+			break;
+		}
+	}
+	if (cached != -1) {
+		const fp_listing_t *listing = fp_listing_cache[cached];
+		for (int32_t i = 0; i < listing->items.count; i++) {
+			fp_item_t item = listing->items[i];
+			item.name = string_copy(item.name);
 			fp_items.add(item);
 		}
-		});
-	fp_items.sort([](const fp_item_t& a, const fp_item_t& b) { return (fp_sort_order_asc ? 1 : -1) * ((a.file_attr.file != b.file_attr.file) ? a.file_attr.file - b.file_attr.file : strcmp(a.name, b.name)); });
+		file_picker_sort();
+	}
+	fp_listing         = file_picker_listing_start(folder, filter_key);
+	fp_listing_read    = 0;
+	fp_listing_replace = cached != -1;
+	sk_free(filter_key);
 
 	char *new_folder = string_copy(folder);
 	sk_free(fp_path.folder);
@@ -375,6 +416,170 @@ void file_picker_open_folder(const char *folder) {
 
 ///////////////////////////////////////////
 
+char *file_picker_filter_key() {
+	char *result = string_copy("");
+	for (int32_t e = 0; e < fp_filter_count; e++)
+		result = string_append(result, 2, fp_filters[e].ext, ";");
+	return result;
+}
+
+///////////////////////////////////////////
+
+fp_listing_t *file_picker_listing_start(const char *folder, const char *filter_key) {
+	fp_listing_t *result = sk_malloc_t(fp_listing_t, 1);
+	*result = {};
+	result->folder       = string_copy(folder);
+	result->filter_key   = string_copy(filter_key);
+	result->filter_count = fp_filter_count;
+	result->filters      = sk_malloc_t(file_filter_t, fp_filter_count);
+	result->mutex        = ft_mutex_create();
+	// One for the picker, one for the thread doing the listing
+	result->refs         = 2;
+	memcpy(result->filters, fp_filters, sizeof(file_filter_t) * fp_filter_count);
+
+#if defined(__EMSCRIPTEN__)
+	file_picker_listing_thread(result);
+#else
+	// Listings are never waited on, the refcount takes care of cleanup, so
+	// the thread is detached to let it release itself when done.
+	ft_thread_t thread = ft_thread_create(file_picker_listing_thread, result);
+	ft_thread_name  (thread, "StereoKit File Picker");
+	ft_thread_detach(thread);
+#endif
+	return result;
+}
+
+///////////////////////////////////////////
+
+int32_t file_picker_listing_thread(void *listing_inst) {
+	fp_listing_t *listing = (fp_listing_t *)listing_inst;
+
+	platform_iterate_dir(listing->folder, listing, [](void *callback_data, const char *name, const platform_file_attr_t file_attr) {
+		fp_listing_t *listing = (fp_listing_t *)callback_data;
+		if (listing->cancelled) return;
+
+		bool valid = listing->filter_count == 0;
+		// If the extension matches our filter, add it
+		if (file_attr.file) {
+			for (int32_t e = 0; e < listing->filter_count; e++) {
+				if (string_endswith(name, listing->filters[e].ext, false)) {
+					valid = true;
+					break;
+				}
+			}
+		} else valid = true;
+
+		if (valid) {
+			fp_item_t item;
+			item.name      = string_copy(name);
+			item.file_attr = file_attr;
+			ft_mutex_lock(listing->mutex);
+			listing->items.add(item);
+			ft_mutex_unlock(listing->mutex);
+		}
+	});
+
+	atomic_fence();
+	listing->done = true;
+	file_picker_listing_release(listing);
+	return 0;
+}
+
+///////////////////////////////////////////
+
+void file_picker_listing_release(fp_listing_t *listing) {
+	if (listing == nullptr || atomic_decrement(&listing->refs) > 0) return;
+
+	listing->items.each([](fp_item_t &item) { sk_free(item.name); });
+	listing->items.free();
+	ft_mutex_destroy(&listing->mutex);
+	sk_free(listing->folder);
+	sk_free(listing->filter_key);
+	sk_free(listing->filters);
+	sk_free(listing);
+}
+
+///////////////////////////////////////////
+
+void file_picker_listing_update() {
+	if (fp_listing == nullptr) return;
+
+	// Check this first, anything added before it was set is then
+	// guaranteed to be picked up below.
+	bool done = fp_listing->done;
+	if (fp_listing_replace && !done) return;
+
+	bool changed = false;
+	ft_mutex_lock(fp_listing->mutex);
+	if (fp_listing_replace) {
+		// Swap out the cached items for the fresh ones, and hang onto the
+		// selection if it's still around.
+		char *active = fp_active ? string_copy(fp_active) : nullptr;
+		fp_items.each([](fp_item_t &item) { sk_free(item.name); });
+		fp_items.clear();
+		fp_active = nullptr;
+		for (int32_t i = 0; i < fp_listing->items.count; i++) {
+			fp_item_t item = fp_listing->items[i];
+			item.name = string_copy(item.name);
+			if (active && string_eq(item.name, active))
+				fp_active = item.name;
+			fp_items.add(item);
+		}
+		sk_free(active);
+		fp_listing_replace = false;
+		changed            = true;
+	} else {
+		for (; fp_listing_read < fp_listing->items.count; fp_listing_read++) {
+			fp_item_t item = fp_listing->items[fp_listing_read];
+			item.name = string_copy(item.name);
+			fp_items.add(item);
+			changed = true;
+		}
+	}
+	ft_mutex_unlock(fp_listing->mutex);
+	if (changed) file_picker_sort();
+
+	if (!done) return;
+
+	// Finished listings go into the cache, the picker's reference is handed
+	// over to it.
+	for (int32_t i = 0; i < fp_listing_cache.count; i++) {
+		if (string_eq(fp_listing_cache[i]->folder,     fp_listing->folder) &&
+			string_eq(fp_listing_cache[i]->filter_key, fp_listing->filter_key)) {
+			file_picker_listing_release(fp_listing_cache[i]);
+			fp_listing_cache.remove(i);
+			break;
+		}
+	}
+	if (fp_listing_cache.count >= fp_listing_cache_max) {
+		file_picker_listing_release(fp_listing_cache[0]);
+		fp_listing_cache.remove(0);
+	}
+	fp_listing_cache.add(fp_listing);
+	fp_listing = nullptr;
+}
+
+///////////////////////////////////////////
+
+bool file_picker_loading() {
+	return fp_listing != nullptr && !fp_listing->done;
+}
+
+///////////////////////////////////////////
+
+void file_picker_sort() {
+	switch (fp_sortby) {
+	case fp_sort_by_name:
+		fp_items.sort([](const fp_item_t& a, const fp_item_t& b) { return (fp_sort_order_asc ? 1 : -1) * ((a.file_attr.file != b.file_attr.file) ? a.file_attr.file - b.file_attr.file : strcmp(a.name, b.name)); });
+		break;
+	case fp_sort_by_size:
+		fp_items.sort([](const fp_item_t& a, const fp_item_t& b) { return (fp_sort_order_asc ? 1 : -1) * (a.file_attr.size == b.file_attr.size ? strcmp(a.name, b.name) : a.file_attr.size - b.file_attr.size > 0 ? 1 : -1);});
+		break;
+	}
+}
+
+///////////////////////////////////////////
+
 void file_picker_finish() {
 	if (fp_callback) fp_callback(fp_call_data, fp_call_status, fp_filename, (int32_t)(strlen(fp_filename)+1));
 	fp_call_status = false;
@@ -405,6 +610,8 @@ void file_picker_click_item(fp_item_t item) {
 
 void file_picker_update() {
 	if (fp_show) {
+		file_picker_listing_update();
+
 		float line_height = ui_line_height();
 		vec2  size        = { .12f, line_height * 1.5f };
 
@@ -537,7 +744,11 @@ void file_picker_update() {
 		ui_panel_begin();
 		for (int32_t i = fp_scroll_offset; i < fp_scroll_offset + scroll_step; i++) {
 			if (i >= fp_items.count) {
-				ui_layout_reserve({ fp_list_mode ? size.x * 3 + 2*ui_get_gutter() : size.x, size.y }, false, 0.0f);
+				vec2 cell_size = { fp_list_mode ? size.x * 3 + 2*ui_get_gutter() : size.x, size.y };
+				if (i == fp_items.count && file_picker_loading())
+					ui_text_sz("Loading...", nullptr, ui_scroll_none, cell_size, text_align_center, text_fit_squeeze);
+				else
+					ui_layout_reserve(cell_size, false, 0.0f);
 				ui_sameline();
 				continue;
 			}
@@ -594,14 +805,8 @@ void file_picker_update() {
 			fp_list_mode = !fp_list_mode;
 		}
 		if (fp_sort_order_changed) {
-			switch (fp_sortby) {
-			case fp_sort_by_name:
-				fp_items.sort([](const fp_item_t& a, const fp_item_t& b) { return (fp_sort_order_asc ? 1 : -1) * ((a.file_attr.file != b.file_attr.file) ? a.file_attr.file - b.file_attr.file : strcmp(a.name, b.name)); });
-				break;
-			case fp_sort_by_size:
-				fp_items.sort([](const fp_item_t& a, const fp_item_t& b) { return (fp_sort_order_asc ? 1 : -1) * (a.file_attr.size == b.file_attr.size ? strcmp(a.name, b.name) : a.file_attr.size - b.file_attr.size > 0 ? 1 : -1);});
-				break;
-			}
+			fp_sort_order_changed = false;
+			file_picker_sort();
 		}
 	}
 
@@ -618,8 +823,20 @@ void file_picker_shutdown() {
 	fp_path.fragments.each(free);
 	fp_path.fragments.free();
 	fp_path = {};
+	fp_items.each([](fp_item_t &item) { sk_free(item.name); });
 	fp_items.free();
 
+	// A listing thread may still be running, it'll free its listing when it
+	// finishes.
+	if (fp_listing != nullptr) {
+		fp_listing->cancelled = true;
+		file_picker_listing_release(fp_listing);
+		fp_listing = nullptr;
+	}
+	for (int32_t i = 0; i < fp_listing_cache.count; i++)
+		file_picker_listing_release(fp_listing_cache[i]);
+	fp_listing_cache.free();
+
 #if defined(SK_OS_WINDOWS_UWP)
 	//fp_file_cache.free();
 #endif
@@ -37,6 +37,10 @@ const float    skui_pressed_depth  = 0.4f;
 const color128 skui_color_border   = { 1,1,1,1 };
 const float    skui_aura_radius    = 0.02f;
 
+// UI state lives in growable stacks rather than tagged allocations, so the
+// memory_tag_ui count is reconciled against their capacity each frame.
+int64_t  skui_tracked_memory;
+
 ///////////////////////////////////////////
 
 bool32_t ui_text_at(const char16_t* text, vec2* opt_ref_scroll, ui_scroll_ scroll_direction, text_fit_ fit, text_align_ text_align, vec3 window_relative_pos, vec2 size);
@@ -50,6 +54,7 @@ bool ui_init() {
 	skui_input_blink         = 0;
 	skui_system_move_type    = ui_move_face_user;
 	skui_enable_far_interact = true;
+	skui_tracked_memory      = 0;
 
 	ui_layout_init();
 	ui_theming_init();
@@ -67,6 +72,9 @@ void ui_shutdown() {
 	ui_core_shutdown();
 	ui_theming_shutdown();
 	ui_layout_shutdown();
+
+	sk_mem_tag_track(memory_tag_ui, -skui_tracked_memory);
+	skui_tracked_memory = 0;
 }
 
 ///////////////////////////////////////////
@@ -78,6 +86,12 @@ void ui_step() {
 	ui_push_surface(pose_identity);
 
 	skui_input_target_confirmed = false;
+
+	int64_t ui_memory = (int64_t)(ui_core_memory() + ui_layout_memory() + ui_theming_memory());
+	if (ui_memory != skui_tracked_memory) {
+		sk_mem_tag_track(memory_tag_ui, ui_memory - skui_tracked_memory);
+		skui_tracked_memory = ui_memory;
+	}
 }
 
 ///////////////////////////////////////////
@@ -22,6 +22,17 @@ struct layer_t {
 	vec3         pinch_pt_prev[handed_max];
 };
 
+// Broadphase info for the current layout area. Hands that can't reach the
+// area's bounds can't reach any element box inside of it either, so those
+// elements can skip their own box tests.
+struct reach_t {
+	bounds_t     bounds;
+	int32_t      layer;
+	bool         valid;
+	bool         poke [handed_max];
+	bool         pinch[handed_max];
+};
+
 struct ui_id_t {
 	uint64_t id;
 };
@@ -36,6 +47,7 @@ bool32_t        skui_show_volumes;
 array_t<bool32_t>    skui_enabled_stack;
 array_t<ui_id_t>     skui_id_stack;
 array_t<layer_t>     skui_layers;
+array_t<reach_t>     skui_reach_stack;
 array_t<bool>        skui_preserve_keyboard_stack;
 array_t<uint64_t>    skui_preserve_keyboard_ids[2];
 array_t<uint64_t>   *skui_preserve_keyboard_ids_read;
@@ -50,6 +62,7 @@ void ui_core_init() {
 	skui_enabled_stack            = {};
 	skui_id_stack                 = {};
 	skui_layers                   = {};
+	skui_reach_stack              = {};
 	skui_preserve_keyboard_stack  = {};
 	skui_preserve_keyboard_ids[0] = {};
 	skui_preserve_keyboard_ids[1] = {};
@@ -68,6 +81,7 @@ void ui_core_shutdown() {
 	skui_enabled_stack           .free();
 	skui_id_stack                .free();
 	skui_layers                  .free();
+	skui_reach_stack             .free();
 	skui_preserve_keyboard_stack .free();
 	skui_preserve_keyboard_ids[0].free();
 	skui_preserve_keyboard_ids[1].free();
@@ -78,6 +92,19 @@ void ui_core_shutdown() {
 
 ///////////////////////////////////////////
 
+size_t ui_core_memory() {
+	return
+		sizeof(bool32_t) * skui_enabled_stack           .capacity +
+		sizeof(ui_id_t ) * skui_id_stack                .capacity +
+		sizeof(layer_t ) * skui_layers                  .capacity +
+		sizeof(reach_t ) * skui_reach_stack             .capacity +
+		sizeof(bool    ) * skui_preserve_keyboard_stack .capacity +
+		sizeof(uint64_t) * skui_preserve_keyboard_ids[0].capacity +
+		sizeof(uint64_t) * skui_preserve_keyboard_ids[1].capacity;
+}
+
+///////////////////////////////////////////
+
 void ui_core_update() {
 	skui_finger_radius = 0;
 	const matrix *to_local = hierarchy_to_local();
@@ -540,7 +567,7 @@ void ui_box_interaction_1h_pinch(uint64_t id, vec3 box_unfocused_start, vec3 box
 		}
 
 		bounds_t bounds   = ui_size_box(box_start, box_size);
-		bool     in_box   = skui_hand[i].tracked && ui_in_box(skui_hand[i].finger, skui_hand[i].thumb, skui_finger_radius, bounds);
+		bool     in_box   = skui_hand[i].tracked && !ui_reach_culled(i, true, bounds) && ui_in_box(skui_hand[i].finger, skui_hand[i].thumb, skui_finger_radius, bounds);
 		float    priority = in_box
 			? bounds_sdf(bounds, skui_hand[i].pinch_pt) + vec3_distance(skui_hand[i].thumb, skui_hand[i].pinch_pt)
 			: FLT_MAX;
@@ -586,7 +613,7 @@ void ui_box_interaction_1h_poke(uint64_t id, vec3 box_unfocused_start, vec3 box_
 		}
 
 		bounds_t bounds   = ui_size_box(box_start, box_size);
-		bool     in_box   = skui_hand[i].tracked && ui_in_box(skui_hand[i].finger, skui_hand[i].finger_prev, skui_finger_radius, bounds);
+		bool     in_box   = skui_hand[i].tracked && !ui_reach_culled(i, false, bounds) && ui_in_box(skui_hand[i].finger, skui_hand[i].finger_prev, skui_finger_radius, bounds);
 		float    priority = in_box
 			? bounds_sdf(bounds, skui_hand[i].finger)
 			: FLT_MAX;
@@ -608,9 +635,9 @@ void ui_push_surface(pose_t surface_pose, vec3 layout_start, vec2 layout_dimensi
 	vec3   right = surface_pose.orientation * vec3_right;
 	matrix trs   = matrix_trs(surface_pose.position + right*layout_start, surface_pose.orientation);
 	hierarchy_push(trs);
+	ui_batch_push_surface();
 
 	skui_layers.add(layer_t{});
-	ui_layout_push(layout_start, layout_dimensions, true);
 
 	layer_t*      layer    = &skui_layers.last();
 	const matrix *to_local = hierarchy_to_local();
@@ -621,6 +648,10 @@ void ui_push_surface(pose_t surface_pose, vec3 layout_start, vec2 layout_dimensi
 		layer->pinch_pt_pos [i] = skui_hand[i].pinch_pt      = matrix_transform_pt(*to_local, skui_hand[i].pinch_pt_world);
 		layer->pinch_pt_prev[i] = skui_hand[i].pinch_pt_prev = matrix_transform_pt(*to_local, skui_hand[i].pinch_pt_world_prev);
 	}
+
+	// The layout's reach test needs the hands in this surface's space, so
+	// this happens after they've been transformed.
+	ui_layout_push(layout_start, layout_dimensions, true);
 }
 
 ///////////////////////////////////////////
@@ -628,6 +659,7 @@ void ui_push_surface(pose_t surface_pose, vec3 layout_start, vec2 layout_dimensi
 void ui_pop_surface() {
 	skui_layers.pop();
 	ui_layout_pop();
+	ui_batch_pop_surface();
 	hierarchy_pop();
 
 	if (skui_layers.count <= 0) {
@@ -702,6 +734,71 @@ bool32_t ui_id_focused(uint64_t id) {
 
 ///////////////////////////////////////////
 
+void ui_reach_push() {
+	reach_t reach = {};
+	if (skui_reach_stack.count > 0)
+		reach = skui_reach_stack.last();
+	skui_reach_stack.add(reach);
+}
+
+///////////////////////////////////////////
+
+void ui_reach_pop() {
+	skui_reach_stack.pop();
+}
+
+///////////////////////////////////////////
+
+void ui_reach_set(vec3 start, vec2 dimensions) {
+	// Auto-sized areas don't know where their content will end up, so they
+	// keep whatever their parent area had.
+	if (skui_reach_stack.count <= 0 || dimensions.x <= 0 || dimensions.y <= 0)
+		return;
+
+	// Element boxes poke out of their layout a bit, buttons for example have
+	// activation volumes out in front of the surface, and sustain volumes
+	// reaching through the back of it. Anything that pokes out further than
+	// this just falls back to the regular test.
+	float    pad   = skui_settings.depth * 2 + skui_finger_radius * 8;
+	reach_t *reach = &skui_reach_stack.last();
+	reach->layer  = skui_layers.count;
+	reach->valid  = true;
+	reach->bounds = bounds_t{
+		start - vec3{ dimensions.x / 2, dimensions.y / 2, 0 },
+		vec3{ dimensions.x + pad * 2, dimensions.y + pad * 2, pad * 2 } };
+
+	for (int32_t i = 0; i < handed_max; i++) {
+		const ui_hand_t &h = skui_hand[i];
+		reach->poke [i] = h.tracked && bounds_capsule_contains(reach->bounds, h.finger, h.finger_prev, skui_finger_radius);
+		reach->pinch[i] = h.tracked && bounds_capsule_contains(reach->bounds, h.finger, h.thumb,       skui_finger_radius);
+	}
+}
+
+///////////////////////////////////////////
+
+bool32_t ui_reach_culled(int32_t hand, bool32_t pinch, bounds_t box) {
+	// Volume visualization draws from inside ui_in_box, so nothing can be
+	// skipped while that's on.
+	if (skui_reach_stack.count <= 0 || skui_show_volumes) return false;
+
+	const reach_t &reach = skui_reach_stack.last();
+	if (!reach.valid || reach.layer != skui_layers.count) return false;
+	if (pinch ? reach.pinch[hand] : reach.poke[hand])     return false;
+
+	// Only a box entirely inside the reach bounds is guaranteed to be out of
+	// reach too.
+	vec3 box_min   = box  .center - box  .dimensions / 2;
+	vec3 box_max   = box  .center + box  .dimensions / 2;
+	vec3 reach_min = reach.bounds.center - reach.bounds.dimensions / 2;
+	vec3 reach_max = reach.bounds.center + reach.bounds.dimensions / 2;
+	return
+		box_min.x >= reach_min.x && box_max.x <= reach_max.x &&
+		box_min.y >= reach_min.y && box_max.y <= reach_max.y &&
+		box_min.z >= reach_min.z && box_max.z <= reach_max.z;
+}
+
+///////////////////////////////////////////
+
 bool32_t ui_in_box(vec3 pt, vec3 pt_prev, float radius, bounds_t box) {
 	if (skui_show_volumes)
 		render_add_mesh(skui_box_dbg, skui_mat_dbg, matrix_trs(box.center, quat_identity, box.dimensions));
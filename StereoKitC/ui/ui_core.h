@@ -32,10 +32,17 @@ extern float     skui_finger_radius;
 void ui_core_init();
 void ui_core_update();
 void ui_core_shutdown();
+size_t ui_core_memory();
 
 inline bounds_t ui_size_box(vec3 top_left, vec3 dimensions) { return { top_left - dimensions / 2, dimensions }; }
 
 bool32_t      ui_in_box(vec3 pt, vec3 pt_prev, float radius, bounds_t box);
+// A per-layout broadphase for element interaction, the layout system keeps
+// this in sync with its own stack.
+void          ui_reach_push  ();
+void          ui_reach_pop   ();
+void          ui_reach_set   (vec3 start, vec2 dimensions);
+bool32_t      ui_reach_culled(int32_t hand, bool32_t pinch, bounds_t box);
 void          ui_box_interaction_1h_pinch(uint64_t id, vec3 box_unfocused_start, vec3 box_unfocused_size, vec3 box_focused_start, vec3 box_focused_size, button_state_* out_focus_state, int32_t* out_hand);
 void          ui_box_interaction_1h_poke (uint64_t id, vec3 box_unfocused_start, vec3 box_unfocused_size, vec3 box_focused_start, vec3 box_focused_size, button_state_* out_focus_state, int32_t* out_hand);
 bool32_t      _ui_handle_begin(uint64_t id, pose_t& handle_pose, bounds_t handle_bounds, bool32_t draw, ui_move_ move_type, ui_gesture_ allowed_gestures);
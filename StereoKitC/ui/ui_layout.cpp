@@ -6,6 +6,7 @@
 
 #include "ui_layout.h"
 #include "ui_theming.h"
+#include "ui_core.h"
 
 #include "../libraries/array.h"
 #include "../sk_math.h"
@@ -41,6 +42,15 @@ void ui_layout_shutdown() {
 
 ///////////////////////////////////////////
 
+size_t ui_layout_memory() {
+	return
+		sizeof(ui_window_t) * skui_windows    .capacity +
+		sizeof(ui_layout_t) * skui_layouts    .capacity +
+		sizeof(ui_pad_    ) * skui_panel_stack.capacity;
+}
+
+///////////////////////////////////////////
+
 inline bool ui_layout_is_auto_width (const ui_layout_t* layout) { return layout->size.x == 0; }
 inline bool ui_layout_is_auto_height(const ui_layout_t* layout) { return layout->size.y == 0; }
 
@@ -179,6 +189,8 @@ bounds_t ui_layout_reserve(vec2 size, bool32_t add_padding, float depth) {
 ///////////////////////////////////////////
 
 void ui_layout_area(vec3 start, vec2 dimensions, bool32_t add_margin) {
+	ui_reach_set(start, dimensions);
+
 	vec3 margin_start = start;
 	if (add_margin) {
 		margin_start -= vec3{ skui_settings.margin, skui_settings.margin, 0 };
@@ -204,6 +216,7 @@ void ui_layout_push(vec3 start, vec2 dimensions, bool32_t add_margin) {
 	layout.parent = -1;
 	layout.window = -1;
 	skui_layouts.add(layout);
+	ui_reach_push();
 	ui_layout_area(start, dimensions, add_margin);
 }
 
@@ -267,6 +280,12 @@ void ui_layout_window(ui_window_id window_id, vec3 start, vec2 dimensions, bool3
 	win->layout_start = start;
 	win->layout_size  = dimensions;
 	win->curr_size    = dimensions;
+
+	// Auto-sized windows won't know their size until they end, but last
+	// frame's size is a good guess for where their elements will be.
+	ui_reach_set(start, {
+		dimensions.x == 0 ? win->prev_size.x : dimensions.x,
+		dimensions.y == 0 ? win->prev_size.y : dimensions.y });
 }
 
 ///////////////////////////////////////////
@@ -404,6 +423,7 @@ void ui_layout_pop() {
 	//	_ui_visualize_layout(layout);
 
 	skui_layouts.pop();
+	ui_reach_pop();
 }
 
 ///////////////////////////////////////////
@@ -34,8 +34,9 @@ struct ui_layout_t {
 
 extern ui_settings_t skui_settings;
 
-void ui_layout_init    ();
-void ui_layout_shutdown();
+void   ui_layout_init    ();
+void   ui_layout_shutdown();
+size_t ui_layout_memory  ();
 
 ui_window_id ui_layout_curr_window        ();
 ui_layout_t* ui_layout_curr               ();
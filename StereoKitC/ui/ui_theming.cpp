@@ -5,7 +5,10 @@
 #include "../libraries/array.h"
 #include "../utils/sdf.h"
 #include "../sk_math.h"
+#include "../sk_memory.h"
 #include "../platforms/platform.h"
+#include "../asset_types/material.h"
+#include "../systems/defaults.h"
 
 #include <float.h>
 
@@ -28,6 +31,25 @@ struct ui_theme_color_t {
 	color128 disabled;
 };
 
+// Elements drawn with the quadrant shader are sized and transformed on the
+// CPU, and collected into one mesh per material and color for each UI
+// surface. This way a window costs a few render items, instead of one per
+// element. Color stays on the render item rather than in the vertices, so
+// it keeps its full float precision and range.
+struct ui_batch_t {
+	mesh_t          mesh;
+	material_t      material;
+	color128        color;
+	int32_t         surface; // -1 once the batch has been submitted
+	array_t<vert_t> verts;
+	array_t<vind_t> inds;
+};
+
+struct ui_batch_surface_t {
+	matrix root;
+	matrix to_root;
+};
+
 ///////////////////////////////////////////
 
 font_t          skui_font;
@@ -70,6 +92,10 @@ array_t<text_style_t> skui_font_stack;
 array_t<color128>     skui_tint_stack;
 array_t<bool32_t>     skui_grab_aura_stack;
 
+array_t<ui_batch_t>         skui_batches;
+array_t<ui_batch_surface_t> skui_batch_surfaces;
+int32_t                     skui_batches_used;
+
 sound_t       skui_active_sound_off        = nullptr;
 sound_inst_t  skui_active_sound_inst       = {};
 vec3          skui_active_sound_pos        = vec3_zero;
@@ -287,6 +313,15 @@ void ui_theming_shutdown() {
 
 	mesh_release    (skui_box_dbg);        skui_box_dbg        = nullptr;
 
+	for (int32_t i = 0; i < skui_batches.count; i++) {
+		mesh_release(skui_batches[i].mesh);
+		skui_batches[i].verts.free();
+		skui_batches[i].inds .free();
+	}
+	skui_batches       .free();
+	skui_batch_surfaces.free();
+	skui_batches_used = 0;
+
 	material_release(skui_mat);            skui_mat            = nullptr;
 	material_release(skui_mat_dbg);        skui_mat_dbg        = nullptr;
 	material_release(skui_font_mat);       skui_font_mat       = nullptr;
@@ -310,7 +345,28 @@ void ui_theming_shutdown() {
 
 ///////////////////////////////////////////
 
+size_t ui_theming_memory() {
+	size_t result =
+		sizeof(text_style_t      ) * skui_font_stack     .capacity +
+		sizeof(color128          ) * skui_tint_stack     .capacity +
+		sizeof(bool32_t          ) * skui_grab_aura_stack.capacity +
+		sizeof(ui_batch_t        ) * skui_batches        .capacity +
+		sizeof(ui_batch_surface_t) * skui_batch_surfaces .capacity;
+	for (int32_t i = 0; i < skui_batches.count; i++) {
+		result +=
+			sizeof(vert_t) * skui_batches[i].verts.capacity +
+			sizeof(vind_t) * skui_batches[i].inds .capacity;
+	}
+	return result;
+}
+
+///////////////////////////////////////////
+
 void ui_theming_update() {
+	// Last frame's batches have been rendered, so their meshes are free to
+	// be filled up again.
+	skui_batches_used = 0;
+
 	if (skui_active_sound_element_id == 0) return;
 
 	// See if our current sound on/off pair is still from a valid ui element
@@ -433,25 +489,140 @@ color128 ui_get_el_color(ui_vis_ element_visual, float focus) {
 
 ///////////////////////////////////////////
 
+// Element batching                      //
+///////////////////////////////////////////
+
+void ui_batch_push_surface() {
+	// Batches are submitted relative to the surface with its scale removed,
+	// since the quadrant shader normalizes scale out of the instance
+	// transform anyhow.
+	ui_batch_surface_t surface = {};
+	surface.root = *hierarchy_to_world();
+	for (int32_t r = 0; r < 3; r++) {
+		vec3  axis = { surface.root.row[r].x, surface.root.row[r].y, surface.root.row[r].z };
+		float len  = vec3_magnitude(axis);
+		if (len > 0) surface.root.row[r] = surface.root.row[r] * (1.0f / len);
+	}
+	surface.to_root = matrix_invert(surface.root);
+	skui_batch_surfaces.add(surface);
+}
+
+///////////////////////////////////////////
+
+void ui_batch_pop_surface() {
+	int32_t surface_id = skui_batch_surfaces.count - 1;
+	if (surface_id < 0) return;
+
+	const matrix &root = skui_batch_surfaces[surface_id].root;
+	for (int32_t i = 0; i < skui_batches_used; i++) {
+		ui_batch_t *batch = &skui_batches[i];
+		if (batch->surface != surface_id) continue;
+
+		mesh_set_data(batch->mesh, batch->verts.data, batch->verts.count, batch->inds.data, batch->inds.count, true);
+		// The vertices already have the surface's parent hierarchy baked in
+		hierarchy_push (matrix_identity, hierarchy_parent_ignore);
+		render_add_mesh(batch->mesh, batch->material, root, batch->color);
+		hierarchy_pop  ();
+		batch->surface = -1;
+	}
+	skui_batch_surfaces.pop();
+}
+
+///////////////////////////////////////////
+
+ui_batch_t *ui_batch_get(material_t material, color128 color) {
+	int32_t surface_id = skui_batch_surfaces.count - 1;
+	for (int32_t i = skui_batches_used - 1; i >= 0; i--) {
+		const ui_batch_t *batch = &skui_batches[i];
+		if (batch->surface  == surface_id &&
+			batch->material == material   &&
+			memcmp(&batch->color, &color, sizeof(color)) == 0)
+			return &skui_batches[i];
+	}
+
+	if (skui_batches_used >= skui_batches.count) {
+		ui_batch_t batch = {};
+		batch.mesh = mesh_create();
+		mesh_set_keep_data(batch.mesh, false);
+		skui_batches.add(batch);
+	}
+	ui_batch_t *result = &skui_batches[skui_batches_used];
+	skui_batches_used += 1;
+	result->material = material;
+	result->color    = color;
+	result->surface  = surface_id;
+	result->verts.clear();
+	result->inds .clear();
+	return result;
+}
+
+///////////////////////////////////////////
+
+void ui_draw_mesh(mesh_t mesh, material_t material, vec3 start, vec3 size, color128 color) {
+	matrix transform = matrix_ts(start - size / 2, size);
+
+	// Only the quadrant shader's sizing is replicated here, other shaders
+	// get drawn as normal.
+	vert_t *src_verts = nullptr; int32_t src_vert_count = 0;
+	vind_t *src_inds  = nullptr; int32_t src_ind_count  = 0;
+	if (material->shader == sk_default_shader_ui_quadrant && skui_batch_surfaces.count > 0) {
+		mesh_get_verts(mesh, src_verts, src_vert_count, memory_reference);
+		mesh_get_inds (mesh, src_inds,  src_ind_count,  memory_reference);
+	}
+	if (src_verts == nullptr || src_inds == nullptr) {
+		render_add_mesh(mesh, material, transform, color);
+		return;
+	}
+
+	// Same math as the quadrant shader: the X and Y scale of the final
+	// transform resize the quadrants, and is then removed from the matrix.
+	matrix world = transform * *hierarchy_to_world();
+	vec2   scale = {
+		vec3_magnitude({ world.row[0].x, world.row[0].y, world.row[0].z }),
+		vec3_magnitude({ world.row[1].x, world.row[1].y, world.row[1].z }) };
+	if (scale.x <= 0 || scale.y <= 0) return;
+	world.row[0] = world.row[0] * (1.0f / scale.x);
+	world.row[1] = world.row[1] * (1.0f / scale.y);
+	matrix to_surface = world * skui_batch_surfaces.last().to_root;
+	vec2   half_scale = scale * 0.5f;
+
+	ui_batch_t *batch = ui_batch_get(material, color);
+	vind_t      start_ind = (vind_t)batch->verts.count;
+	vert_t     *verts     = batch->verts.add_empty_range(src_vert_count);
+	for (int32_t i = 0; i < src_vert_count; i++) {
+		const vert_t *src = &src_verts[i];
+		vec3 sized = { src->pos.x + src->uv.x * half_scale.x, src->pos.y + src->uv.y * half_scale.y, src->pos.z };
+		verts[i].pos  = matrix_transform_pt(to_surface, sized);
+		verts[i].norm = vec3_normalize(matrix_transform_dir(to_surface, src->norm));
+		verts[i].uv   = vec2_zero;
+		verts[i].col  = src->col;
+	}
+	vind_t *inds = batch->inds.add_empty_range(src_ind_count);
+	for (int32_t i = 0; i < src_ind_count; i++)
+		inds[i] = src_inds[i] + start_ind;
+}
+
+///////////////////////////////////////////
+
 void ui_draw_el_color(ui_vis_ element_visual, ui_vis_ element_color, vec3 start, vec3 size, float focus) {
 	/*if (size.x < skui_box_min.x) size.x = skui_box_min.x;
 	if (size.y < skui_box_min.y) size.y = skui_box_min.y;
 	if (size.z < skui_box_min.z) size.z = skui_box_min.z;*/
 
-	render_add_mesh(
+	ui_draw_mesh(
 		ui_get_mesh    (element_visual),
 		ui_get_material(element_visual),
-		matrix_ts(start - size / 2, size),
+		start, size,
 		ui_get_el_color(element_color, focus));
 }
 
 ///////////////////////////////////////////
 
 void ui_draw_el(ui_vis_ element_visual, vec3 start, vec3 size, float focus) {
-	render_add_mesh(
+	ui_draw_mesh(
 		ui_get_mesh    (element_visual),
 		ui_get_material(element_visual),
-		matrix_ts(start - size / 2, size),
+		start, size,
 		ui_get_el_color(element_visual, focus));
 }
 
@@ -732,8 +903,8 @@ void ui_default_aura_mesh(mesh_t *mesh, float tube_diameter, float corner_radius
 
 	int32_t vert_count = quadrant_slices * tube_corners * 4;
 	int32_t ind_count  = quadrant_slices * tube_corners * 6 * 4;
-	vert_t *verts      = sk_malloc_t(vert_t, vert_count);
-	vind_t *inds       = sk_malloc_t(vind_t, ind_count );
+	vert_t *verts      = sk_frame_alloc_t(vert_t, vert_count);
+	vind_t *inds       = sk_frame_alloc_t(vind_t, ind_count );
 
 	vind_t ind    = 0;
 	vind_t steps  = quadrant_slices * 4;
@@ -776,9 +947,6 @@ void ui_default_aura_mesh(mesh_t *mesh, float tube_diameter, float corner_radius
 		}
 	}
 	mesh_set_data(*mesh, verts, vert_count, inds, ind_count);
-
-	sk_free(verts);
-	sk_free(inds);
 }
 
 ///////////////////////////////////////////
@@ -18,6 +18,10 @@ extern const float skui_aura_radius;
 void ui_theming_init();
 void ui_theming_update();
 void ui_theming_shutdown();
+size_t ui_theming_memory();
+
+void ui_batch_push_surface();
+void ui_batch_pop_surface ();
 
 vec2     ui_get_mesh_minsize (ui_vis_ element_visual);
 void     ui_draw_el          (ui_vis_ element_visual, vec3 start, vec3 size, float focus);
@@ -0,0 +1,240 @@
+#include "jobs.h"
+#include "../stereokit.h"
+#include "../sk_memory.h"
+#include "../libraries/array.h"
+#include "../libraries/atomic_util.h"
+#include "../libraries/ferr_thread.h"
+#include "../systems/profiler.h"
+
+#include <thread>
+
+namespace sk {
+
+///////////////////////////////////////////
+
+struct job_batch_t {
+	void         (*job)(int32_t index, void *context);
+	void          *context;
+	int32_t        count;
+	volatile int32_t next;      // Next unclaimed index
+	volatile int32_t remaining; // Indices that haven't finished running
+	volatile int32_t active;    // Workers currently holding this batch
+};
+
+struct job_worker_t {
+	ft_id_t     id;
+	ft_thread_t thread;
+};
+
+struct jobs_state_t {
+	bool32_t               enabled;
+	array_t<job_worker_t>  workers;
+	array_t<job_batch_t *> batches;
+	ft_mutex_t             batch_mtx;
+	ft_condition_t         batch_available;
+};
+static jobs_state_t local = {};
+
+int32_t jobs_thread    (void *worker_inst);
+void    jobs_run_batch (job_batch_t *batch);
+void    jobs_submit    (job_batch_t *batch);
+void    jobs_join      (job_batch_t *batch);
+
+///////////////////////////////////////////
+
+bool jobs_init() {
+	local = {};
+	local.batch_mtx       = ft_mutex_create();
+	local.batch_available = ft_condition_create();
+	local.enabled         = true;
+
+	// Leave a core for the main thread, it participates in every batch it
+	// submits anyhow. The asset threads are mostly blocked on IO, so they
+	// aren't counted here.
+	int32_t worker_count = 0;
+#if !defined(__EMSCRIPTEN__)
+	worker_count = (int32_t)std::thread::hardware_concurrency() - 1;
+	worker_count = worker_count < 0 ? 0 : (worker_count > 7 ? 7 : worker_count);
+#endif
+
+	// Workers are all added before any start, so the array never moves out
+	// from under them.
+	local.workers.resize(worker_count);
+	for (int32_t i = 0; i < worker_count; i++)
+		local.workers.add({});
+	for (int32_t i = 0; i < local.workers.count; i++) {
+		local.workers[i].thread = ft_thread_create(jobs_thread, &local.workers[i]);
+		ft_thread_name(local.workers[i].thread, "StereoKit Worker");
+	}
+	return true;
+}
+
+///////////////////////////////////////////
+
+void jobs_shutdown() {
+	ft_mutex_lock(local.batch_mtx);
+	local.enabled = false;
+	ft_condition_broadcast(local.batch_available);
+	ft_mutex_unlock(local.batch_mtx);
+
+	for (int32_t i = 0; i < local.workers.count; i++)
+		ft_thread_join(local.workers[i].thread);
+
+	local.workers.free();
+	local.batches.free();
+	ft_mutex_destroy    (&local.batch_mtx);
+	ft_condition_destroy(&local.batch_available);
+	local = {};
+}
+
+///////////////////////////////////////////
+
+int32_t jobs_worker_count() {
+	return local.workers.count;
+}
+
+///////////////////////////////////////////
+
+bool jobs_is_worker() {
+	ft_id_t curr_id = ft_id_current();
+	for (int32_t i = 0; i < local.workers.count; i++) {
+		if (ft_id_equal(curr_id, local.workers[i].id))
+			return true;
+	}
+	return false;
+}
+
+///////////////////////////////////////////
+
+void jobs_parallel_for(int32_t count, void (*job)(int32_t index, void *context), void *context) {
+	if (count <= 0) return;
+
+	// Not worth waking anyone up for this
+	if (count == 1 || local.enabled == false || local.workers.count == 0) {
+		for (int32_t i = 0; i < count; i++)
+			job(i, context);
+		return;
+	}
+
+	job_batch_t batch = {};
+	batch.job       = job;
+	batch.context   = context;
+	batch.count     = count;
+	batch.remaining = count;
+
+	jobs_submit(&batch);
+	jobs_join  (&batch);
+}
+
+///////////////////////////////////////////
+
+job_batch_t *jobs_start(int32_t count, void (*job)(int32_t index, void *context), void *context) {
+	job_batch_t *batch = sk_malloc_zero_t(job_batch_t, 1);
+	batch->job       = job;
+	batch->context   = context;
+	batch->count     = count < 0 ? 0 : count;
+	batch->remaining = batch->count;
+
+	// Without workers, jobs_finish will just run the whole thing
+	if (batch->count > 0 && local.enabled && local.workers.count > 0)
+		jobs_submit(batch);
+	return batch;
+}
+
+///////////////////////////////////////////
+
+void jobs_finish(job_batch_t *batch) {
+	if (batch == nullptr) return;
+	jobs_join(batch);
+	sk_free(batch);
+}
+
+///////////////////////////////////////////
+
+bool jobs_done(job_batch_t *batch) {
+	return batch->remaining == 0;
+}
+
+///////////////////////////////////////////
+
+bool jobs_poll(job_batch_t *batch) {
+	jobs_run_batch(batch);
+	return batch->remaining == 0;
+}
+
+///////////////////////////////////////////
+
+void jobs_submit(job_batch_t *batch) {
+	ft_mutex_lock(local.batch_mtx);
+	local.batches.add(batch);
+	ft_condition_broadcast(local.batch_available);
+	ft_mutex_unlock(local.batch_mtx);
+}
+
+///////////////////////////////////////////
+
+void jobs_join(job_batch_t *batch) {
+	// The submitting thread does work too, this also makes nested batches
+	// from inside a worker safe, since they can always finish on their own.
+	jobs_run_batch(batch);
+
+	// Once everything has been claimed, stop workers from picking up this
+	// batch, and wait for the ones that already have it.
+	ft_mutex_lock(local.batch_mtx);
+	int32_t idx = local.batches.index_of(batch);
+	if (idx >= 0) local.batches.remove(idx);
+	ft_mutex_unlock(local.batch_mtx);
+
+	while (batch->remaining > 0 || batch->active > 0)
+		ft_yield();
+}
+
+///////////////////////////////////////////
+
+void jobs_run_batch(job_batch_t *batch) {
+	while (true) {
+		int32_t index = atomic_increment(&batch->next) - 1;
+		if (index >= batch->count) break;
+
+		batch->job(index, batch->context);
+		atomic_decrement(&batch->remaining);
+	}
+}
+
+///////////////////////////////////////////
+
+int32_t jobs_thread(void *worker_inst) {
+	job_worker_t *worker = (job_worker_t *)worker_inst;
+	worker->id = ft_id_current();
+	profiler_thread_name("Worker");
+
+	ft_mutex_lock(local.batch_mtx);
+	while (local.enabled) {
+		// Find a batch that still has unclaimed work in it
+		job_batch_t *batch = nullptr;
+		for (int32_t i = 0; i < local.batches.count; i++) {
+			if (local.batches[i]->next < local.batches[i]->count) {
+				batch = local.batches[i];
+				break;
+			}
+		}
+		if (batch == nullptr) {
+			ft_condition_wait(local.batch_available, local.batch_mtx);
+			continue;
+		}
+
+		atomic_increment(&batch->active);
+		ft_mutex_unlock(local.batch_mtx);
+
+		profiler_zone_begin("Job Batch");
+		jobs_run_batch(batch);
+		profiler_zone_end();
+
+		ft_mutex_lock(local.batch_mtx);
+		atomic_decrement(&batch->active);
+	}
+	ft_mutex_unlock(local.batch_mtx);
+	return 0;
+}
+
+} // namespace sk
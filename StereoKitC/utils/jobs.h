@@ -0,0 +1,33 @@
+#pragma once
+
+#include <stdint.h>
+
+namespace sk {
+
+struct job_batch_t;
+
+// A small pool of worker threads for splitting CPU work across cores. Work
+// is submitted in fork/join batches: the calling thread takes part in the
+// batch, and doesn't return until every index has been processed. If the
+// pool isn't running, or the platform has no threads (like WASM), batches
+// just run serially on the calling thread.
+
+bool    jobs_init        ();
+void    jobs_shutdown    ();
+int32_t jobs_worker_count();
+bool    jobs_is_worker   ();
+
+void    jobs_parallel_for(int32_t count, void (*job)(int32_t index, void *context), void *context);
+
+// Like jobs_parallel_for, but returns right away so the calling thread can
+// do other work while the workers get started. Every started batch must be
+// passed to jobs_finish, which joins in on the batch and waits for it.
+job_batch_t *jobs_start (int32_t count, void (*job)(int32_t index, void *context), void *context);
+void         jobs_finish(job_batch_t *batch);
+// jobs_done just checks if every index in the batch has finished, while
+// jobs_poll first helps out with any work that hasn't been claimed yet.
+// Neither will wait on work other threads have already claimed.
+bool         jobs_done  (job_batch_t *batch);
+bool         jobs_poll  (job_batch_t *batch);
+
+} // namespace sk